@@ -1,9 +1,10 @@
 #pragma once
 #include "stone.h"
+#include "symmetry.h"
 
 #include <vector>
-#include <deque>
 #include <optional>
+#include <cstdint>
 
 namespace Core
 {
@@ -18,6 +19,33 @@ namespace Core
         game_end,
         ongoing
     };
+    /**
+     * @brief Правила игры.
+     */
+    enum Rules
+    {
+        freestyle, // Гомоку без ограничений
+        renju      // Запрещенные ходы для черных (3-3, 4-4, длинный ряд)
+    };
+
+    /**
+     * @brief Серия камней одного цвета вдоль направления.
+     */
+    struct RunInfo
+    {
+        int length;    ///< Длина серии (включая саму клетку).
+        int open_ends; ///< Количество свободных концов (0, 1 или 2).
+    };
+
+    /**
+     * @brief Канонический хэш позиции и симметрия, переводящая позицию в каноническую.
+     */
+    struct Canonical
+    {
+        std::uint64_t hash;
+        int symmetry;
+    };
+
     /**
      * @brief Класс для хранения ситуации на игровом поле.
      *
@@ -28,14 +56,133 @@ namespace Core
      * - Получение цвета конкретного камня по координатам (get_stone_color).
      *
      * @note В реализации поле представлено в виде двумерного вектора, хранящего объекты класса Stone.
+     * Дополнительно для каждого цвета хранятся битовые маски строк (m_rows),
+     * по которым check_win() проверяет все поле векторными инструкциями.
      */
     class Situation
     {
     private:
         int m_size;
         int m_draw_counter;
+        /**
+         * @brief Хэши Зобриста образов позиции при каждой симметрии поля.
+         *
+         * m_hashes[s] - хэш позиции, в которой каждый камень перенесен
+         * симметрией s (core/symmetry.h); m_hashes[IDENTITY] - хэш самой позиции.
+         */
+        std::uint64_t m_hashes[Symmetry::COUNT];
+        Rules m_rules;
         std::vector<std::vector<Stone>> m_stones;
-        std::deque<std::pair<int, int>> last_move;
+        std::vector<std::pair<int, int>> last_move; ///< История ходов (стек для un_move).
+        std::vector<std::pair<int, int>> m_stone_list; ///< Все камни поля в порядке установки.
+        std::vector<int> m_stone_slots;                ///< Позиция камня клетки в m_stone_list или -1.
+        std::vector<std::uint32_t> m_rows[2]; ///< Маски строк белых и черных камней.
+
+        /**
+         * @brief Длины серий вокруг каждой клетки.
+         *
+         * Для каждой клетки, направления и цвета хранится число камней этого
+         * цвета, идущих подряд сразу перед клеткой и сразу после нее.
+         * Значения обновляются в set_stone за время, пропорциональное длине
+         * затронутой серии.
+         */
+        std::vector<std::uint8_t> m_runs;
+
+        /**
+         * @brief Индекс в m_runs.
+         *
+         * @param side 0 - камни в отрицательном направлении, 1 - в положительном.
+         */
+        int run_index(int x, int y, int dir, Color color, int side) const;
+
+        /**
+         * @brief Троичные коды линий вокруг каждой клетки.
+         *
+         * Для каждой клетки, направления и цвета хранится код соседних
+         * клеток на расстоянии до Lines::REACH (см. core/lines.h).
+         * Код позволяет за O(1) узнать из таблицы, что даст ход в клетку
+         * на этой линии: пятерку, четверку, тройку и т.д.
+         */
+        std::vector<std::uint16_t> m_codes;
+
+        std::vector<std::uint8_t> m_forbidden; ///< Запрещенные для черных клетки (рэндзю).
+        std::vector<int> m_three_cells;        ///< Клетки, где ход дает две и более тройки.
+        std::vector<int> m_three_slots;        ///< Позиция клетки в m_three_cells или -1.
+        std::vector<int> m_scratch;            ///< Рабочий буфер update_forbidden.
+
+        /**
+         * @brief Карта угроз: маска Threats::Kind для каждой клетки и цвета.
+         *
+         * Маска зависит только от кодов четырех линий клетки, поэтому после
+         * хода пересчитываются лишь клетки в пределах Lines::REACH на
+         * линиях через клетку хода (update_threats).
+         */
+        std::vector<std::uint8_t> m_threats;
+
+        int code_index(int x, int y, int dir, Color color) const;
+
+        std::uint8_t compute_threats(int x, int y, Color color) const;
+
+        /**
+         * @brief Пересчитывает угрозы клетки (x, y) для обоих цветов.
+         */
+        void refresh_threats(int x, int y);
+
+        /**
+         * @brief Обновляет карту угроз после изменения клетки (x, y).
+         */
+        void update_threats(int x, int y);
+
+        /**
+         * @brief Полный пересчет карты угроз (при смене правил).
+         */
+        void refresh_all_threats();
+
+        /**
+         * @brief Вносит камень (sign = 1) или снимает его (sign = -1) в кодах соседних клеток.
+         */
+        void apply_codes(int x, int y, Color color, int sign);
+
+        /**
+         * @brief Проверяет, запрещен ли ход черных в пустую клетку (x, y).
+         *
+         * Пятерка разрешена всегда. Запрещены длинный ряд, две и более
+         * четверки и две и более настоящие тройки. Тройка настоящая, если
+         * хотя бы одна клетка, превращающая ее в открытую четверку, сама не
+         * запрещена - это проверяется рекурсивно после временной установки
+         * камня в коды.
+         *
+         * @param depth Текущая глубина рекурсии.
+         */
+        bool compute_forbidden(int x, int y, int depth);
+
+        /**
+         * @brief Пересчитывает статус одной клетки и ее членство в m_three_cells.
+         */
+        void refresh_cell(int x, int y);
+
+        /**
+         * @brief Обновляет запрещенные клетки после изменения клетки (x, y).
+         *
+         * Пересчитываются клетки на четырех линиях в пределах Lines::REACH,
+         * а также все клетки с двумя и более тройками: их статус зависит
+         * от рекурсивной проверки и может измениться из-за дальнего хода.
+         */
+        void update_forbidden(int x, int y);
+
+        /**
+         * @brief Полный пересчет запрещенных клеток.
+         */
+        void refresh_forbidden();
+
+        /**
+         * @brief Устанавливает цвет клетки и обновляет производные структуры.
+         *
+         * @param x Координата x.
+         * @param y Координата y.
+         * @param color Новый цвет клетки (Color::None - снять камень).
+         */
+        void set_stone(int x, int y, Color color);
 
     public:
         /**
@@ -66,8 +213,50 @@ namespace Core
             std::vector<std::vector<int>> white,
             std::vector<std::vector<int>> black);
 
+        /**
+         * @brief Случайная расстановка от 1 до size * size / 2 камней
+         * (см. create_random) с зерном из std::random_device.
+         */
         static Situation create_with_openning(int size);
 
+        /**
+         * @brief То же с заданным зерном: одно зерно - одна и та же расстановка.
+         */
+        static Situation create_with_openning(int size, std::uint64_t seed);
+
+        /**
+         * @brief Случайная расстановка до stones камней, начиная с белого.
+         *
+         * Клетки перебираются в случайном порядке без повторов; клетка,
+         * на которой получилась бы пятерка, пропускается. Поэтому время
+         * не зависит от плотности, а камней может оказаться меньше stones,
+         * если подходящие клетки кончились. Генератор свой у каждого вызова:
+         * функция потокобезопасна и воспроизводима.
+         *
+         * @param radius Камни ставятся не дальше radius клеток от центра
+         * по каждой оси (0 - по всему полю).
+         * @param seed Зерно генератора.
+         */
+        static Situation create_random(int size, int stones, int radius, std::uint64_t seed);
+
+        /**
+         * @brief То же, что create_random, но в существующем объекте:
+         * память поля переиспользуется (см. reset).
+         */
+        void fill_random(int size, int stones, int radius, std::uint64_t seed);
+
+        /**
+         * @brief Очищает поле, сохраняя выделенную память.
+         *
+         * Если размер совпадает с текущим, повторных выделений памяти
+         * не происходит, что позволяет переигрывать множество партий
+         * в одном объекте.
+         *
+         * @param size Новый размер поля.
+         * @throws std::invalid_argument Если size вне [0, Constants::MAX_BOARD_SIZE].
+         */
+        void reset(int size);
+
         /**
          * @brief Ставит камень цвета color на позицию (x, y).
          *
@@ -76,7 +265,8 @@ namespace Core
          * @param color Цвет устанавливаемого камня.
          *
          * @return true Если ход успешно совершен (клетка пуста и существует).
-         * @return false Если координаты не принадлежат полю размера size или клетка уже занята.
+         * @return false Если координаты не принадлежат полю размера size, клетка уже занята
+         * или ход черных запрещен правилами рэндзю (см. is_forbidden()).
          */
         bool move(int x, int y, Color color);
 
@@ -95,6 +285,70 @@ namespace Core
          */
         int get_size();
 
+        /**
+         * @brief Возвращает правила, по которым ведется партия.
+         */
+        Rules get_rules() const;
+
+        /**
+         * @brief Устанавливает правила партии.
+         *
+         * При переходе на рэндзю запрещенные клетки пересчитываются.
+         */
+        void set_rules(Rules rules);
+
+        /**
+         * @brief Возвращает историю ходов в порядке их совершения.
+         *
+         * @return Координаты (x, y) всех камней, поставленных через move().
+         */
+        const std::vector<std::pair<int, int>> &get_history() const;
+
+        /**
+         * @brief Возвращает координаты всех камней поля.
+         *
+         * В отличие от get_history, включает камни, расставленные через
+         * setup_board. Список обновляется за O(1) при каждом изменении
+         * клетки, поэтому обход камней не зависит от площади поля.
+         * Порядок - порядок установки, если камни снимаются в обратном
+         * порядке (как в un_move).
+         */
+        const std::vector<std::pair<int, int>> &get_stones() const;
+
+        /**
+         * @brief Резервирует историю и рабочие буферы рэндзю на все клетки поля.
+         *
+         * После этого move() и un_move() не выделяют память. Емкость не
+         * переносится при копировании, поэтому поиск вызывает метод для
+         * своей позиции перед началом перебора.
+         */
+        void reserve_capacity();
+
+        /**
+         * @brief Хэш Зобриста позиции.
+         *
+         * Обновляется инкрементально при каждом ходе и его отмене, поэтому
+         * одинаковые расстановки камней имеют одинаковый хэш независимо от
+         * порядка ходов. Очередь хода в хэш не входит.
+         */
+        std::uint64_t get_hash() const;
+
+        /**
+         * @brief Хэш образа позиции при симметрии symmetry (core/symmetry.h).
+         */
+        std::uint64_t get_symmetric_hash(int symmetry) const;
+
+        /**
+         * @brief Канонический хэш класса симметричных позиций.
+         *
+         * Все восемь симметричных друг другу позиций получают одинаковый
+         * хэш, поэтому результаты поиска и записи справочников можно
+         * хранить один раз на класс. Клетку (x, y) текущей позиции в
+         * каноническую переводит Symmetry::apply(symmetry, x, y, size),
+         * обратно - Symmetry::inverse(symmetry).
+         */
+        Canonical get_canonical() const;
+
         /**
          * @brief Возвращает цвет камня в указанной клетке.
          *
@@ -120,10 +374,67 @@ namespace Core
          *
          * @return int Состояние игры.
          *
-         * @note Проверка происходит относительно, поставленного только что камня.
+         * @note Проверка происходит относительно, поставленного только что камня,
+         * и выполняется за O(1) по хранимым длинам серий.
          */
         int check_win(int x, int y);
 
+        /**
+         * @brief Длина серии цвета color через клетку (x, y) в направлении dir.
+         *
+         * Клетка (x, y) считается камнем цвета color независимо от ее
+         * содержимого, поэтому для пустой клетки возвращается длина серии,
+         * которая получится после хода в нее.
+         *
+         * @param dir Индекс направления в Constants::DIRECTIONS.
+         * @return int Длина серии за O(1).
+         */
+        int run_length(int x, int y, int dir, Color color) const;
+
+        /**
+         * @brief Длина серии и число ее свободных концов.
+         *
+         * @see run_length()
+         */
+        RunInfo run_info(int x, int y, int dir, Color color) const;
+
+        /**
+         * @brief Проверяет, образует ли камень в клетке (x, y) пять в ряд.
+         *
+         * @return true Если камень в клетке входит в серию из пяти и более камней.
+         * @note Работает за O(1) благодаря хранимым длинам серий.
+         */
+        bool is_five(int x, int y) const;
+
+        /**
+         * @brief Код линии вокруг клетки (x, y) с точки зрения цвета color.
+         *
+         * @param dir Индекс направления в Constants::DIRECTIONS.
+         * @return std::uint16_t Код для Lines::lookup.
+         */
+        std::uint16_t line_code(int x, int y, int dir, Color color) const;
+
+        /**
+         * @brief Проверяет, запрещен ли ход черных в клетку (x, y).
+         *
+         * Статус всех клеток поддерживается инкрементально при каждом ходе,
+         * поэтому проверка выполняется за O(1).
+         *
+         * @return true Только для правил рэндзю и пустой запрещенной клетки.
+         */
+        bool is_forbidden(int x, int y) const;
+
+        /**
+         * @brief Угрозы, которые создал бы камень цвета color в клетке (x, y).
+         *
+         * Карта поддерживается инкрементально, поэтому запрос выполняется
+         * за O(1). Для занятой клетки возвращается 0. Запреты рэндзю
+         * не учитываются (см. is_forbidden).
+         *
+         * @return std::uint8_t Маска флагов Threats::Kind (core/threats.h).
+         */
+        std::uint8_t threats(int x, int y, Color color) const;
+
         /**
          * @brief Функция проверки состояния игры
          *
@@ -134,7 +445,8 @@ namespace Core
          *
          * @return int Результат игры.
          *
-         * @note Проверка всего поля.
+         * @note Проверка всего поля. Для полей до 32x32 используются битовые
+         * маски строк и SIMD-инструкции (AVX2/SSE2 с выбором во время выполнения).
          */
 
         int check_win();
@@ -19,10 +19,32 @@ namespace Core::Constants
         Minimax = 1,
         Alphabeta = 2,
         Heuristic = 3,
-        AlphaBeta = 4
+        AlphaBeta = 4,
+        Mcts = 5
     };
 
     inline constexpr SearchAlgo SEARCH_ALGORIMT = SearchAlgo::Minimax;
 
     inline constexpr int FIELD_SIZE = 9;
+
+    // Наибольший размер поля: координаты хода в таблице транспозиций
+    // и в записях партий хранятся в одном байте со знаком
+    inline constexpr int MAX_BOARD_SIZE = 127;
+
+    // Предельная глубина и время на ход альфа-бета поиска (SearchAlgo::AlphaBeta)
+    inline constexpr int ALPHABETA_MAX_DEPTH = 12;
+    inline constexpr int SEARCH_TIME_MS = 1000;
+
+    // Размер таблицы транспозиций альфа-бета поиска, МБ
+    inline constexpr int HASH_SIZE_MB = 16;
+
+    // Время на ход для поиска Монте-Карло (SearchAlgo::Mcts), мс
+    inline constexpr int MCTS_TIME_MS = 1000;
+
+    // Минимальный интервал между кадрами в партиях компьютер против компьютера
+    inline constexpr int EVE_FRAME_INTERVAL_MS = 100;
+
+    // Направления линий: горизонталь, вертикаль, две диагонали
+    inline constexpr int DIRECTIONS_COUNT = 4;
+    inline constexpr int DIRECTIONS[DIRECTIONS_COUNT][2] = {{1, 0}, {0, 1}, {1, 1}, {-1, 1}};
 } // namespace Core::Constants
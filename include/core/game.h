@@ -3,6 +3,9 @@
 #include "board.h"
 #include "utils/render.h"
 #include "player/player.h"
+#include "utils/async.h"
+
+#include <string>
 
 namespace Core
 {
@@ -67,8 +70,14 @@ namespace Core
         Type m_type;
         Situation m_situation;
         bool m_is_valid_move;
+        int m_setup_moves;         // число камней начальной расстановки в истории
+        Status m_result;           // итог партии (ongoing, пока игра идет)
+        std::string m_record_path; // файл записей партий (пусто - не сохранять)
+        std::string m_weights_path; // файл весов оценочной функции ИИ (пусто - по умолчанию)
+        std::string m_network_path; // файл нейросети ИИ (пусто - оценка по паттернам)
+        std::string m_training_path; // файл обучающих данных для нейросети (пусто - не писать)
+        bool m_headless;             // без отрисовки (партии, которыми управляет программа)
 
-        
 
     public:
         /**
@@ -103,17 +112,101 @@ namespace Core
          */
         MoveResult move(int x, int y);
 
+        /**
+         * @brief Ход без отрисовки координат от 0, как их возвращает AI::Ips.
+         *
+         * Вместе с get_to_move, get_situation и is_over позволяет вести
+         * партию по шагам извне, без блокирующего цикла run().
+         *
+         * @return MoveResult Состояние игры.
+         */
+        MoveResult play(int x, int y);
+
+        /**
+         * @brief Отключает отрисовку итога партии в move и play.
+         */
+        void set_headless(bool headless);
+
+        /**
+         * @brief Цвет стороны, которой принадлежит ход.
+         */
+        Color get_to_move() const;
+
+        Situation &get_situation();
+
+        /**
+         * @brief Итог партии (ongoing, пока игра идет).
+         */
+        Status get_result() const;
+
+        bool is_over() const;
+
         /**
          * @brief Функция связи с классом отрисовки
          *
          * Просто передает ситуацию отрисовке
+         *
+         * @param force рисовать без ограничения частоты кадров (перед ходом человека)
          */
-        void render();
+        void render(bool force = false);
 
         /**
          * @brief Запуск основного цикла игры
+         *
+         * Человек (белые) против ИИ (черные) в цикле событий Utils::EventLoop
+         * (см. run_async). Без цикла событий (не POSIX) - блокирующий цикл:
+         * ввод человека из std::cin, поиск ИИ в том же потоке.
          */
         void run();
+
+        /**
+         * @brief Ведет партию между игроками до конца.
+         *
+         * Корутина для Utils::EventLoop: пока игрок думает или ждет ввода,
+         * поток цикла ведет другие партии, поэтому один поток может вести
+         * тысячи партий. Если игрок не вернул хода ((-1, -1)) или сделал
+         * недопустимый ход, партия прерывается и остается незавершенной;
+         * человека после недопустимого хода спрашивают снова
+         * (см. Player::Player::on_invalid_move).
+         *
+         * @param white, black Игроки (должны жить до конца партии).
+         * @return Status Итог партии (ongoing, если партия прервана).
+         */
+        Utils::Async<Status> run_async(Player::Player &white, Player::Player &black);
+
+        /**
+         * @brief Задает файл, в конец которого будет дописана партия после ее завершения.
+         *
+         * @param path Путь к файлу записей (см. Storage::RecordWriter).
+         */
+        void set_record_file(const std::string &path);
+
+        /**
+         * @brief Задает файл весов оценочной функции для ИИ (см. AI::load_weights).
+         */
+        void set_weights_file(const std::string &path);
+
+        /**
+         * @brief Задает файл нейросети (AI::Nnue::Network) для оценки позиций ИИ.
+         *
+         * @param path Путь к файлу сети. Пустая строка - оценка по паттернам.
+         */
+        void set_network_file(const std::string &path);
+
+        /**
+         * @brief Задает файл, в который после партии дописываются ее позиции
+         * как обучающие данные для нейросети (см. AI::Nnue::TrainingExporter).
+         *
+         * @param path Путь к файлу. Пустая строка - данные не записываются.
+         */
+        void set_training_file(const std::string &path);
+
+        /**
+         * @brief Дописывает текущую партию в файл записей.
+         *
+         * @return false Если партию не удалось записать.
+         */
+        bool save(const std::string &path);
     };
 
 }
\ No newline at end of file
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Core::Lines
+{
+    /**
+     * @brief Число соседних клеток с каждой стороны, входящих в код линии.
+     */
+    inline constexpr int REACH = 5;
+
+    /**
+     * @brief Количество клеток в коде линии (без центральной).
+     */
+    inline constexpr int WINDOW = 2 * REACH;
+
+    /**
+     * @brief Количество различных кодов линии: 3^WINDOW.
+     */
+    inline constexpr int CODE_COUNT = 59049;
+
+    /**
+     * @brief Состояние соседней клетки в коде линии с точки зрения одного цвета.
+     */
+    enum CellState
+    {
+        empty = 0,
+        own = 1,    // камень того же цвета
+        blocked = 2 // камень соперника или край поля
+    };
+
+    /**
+     * @brief Позиция клетки со смещением offset (-REACH..REACH, кроме 0) в коде.
+     */
+    constexpr int index_of(int offset) { return offset < 0 ? offset + REACH : offset + REACH - 1; }
+
+    /**
+     * @brief Смещение клетки по ее позиции index в коде.
+     */
+    constexpr int offset_of(int index) { return index < REACH ? index - REACH : index - REACH + 1; }
+
+    /**
+     * @brief Вес позиции index в троичном коде.
+     */
+    constexpr std::uint16_t weight(int index)
+    {
+        std::uint16_t result = 1;
+        for (int i = 0; i < index; ++i)
+            result *= 3;
+        return result;
+    }
+
+    /**
+     * @brief Результат хода в центральную клетку линии.
+     *
+     * Упакован в 16 бит, чтобы таблица из CODE_COUNT элементов занимала
+     * около 118 КБ.
+     */
+    struct LineInfo
+    {
+        std::uint16_t bits;
+
+        /// Ход образует пять в ряд.
+        bool five() const { return bits & 1; }
+        /// Ход образует ряд из шести и более камней.
+        bool overline() const { return bits & 2; }
+        /// Число образованных четверок (0..2).
+        int fours() const { return (bits >> 2) & 3; }
+        /// Среди четверок есть открытая (.XXXX.).
+        bool straight_four() const { return bits & 16; }
+        /**
+         * @brief Маска позиций кода, ход в которые превращает линию в открытую четверку.
+         *
+         * Ненулевая маска означает тройку. Используется для проверки
+         * ложных троек: тройка настоящая, если хотя бы одна из этих
+         * клеток не является запрещенной.
+         */
+        int three_mask() const { return (bits >> 5) & 0x3FF; }
+        /// Следующим ходом линию можно превратить в закрытую четверку.
+        bool closed_three() const { return bits & 0x8000; }
+    };
+
+    /**
+     * @brief Информация о линии по ее коду.
+     *
+     * @param code Троичный код соседних клеток.
+     * @param exact true - пятеркой считаются ровно пять камней (черные в рэндзю),
+     *              false - пять и более.
+     * @return const LineInfo& Элемент заранее построенной таблицы.
+     */
+    const LineInfo &lookup(std::uint16_t code, bool exact);
+
+} // namespace Core::Lines
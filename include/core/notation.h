@@ -0,0 +1,70 @@
+#pragma once
+
+#include "board.h"
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace Core::Notation
+{
+    /**
+     * @brief Максимальная длина строки позиции для поля размером size.
+     *
+     * Строка состоит из size строк поля по size символов, разделителей
+     * и суффикса со стороной хода и правилами.
+     */
+    inline constexpr std::size_t max_length(int size) { return static_cast<std::size_t>(size) * (size + 1) + 8; }
+
+    /**
+     * @brief Разбирает строку позиции в ситуацию.
+     *
+     * Формат: "<строка 0>/<строка 1>/.../<строка n-1> <ход> <правила>".
+     * В строке поля 'x' - белый камень, 'o' - черный, число - количество
+     * пустых клеток подряд. Ход - 'x' или 'o', правила - 'f' (freestyle)
+     * или 'r' (renju); без правил - freestyle. После суффикса допустимы
+     * только пробельные символы. Размер поля равен числу строк и не больше
+     * Constants::MAX_BOARD_SIZE.
+     *
+     * Пример: "9/9/9/3x5/4o4/9/9/9/9 x f".
+     *
+     * Разбор не выделяет память: ситуация очищается через Situation::reset
+     * и заполняется ходами.
+     *
+     * @param text Строка позиции.
+     * @param situation Ситуация, в которую записывается позиция.
+     * @param to_move Цвет стороны, которой принадлежит ход.
+     * @return false Если строка не соответствует формату.
+     */
+    bool parse(std::string_view text, Situation &situation, Color &to_move);
+
+    /**
+     * @brief Записывает позицию в буфер.
+     *
+     * @param buffer Буфер для строки (без завершающего нуля).
+     * @param capacity Размер буфера, достаточно max_length(size).
+     * @return std::size_t Длина записанной строки или 0, если буфер мал.
+     */
+    std::size_t write(Situation &situation, Color to_move, char *buffer, std::size_t capacity);
+
+    /**
+     * @brief Удобная обертка над write, возвращающая std::string.
+     */
+    std::string to_string(Situation &situation, Color to_move);
+
+    /**
+     * @brief Загружает позиции из файла, по одной на строку.
+     *
+     * Каждая строка разбирается в одну и ту же ситуацию, позиции с уже
+     * собранной пятеркой (check_win) или ошибкой формата пропускаются.
+     * Пустые строки и строки, начинающиеся с '#', игнорируются.
+     *
+     * @param path Путь к файлу.
+     * @param visit Вызывается для каждой корректной позиции.
+     * @return std::size_t Число принятых позиций.
+     */
+    std::size_t load(const std::string &path,
+                     const std::function<void(Situation &, Color)> &visit);
+
+} // namespace Core::Notation
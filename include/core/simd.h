@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Core::Simd
+{
+    /**
+     * @brief Максимальный размер поля, который помещается в битовую строку.
+     *
+     * Каждая строка поля хранится как 32-битная маска: бит x установлен,
+     * если в клетке (x, y) стоит камень нужного цвета.
+     */
+    inline constexpr int MAX_BITBOARD_SIZE = 32;
+
+    /**
+     * @brief Количество нулевых строк после последней строки поля.
+     *
+     * Векторные проходы читают до 8 + 4 строк за границей поля,
+     * поэтому массив строк должен быть дополнен нулями.
+     */
+    inline constexpr int ROWS_PADDING = 12;
+
+    /**
+     * @brief Набор инструкций, выбранный для проверки поля.
+     */
+    enum class Level
+    {
+        Scalar,
+        Sse2,
+        Avx2
+    };
+
+    /**
+     * @brief Определяет лучший набор инструкций, доступный на текущем процессоре.
+     *
+     * @return Level Результат определяется один раз и кэшируется.
+     */
+    Level detect_level();
+
+    /**
+     * @brief Проверяет наличие пяти камней подряд в битовом представлении поля.
+     *
+     * Проверяются строки, столбцы и обе диагонали с помощью сдвигов и
+     * побитового И. Реализация выбирается во время выполнения (AVX2, SSE2
+     * или скалярная).
+     *
+     * @param rows Массив из size + ROWS_PADDING масок строк одного цвета.
+     * @param size Размер поля (не больше MAX_BITBOARD_SIZE).
+     * @return true Если найдено пять (или больше) камней подряд.
+     */
+    bool has_five(const std::uint32_t *rows, int size);
+
+    /**
+     * @brief Скалярная реализация has_five без векторных инструкций.
+     *
+     * @note Используется как запасной вариант и для сверки результатов.
+     */
+    bool has_five_scalar(const std::uint32_t *rows, int size);
+
+    /**
+     * @brief Поэлементное сложение векторов int16: dst[i] = src[i] + add[i].
+     *
+     * Используется для инкрементального обновления аккумулятора нейросети.
+     * dst может совпадать с src.
+     *
+     * @param n Длина векторов (кратна 16).
+     */
+    void add_i16(std::int16_t *dst, const std::int16_t *src, const std::int16_t *add, int n);
+
+    /**
+     * @brief Поэлементное вычитание векторов int16: dst[i] = src[i] - sub[i].
+     *
+     * @param n Длина векторов (кратна 16).
+     */
+    void sub_i16(std::int16_t *dst, const std::int16_t *src, const std::int16_t *sub, int n);
+
+    /**
+     * @brief Скалярное произведение с ограниченной активацией.
+     *
+     * Возвращает сумму clamp(x[i], 0, 127) * w[i]. Значения x после
+     * ограничения помещаются в int8, поэтому произведения считаются
+     * в int16 с накоплением в int32.
+     *
+     * @param n Длина векторов (кратна 16).
+     */
+    std::int32_t dot_crelu_i16_i8(const std::int16_t *x, const std::int8_t *w, int n);
+
+} // namespace Core::Simd
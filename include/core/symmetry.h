@@ -0,0 +1,49 @@
+#pragma once
+
+#include <utility>
+
+namespace Core::Symmetry
+{
+    /**
+     * @brief Число симметрий квадратного поля (группа диэдра D4).
+     */
+    inline constexpr int COUNT = 8;
+
+    /**
+     * @brief Тождественная симметрия.
+     */
+    inline constexpr int IDENTITY = 0;
+
+    /**
+     * @brief Образ клетки (x, y) при симметрии s поля size x size.
+     *
+     * Биты s: 4 - транспонирование (x и y меняются местами), затем
+     * 1 - отражение по x, 2 - отражение по y.
+     */
+    constexpr std::pair<int, int> apply(int s, int x, int y, int size)
+    {
+        if (s & 4)
+        {
+            const int t = x;
+            x = y;
+            y = t;
+        }
+        if (s & 1)
+            x = size - 1 - x;
+        if (s & 2)
+            y = size - 1 - y;
+        return {x, y};
+    }
+
+    /**
+     * @brief Обратная симметрия: apply(inverse(s), apply(s, p)) == p.
+     *
+     * Отражения без транспонирования обратны сами себе; после
+     * транспонирования отражения по x и y меняются ролями.
+     */
+    constexpr int inverse(int s)
+    {
+        return (s & 4) ? (4 | ((s & 1) << 1) | ((s & 2) >> 1)) : s;
+    }
+
+} // namespace Core::Symmetry
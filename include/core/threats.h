@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Core::Threats
+{
+    /**
+     * @brief Угрозы, которые образует камень в пустой клетке.
+     *
+     * Флаги складываются в маску (см. Situation::threats). Они
+     * вычисляются по кодам четырех линий клетки (Lines::lookup), поэтому
+     * для черных по правилам рэндзю пятеркой считаются ровно пять камней.
+     */
+    enum Kind : std::uint8_t
+    {
+        five = 1,           ///< Пять в ряд.
+        straight_four = 2,  ///< Открытая четверка (.XXXX.).
+        four = 4,           ///< Хотя бы одна четверка (открытая или закрытая).
+        double_four = 8,    ///< Две и более четверки.
+        open_three = 16,    ///< Тройка: следующий ход дает открытую четверку.
+        closed_three = 32,  ///< Следующим ходом линия становится закрытой четверкой.
+        double_three = 64,  ///< Открытые тройки на двух и более линиях.
+        four_three = 128    ///< Четверка и открытая тройка на разных линиях.
+    };
+
+    /**
+     * @brief Угрозы, после которых соперник не может защититься одним ходом
+     * (без учета запретов рэндзю).
+     */
+    inline constexpr std::uint8_t DOUBLE = straight_four | double_four | four_three | double_three;
+
+    /**
+     * @brief Угрозы, требующие немедленного ответа.
+     */
+    inline constexpr std::uint8_t FORCING = five | four | open_three;
+
+} // namespace Core::Threats
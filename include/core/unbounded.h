@@ -0,0 +1,131 @@
+#pragma once
+#include "board.h"
+
+#include <utility>
+#include <vector>
+
+namespace Core
+{
+    /**
+     * @brief Неограниченное поле: окно Situation, растущее вокруг камней.
+     *
+     * Координаты камней - любые целые числа (абсолютные координаты).
+     * Камни хранятся в обычном поле Situation (окне), которое покрывает
+     * охватывающий прямоугольник камней с запасом MARGIN клеток с каждой
+     * стороны. Запас больше окна линии (Lines::REACH) и окна паттернов
+     * оценки, поэтому край окна не влияет ни на пятерки, ни на запреты
+     * рэндзю, ни на оценку позиции: поле ведет себя как бесконечное.
+     *
+     * Если ход ложится ближе MARGIN к краю, окно пересоздается большего
+     * размера (не меньше чем в полтора раза), и камни переставляются в
+     * порядке истории. Поэтому стоимость роста амортизирована, а размер
+     * окна определяется разбросом камней, а не размером поля.
+     *
+     * Окно не больше Constants::MAX_BOARD_SIZE: ход, для которого камни
+     * с запасом в него не помещаются, отклоняется, как и ход с координатой
+     * по модулю больше MAX_COORDINATE. Поэтому далекий ход не выделяет
+     * плотное поле на весь промежуток, а разности координат не переполняются.
+     *
+     * Поиск работает с окном как с обычным полем (см. window(),
+     * AI::Ips::get_move(UnboundedSituation &)): генерация ходов и оценка
+     * обходят только камни и их окрестность (Situation::get_stones).
+     */
+    class UnboundedSituation
+    {
+    public:
+        /**
+         * @brief Запас пустых клеток между камнями и краем окна.
+         *
+         * Покрывает окно линии Lines::REACH и еще несколько ходов поиска
+         * (каждый ход поиска ставится не дальше двух клеток от камней).
+         */
+        static constexpr int MARGIN = 12;
+
+        /**
+         * @brief Наибольшая по модулю координата камня.
+         */
+        static constexpr int MAX_COORDINATE = 1 << 29;
+
+    private:
+        Situation m_window;
+        int m_origin_x; ///< Абсолютная x клетки (0, 0) окна.
+        int m_origin_y; ///< Абсолютная y клетки (0, 0) окна.
+        std::vector<std::pair<int, int>> m_history; ///< История ходов в абсолютных координатах.
+
+        /**
+         * @brief Проверяет, что клетка лежит в окне не ближе MARGIN к краю.
+         */
+        bool fits(int x, int y);
+
+        /**
+         * @brief Проверяет, что координаты не больше MAX_COORDINATE по модулю.
+         */
+        static bool in_range(int x, int y);
+
+        /**
+         * @brief Пересоздает окно так, чтобы в нем с запасом помещались камни и клетка (x, y).
+         *
+         * @return false Если для этого нужно окно больше Constants::MAX_BOARD_SIZE
+         * (окно не меняется).
+         */
+        bool grow(int x, int y);
+
+    public:
+        /**
+         * @brief Пустое поле; клетка (0, 0) - центр начального окна.
+         */
+        UnboundedSituation();
+
+        /**
+         * @brief Ставит камень в клетку с абсолютными координатами (x, y).
+         *
+         * @return false Если клетка занята, ход черных запрещен правилами рэндзю
+         * или клетка слишком далеко от камней (см. описание класса).
+         */
+        bool move(int x, int y, Color color);
+
+        /**
+         * @brief Отменяет последний ход (окно при этом не уменьшается).
+         */
+        bool un_move();
+
+        Color get_stone_color(int x, int y);
+
+        bool is_empty(int x, int y);
+
+        /**
+         * @brief Проверяет, образует ли камень в клетке (x, y) пять в ряд.
+         */
+        bool is_five(int x, int y) const;
+
+        bool is_forbidden(int x, int y) const;
+
+        Rules get_rules() const;
+
+        void set_rules(Rules rules);
+
+        /**
+         * @brief История ходов в абсолютных координатах.
+         */
+        const std::vector<std::pair<int, int>> &get_history() const;
+
+        /**
+         * @brief Окно: обычное поле, в котором лежат все камни.
+         *
+         * Ссылка действительна до следующего хода: ход может пересоздать окно
+         * и сдвинуть его начало.
+         */
+        Situation &window();
+
+        /**
+         * @brief Перевод абсолютных координат в координаты окна.
+         */
+        std::pair<int, int> to_window(int x, int y) const;
+
+        /**
+         * @brief Перевод координат клетки окна в абсолютные.
+         */
+        std::pair<int, int> from_window(std::pair<int, int> cell) const;
+    };
+
+} // namespace Core
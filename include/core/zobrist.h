@@ -0,0 +1,37 @@
+#pragma once
+
+#include "stone.h"
+
+#include <cstdint>
+
+namespace Core::Zobrist
+{
+    /**
+     * @brief Перемешивание splitmix64.
+     */
+    constexpr std::uint64_t mix(std::uint64_t value)
+    {
+        value += 0x9E3779B97F4A7C15ull;
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+        return value ^ (value >> 31);
+    }
+
+    /**
+     * @brief Ключ камня цвета color в клетке (x, y).
+     *
+     * Ключи вычисляются по координатам, а не по номеру клетки, поэтому
+     * не зависят от размера поля и не требуют таблицы.
+     */
+    constexpr std::uint64_t key(int x, int y, Color color)
+    {
+        return mix((static_cast<std::uint64_t>(y) << 17) ^ (static_cast<std::uint64_t>(x) << 1) ^
+                   static_cast<std::uint64_t>(color));
+    }
+
+    /**
+     * @brief Ключ очереди хода черных (добавляется к хэшу позиции при поиске).
+     */
+    inline constexpr std::uint64_t BLACK_TO_MOVE = mix(0xB1AC4ull << 40);
+
+} // namespace Core::Zobrist
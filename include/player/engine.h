@@ -0,0 +1,86 @@
+#pragma once
+
+#include "core/board.h"
+#include "core/constans.h"
+#include "player/player.h"
+#include "solver/ips.h"
+#include "solver/ttable.h"
+#include "utils/event_loop.h"
+#include "utils/thread_pool.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace Player
+{
+    /**
+     * @brief Потоки поиска для игроков Engine.
+     *
+     * Как в Tools::GameHost, движки AI::Ips заводятся на поток пула (по
+     * одному на цвет) с общей таблицей транспозиций, а не на партию:
+     * память не растет с числом партий. Если поток ищет ход для другого
+     * игрока, чем в прошлый раз, память поиска движка очищается.
+     */
+    class EnginePool
+    {
+    private:
+        struct Engines
+        {
+            AI::Ips white;
+            AI::Ips black;
+            std::uint64_t owner[2]; ///< Игрок, для которого искал движок (0 - никто).
+            Engines() : white(Core::Color::White), black(Core::Color::Black), owner{0, 0} {}
+        };
+
+        AI::TranspositionTable m_table;
+        std::vector<std::unique_ptr<Engines>> m_engines;
+        std::atomic<std::uint64_t> m_next_id;
+        Utils::WorkStealingPool m_pool; ///< Последним: его потоки пользуются полями выше.
+
+        friend class Engine;
+
+        /**
+         * @brief Поиск хода в потоке пула движком цвета color.
+         */
+        std::pair<int, int> search(std::uint64_t owner, Core::Situation &situation, Core::Color color);
+
+    public:
+        /**
+         * @param threads Потоков поиска (0 - по числу ядер).
+         * @param hash_mb Размер общей таблицы транспозиций, МБ.
+         */
+        explicit EnginePool(int threads = 0, std::size_t hash_mb = Core::Constants::HASH_SIZE_MB);
+
+        EnginePool(const EnginePool &) = delete;
+        EnginePool &operator=(const EnginePool &) = delete;
+
+        /**
+         * @brief Настраивает все движки (алгоритм, ограничения, веса).
+         *
+         * Вызывается, пока ни один поиск не идет.
+         */
+        void configure(const std::function<void(AI::Ips &)> &setup);
+    };
+
+    /**
+     * @brief Игрок-движок: поиск выполняется в потоке EnginePool, а партия
+     * продолжается в цикле событий, когда ход найден.
+     */
+    class Engine : public Player
+    {
+    private:
+        Utils::EventLoop &m_loop;
+        EnginePool &m_pool;
+        std::uint64_t m_id;
+
+    public:
+        Engine(Core::Color color, Utils::EventLoop &loop, EnginePool &pool);
+
+        Utils::Async<std::pair<int, int>> get_move(Core::Situation &situation) override;
+    };
+
+} // namespace Player
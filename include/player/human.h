@@ -1,27 +1,40 @@
 #pragma once
 
 #include "core/board.h"
+#include "player/player.h"
+#include "utils/event_loop.h"
 
 #include <utility>
 
 namespace Player
 {
-    class Human
+    /**
+     * @brief Человек, вводящий ходы строками "x y" (координаты от 1).
+     *
+     * Ввод читается в цикле событий: ожидающий человек не занимает потока.
+     */
+    class Human : public Player
     {
     private:
-        Core::Color m_color;
+        Utils::LineReader m_input;
 
     public:
-        Human(Core::Color color);
+        /**
+         * @param fd Дескриптор ввода (по умолчанию стандартный ввод).
+         */
+        Human(Core::Color color, Utils::EventLoop &loop, int fd = 0);
+
+        /**
+         * @brief Ждет строку с ходом; строки, которые не удалось разобрать, пропускаются.
+         */
+        Utils::Async<std::pair<int, int>> get_move(Core::Situation &situation) override;
 
         /**
-         * @brief Запрашивает у игрока ход.
-         *
-         * @return std::pair<int, int> — координаты выбранного хода (x, y)
+         * @brief Выводит сообщение об ошибке; ход спрашивается снова.
          */
-        std::pair<int, int> get_move();
+        bool on_invalid_move(std::pair<int, int> move) override;
 
-        Core::Color get_color();
+        bool interactive() const override { return true; }
     };
 
 } // namespace Player
@@ -1,26 +1,61 @@
 #pragma once
 
 #include "core/board.h"
+#include "utils/async.h"
 
 #include <utility>
 
 namespace Player
 {
+    /**
+     * @brief Участник партии.
+     *
+     * Ход запрашивается асинхронно: get_move - корутина, и пока игрок
+     * думает или ждет ввода, поток цикла событий (Utils::EventLoop) ведет
+     * другие партии (см. Core::Game::run_async).
+     */
     class Player
     {
     protected:
-        Core::Color m_color; 
+        Core::Color m_color;
 
     public:
         Player(Core::Color color) : m_color(color) {}
 
+        virtual ~Player() = default;
+
         /**
          * @brief Запрашивает у игрока ход.
          *
+         * Позиция не меняется, пока корутина не завершится.
+         *
          * @param situation Текущее состояние доски.
-         * @return std::pair<int, int> — координаты выбранного хода (x, y)
+         * @return std::pair<int, int> — координаты выбранного хода от 0 (x, y);
+         * (-1, -1), если хода не будет (ввод закончился, игрок отключился).
+         */
+        virtual Utils::Async<std::pair<int, int>> get_move(Core::Situation &situation) = 0;
+
+        /**
+         * @brief Сообщает игроку, что его ход move недопустим.
+         *
+         * Движок или удаленная программа, вернувшие недопустимый ход, скорее
+         * всего вернут его снова, поэтому по умолчанию партия прерывается.
+         *
+         * @return true Если у игрока нужно спросить ход еще раз.
+         */
+        virtual bool on_invalid_move(std::pair<int, int> move)
+        {
+            (void)move;
+            return false;
+        }
+
+        /**
+         * @brief Ход делает человек, глядя на доску.
+         *
+         * Кадр перед таким ходом рисуется всегда, даже при ограничении
+         * частоты кадров (Utils::Render::set_frame_interval).
          */
-        virtual std::pair<int, int> get_move(Core::Situation &situation) = 0;
+        virtual bool interactive() const { return false; }
 
         Core::Color get_color() const { return m_color; }
     };
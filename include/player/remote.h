@@ -0,0 +1,38 @@
+#pragma once
+
+#include "core/board.h"
+#include "player/player.h"
+#include "utils/event_loop.h"
+
+#include <utility>
+
+namespace Player
+{
+    /**
+     * @brief Игрок в другом процессе, подключенный локальным каналом.
+     *
+     * Протокол построчный. Перед каждым ходом игроку отправляется
+     * "position <позиция>" в нотации Core::Notation, в ответ ожидается
+     * "<x> <y>" (координаты от 0, как в ответах сервера анализа).
+     * Ответ "resign", конец ввода или нераспознанная строка - отказ от
+     * хода. Недопустимый ход заканчивает партию Core::Game::run_async
+     * незавершенной: повторного запроса хода нет.
+     *
+     * Дескрипторы остаются во владении вызывающего; дескриптор записи
+     * переводится в неблокирующий режим. Для одного сокета (socketpair)
+     * можно передать его дважды.
+     */
+    class Remote : public Player
+    {
+    private:
+        Utils::EventLoop &m_loop;
+        Utils::LineReader m_input;
+        int m_output;
+
+    public:
+        Remote(Core::Color color, Utils::EventLoop &loop, int input_fd, int output_fd);
+
+        Utils::Async<std::pair<int, int>> get_move(Core::Situation &situation) override;
+    };
+
+} // namespace Player
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace AI
+{
+    /**
+     * @brief Счетчики кэша оценок.
+     */
+    struct EvalCacheStats
+    {
+        std::uint64_t probes = 0; ///< Обращений к кэшу.
+        std::uint64_t hits = 0;   ///< Найденных оценок.
+
+        double hit_rate() const { return probes > 0 ? static_cast<double>(hits) / probes : 0; }
+    };
+
+    /**
+     * @brief Кэш статических оценок позиций.
+     *
+     * В отличие от таблицы транспозиций хранит не результат поиска, а
+     * только оценку листа, поэтому записи не зависят от глубины и границ
+     * окна. Таблица прямого отображения: ключ выбирает единственную
+     * запись, новая оценка всегда затирает старую. Размер по умолчанию
+     * (DEFAULT_ENTRIES записей по 16 байт) помещается в кэш L2.
+     *
+     * Кэш принадлежит одному экземпляру Ips и не потокобезопасен.
+     */
+    class EvalCache
+    {
+    public:
+        static constexpr std::size_t DEFAULT_ENTRIES = 1 << 14;
+
+    private:
+        struct Entry
+        {
+            std::uint64_t key = 0;
+            std::int32_t score = 0;
+        };
+
+        std::vector<Entry> m_entries;
+        std::size_t m_mask;
+        EvalCacheStats m_stats;
+
+    public:
+        /**
+         * @brief Создает кэш на entries записей (округляется вниз до степени двойки).
+         *
+         * @param entries Число записей; 0 - кэш выключен.
+         */
+        explicit EvalCache(std::size_t entries = 0);
+
+        /**
+         * @brief Меняет размер кэша (содержимое и счетчики очищаются).
+         */
+        void resize(std::size_t entries);
+
+        /**
+         * @brief Память под кэш не выделена.
+         */
+        bool empty() const;
+
+        std::size_t size() const;
+
+        /**
+         * @brief Забывает оценки (счетчики сохраняются).
+         */
+        void clear();
+
+        /**
+         * @brief Поиск оценки позиции.
+         *
+         * @param key Ключ позиции (не 0).
+         * @param score Найденная оценка.
+         * @return true Если оценка найдена.
+         */
+        bool probe(std::uint64_t key, int &score)
+        {
+            if (m_entries.empty())
+                return false;
+
+            m_stats.probes++;
+            const Entry &entry = m_entries[key & m_mask];
+            if (entry.key != key)
+                return false;
+
+            m_stats.hits++;
+            score = entry.score;
+            return true;
+        }
+
+        void store(std::uint64_t key, int score)
+        {
+            if (m_entries.empty())
+                return;
+
+            Entry &entry = m_entries[key & m_mask];
+            entry.key = key;
+            entry.score = score;
+        }
+
+        const EvalCacheStats &stats() const;
+
+        void reset_stats();
+    };
+
+} // namespace AI
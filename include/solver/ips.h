@@ -1,13 +1,63 @@
 #pragma once
 
 #include "core/board.h"
+#include "core/constans.h"
+#include "core/unbounded.h"
+#include "solver/nnue.h"
+#include "solver/mcts.h"
+#include "solver/movelist.h"
+#include "solver/ttable.h"
+#include "solver/evalcache.h"
 
 #include <vector>
+#include <optional>
 #include <utility>
+#include <string>
+#include <cstdint>
+#include <chrono>
 
 namespace AI
 {
+    /**
+     * @brief Оценка выигрыша; выигрыш пятеркой ходом номер ply от корня
+     * оценивается WIN_SCORE - ply (см. win_in).
+     *
+     * Поэтому из двух выигрышей лучше более быстрый, а из двух проигрышей -
+     * более долгий.
+     */
+    constexpr int WIN_SCORE = static_cast<int>(Core::Constants::Heights::FiveInRow);
+
+    /**
+     * @brief Оценки по модулю не меньше - выигрыши.
+     */
+    constexpr int MATE_BOUND = WIN_SCORE - 1000;
 
+    /**
+     * @brief Оценка выигрыша пятеркой, поставленной ходом номер ply.
+     */
+    constexpr int win_in(int ply)
+    {
+        return WIN_SCORE - ply;
+    }
+
+    /**
+     * @brief Сдвиг оценки выигрыша на plies ходов к нулю (отрицательное
+     * plies - от нуля); остальные оценки не меняются.
+     *
+     * Выигрыш через n ходов от позиции на plies ходов глубже - это выигрыш
+     * через n + plies ходов от текущей.
+     */
+    constexpr int shift_mate(int score, int plies)
+    {
+        return score >= MATE_BOUND ? score - plies : score <= -MATE_BOUND ? score + plies : score;
+    }
+
+    /**
+     * @brief Набор паттернов линии.
+     *
+     * Используется и как счетчик найденных паттернов, и как набор весов
+     * оценочной функции (см. count_impact).
+     */
     struct Patterns
     {
         int TwoInRow;
@@ -18,6 +68,66 @@ namespace AI
         int DoubleThreat;
     };
 
+    /**
+     * @brief Веса по умолчанию из Constants::Heights.
+     */
+    Patterns default_weights();
+
+    /**
+     * @brief Подсчет итогового веса паттерна.
+     *
+     * @param pattern Подсчитанные паттерны.
+     * @param weights Веса паттернов.
+     * @return int Суммарный вес.
+     */
+    int count_impact(const Patterns &pattern, const Patterns &weights);
+
+    /**
+     * @brief Загружает веса из текстового файла.
+     *
+     * Формат: по одной строке "<имя> <значение>", имена совпадают с полями
+     * Patterns. Отсутствующие в файле веса не меняются.
+     *
+     * @return false Если файл не удалось открыть или он содержит неизвестное имя.
+     */
+    bool load_weights(const std::string &path, Patterns &weights);
+
+    /**
+     * @brief Сохраняет веса в текстовый файл (формат load_weights).
+     */
+    bool save_weights(const std::string &path, const Patterns &weights);
+
+    /**
+     * @brief Оценочная функция, используемая поиском.
+     */
+    enum class EvalKind
+    {
+        Handcrafted, ///< Паттерны линий с весами Patterns (evaluate_position).
+        Nnue         ///< Квантованная нейросеть с инкрементальным аккумулятором.
+    };
+
+    /**
+     * @brief Линия анализа: ход из корня, его оценка и основная линия.
+     */
+    struct PvLine
+    {
+        std::pair<int, int> move{-1, -1};
+        int score = 0;                        ///< С точки зрения ходящей стороны.
+        std::vector<std::pair<int, int>> pv;  ///< Начинается с move.
+    };
+
+    /**
+     * @brief Результат анализа позиции (Ips::analyze).
+     */
+    struct SearchResult
+    {
+        std::pair<int, int> best_move{-1, -1}; ///< {-1, -1}, если ходов нет.
+        int score = 0;
+        int depth = 0;                         ///< Последняя завершенная итерация.
+        std::uint64_t nodes = 0;
+        std::vector<PvLine> lines;             ///< Лучшие ходы по убыванию оценки.
+    };
+
     /**
      * @brief Класс, реализующий алгоритмы поиска хода для игрового ИИ.
      *
@@ -27,8 +137,64 @@ namespace AI
      */
     class Ips
     {
+        friend class Mcts; ///< Использует генерацию ходов и эвристики Ips.
+
     private:
         Core::Color m_color; ///< Цвет игрока, за которого играет ИИ.
+        Patterns m_weights;  ///< Веса паттернов оценочной функции.
+        Core::Constants::SearchAlgo m_algo; ///< Алгоритм поиска хода.
+        EvalKind m_eval;                    ///< Выбранная оценочная функция.
+        Nnue::Evaluator m_nnue;             ///< Стек аккумуляторов нейросети.
+        bool m_nnue_active;                 ///< Нейросеть используется в текущем поиске.
+        std::uint64_t m_nodes;              ///< Число ходов, сделанных в поиске.
+        MctsOptions m_mcts;                 ///< Параметры SearchAlgo::Mcts.
+        Mcts m_mcts_tree;                   ///< Дерево SearchAlgo::Mcts; пул узлов переиспользуется между ходами.
+        SearchArena m_arena;                ///< Списки ходов и флаги по уровням поиска.
+        EvalCache m_eval_cache;             ///< Статические оценки уже оцененных позиций.
+        std::size_t m_eval_cache_entries;   ///< Размер кэша оценок (выделяется при поиске).
+
+        // Память поиска, сохраняемая между вызовами get_move
+        static constexpr int HISTORY_LIMIT = 1000; ///< Предел добавки истории к оценке хода.
+        TranspositionTable m_tt;                   ///< Собственная таблица транспозиций.
+        TranspositionTable *m_table;               ///< Используемая таблица: m_tt или общая.
+        std::size_t m_hash_mb;                     ///< Размер таблицы транспозиций, МБ.
+        std::vector<int> m_history[2];             ///< Таблицы истории отсечений по цветам.
+        int m_history_size;                        ///< Размер поля, для которого заведены таблицы истории.
+        std::vector<std::pair<int, int>> m_pv;     ///< Основная линия прошлого поиска.
+        std::vector<std::pair<int, int>> m_expected; ///< Линия, по которой упорядочивается текущая итерация.
+        std::vector<std::vector<std::pair<int, int>>> m_pv_lines; ///< Основные линии по уровням.
+        bool m_follow_pv;                          ///< Поиск еще идет по m_expected.
+        std::uint64_t m_pv_hits;                   ///< Сколько раз соперник ответил ожидаемым ходом.
+
+        // Ограничения и выборочность альфа-бета поиска
+        bool m_pruning;                            ///< LMR, futility/razoring и multi-cut включены.
+        int m_max_depth;                           ///< Предельная глубина итеративного углубления.
+        int m_time_ms;                             ///< Время на ход, мс (0 - без ограничения).
+        std::chrono::steady_clock::time_point m_deadline;
+        bool m_aborted;                            ///< Поиск прерван по времени.
+        int m_last_depth;                          ///< Глубина последней завершенной итерации.
+        int m_last_score;                          ///< Оценка последней завершенной итерации.
+        std::vector<PvLine> m_lines;               ///< Линии текущей итерации.
+        std::vector<PvLine> m_best_lines;          ///< Линии последней завершенной итерации.
+        int m_best_count;                          ///< Сколько линий в m_best_lines.
+
+        /**
+         * @brief Подготовка оценки к поиску из позиции situation.
+         */
+        void prepare_search(Core::Situation &situation);
+
+        /**
+         * @brief Ключ кэша оценок: хэш позиции, размер поля, правила,
+         * цвет оценки и вид оценочной функции.
+         */
+        std::uint64_t eval_key(Core::Situation &situation, Core::Color color) const;
+
+        /**
+         * @brief Ход и его отмена в поиске с обновлением аккумулятора сети.
+         */
+        void make_move(Core::Situation &situation, std::pair<int, int> move, Core::Color color);
+
+        void undo_move(Core::Situation &situation);
 
         /**
          * @brief Поиск хода с использованием алгоритма поиска в глубину (DFS).
@@ -47,12 +213,12 @@ namespace AI
         std::pair<int, int> heur_find(Core::Situation &situation);
 
         /**
-         * @brief Извлекает все камни с доски в виде вектора координат.
+         * @brief Извлекает все камни с доски в список координат.
          *
          * @param situation Текущая игровая ситуация.
-         * @return std::vector<std::pair<int,int>> Вектор координат всех камней.
+         * @param stones Список для координат всех камней.
          */
-        std::vector<std::pair<int, int>> extract_stones(Core::Situation &situation);
+        void extract_stones(Core::Situation &situation, MoveList &stones);
 
         /**
          * @brief Генерирует все возможные ходы на пустые клетки доски.
@@ -66,12 +232,28 @@ namespace AI
          * @brief Генерирует "умные" ходы только в окрестности существующих камней.
          *
          * Ходы генерируются только в радиусе 2 клеток от каждого существующего камня.
-         * Это уменьшает количество рассматриваемых ходов.
+         * Это уменьшает количество рассматриваемых ходов. В тактических
+         * позициях список сокращается до вынужденных ходов (restrict_forced).
          *
          * @param situation Текущая игровая ситуация.
-         * @return std::vector<std::pair<int,int>> Вектор координат "умных" ходов.
+         * @param color Цвет ходящего игрока (запрещенные для черных клетки пропускаются).
+         * @param arena Рабочая память генерации (своя у каждого потока).
+         * @param moves Список для "умных" ходов.
          */
-        std::vector<std::pair<int, int>> generate_moves_smart(Core::Situation &situation);
+        void generate_moves_smart(Core::Situation &situation, Core::Color color,
+                                  SearchArena &arena, MoveList &moves);
+
+        /**
+         * @brief Оставляет в moves только вынужденные ходы стороны color.
+         *
+         * По карте угроз (Situation::threats):
+         *  - есть своя пятерка - остается один выигрывающий ход;
+         *  - у соперника четверка - только блоки его пятерки;
+         *  - у соперника открытая тройка - блоки тройки и свои четверки.
+         * Иначе список не меняется. Метод использует только situation и
+         * потокобезопасен (его вызывают потоки Mcts).
+         */
+        void restrict_forced(Core::Situation &situation, Core::Color color, MoveList &moves);
 
         /**
          * @brief Возвращает все камни на доске.
@@ -96,19 +278,90 @@ namespace AI
 
         int evaluate_position(Core::Situation &situation, Core::Color color);
 
-        int minimax_recursive(Core::Situation &situation, int depth, bool maximizing_player, Core::Color color);
+        int minimax_recursive(Core::Situation &situation, int depth, int ply, bool maximizing_player, Core::Color color);
 
-        std::pair<int, int> heur_find(Core::Situation &situation);
 
-        int alphabeta_recursive(Core::Situation &situation, int depth, int alpha, int beta,
-                                bool maximizing_player, Core::Color color);
+        int alphabeta_recursive(Core::Situation &situation, int depth, int ply, int alpha, int beta,
+                                bool maximizing_player, Core::Color color, bool cut_node);
+
+        /**
+         * @brief Является ли ход угрозой (четверка, тройка или защита от чужой четверки).
+         */
+        bool is_threat(Core::Situation &situation, std::pair<int, int> move, Core::Color color);
+
+        /**
+         * @brief Надбавка к оценке хода при сортировке по карте угроз.
+         */
+        int threat_bonus(Core::Situation &situation, std::pair<int, int> move, Core::Color color) const;
+
+        /**
+         * @brief Запас futility-отсечения для оставшейся глубины depth.
+         */
+        int futility_margin(int depth) const;
+
+        /**
+         * @brief Истекло ли время на текущий поиск.
+         */
+        bool time_is_up() const;
 
         std::pair<int, int> alphabeta(Core::Situation &situation);
 
-        void generate_moves_sorted(std::vector<std::pair<int, int>> &moves,
-                                     Core::Situation &situation,
-                                     Core::Color color,
-                                     bool is_maximizing);
+        /**
+         * @brief Итеративное углубление с multi_pv лучшими линиями.
+         *
+         * Линии остаются в m_best_lines[0..m_best_count).
+         *
+         * @return Координаты лучшего хода.
+         */
+        std::pair<int, int> alphabeta_lines(Core::Situation &situation, int multi_pv);
+
+        /**
+         * @brief Ответ без поиска, когда в корне возможен только ход move.
+         */
+        std::pair<int, int> answer_forced(Core::Situation &situation, std::pair<int, int> move);
+
+        /**
+         * @brief Перебор корневых ходов, кроме уже найденных на итерации
+         * линий m_lines[0..excluded).
+         *
+         * @param move Лучший ход ({-1, -1}, если ходов не осталось).
+         * @return int Оценка лучшего хода; вне (alpha, beta) - только граница.
+         */
+        int search_root(Core::Situation &situation, MoveList &moves, int excluded,
+                        int depth, int alpha, int beta, std::pair<int, int> &move);
+
+        /**
+         * @brief Продлевает линию лучшими ходами из таблицы транспозиций
+         * до length ходов (линия обрывается на узлах, взятых из таблицы).
+         */
+        void extend_pv(Core::Situation &situation, std::vector<std::pair<int, int>> &pv, int length);
+
+        /**
+         * @brief Оставляет по одному корневому ходу из каждой группы ходов,
+         * ведущих в симметричные друг другу позиции.
+         */
+        void remove_symmetric_moves(Core::Situation &situation, MoveList &moves, Core::Color color);
+
+        void generate_moves_sorted(MoveList &moves,
+                                   Core::Situation &situation,
+                                   Core::Color color,
+                                   std::pair<int, int> tt_move,
+                                   int ply);
+
+        /**
+         * @brief Подготовка таблиц к новому поиску (старение, продолжение основной линии).
+         */
+        void begin_search(Core::Situation &situation);
+
+        /**
+         * @brief Записывает основную линию уровня ply: move и линия уровня ply + 1.
+         */
+        void update_pv(int ply, std::pair<int, int> move);
+
+        /**
+         * @brief Поощряет в таблице истории ход, вызвавший отсечение.
+         */
+        void reward_history(Core::Color color, std::pair<int, int> move, int depth);
 
     public:
         /**
@@ -128,12 +381,147 @@ namespace AI
          */
         std::pair<int, int> get_move(Core::Situation &situation);
 
+        /**
+         * @brief Ход на неограниченном поле.
+         *
+         * Поиск идет в окне board.window(); ход переводится в абсолютные
+         * координаты.
+         *
+         * @return std::optional<std::pair<int, int>> Ход или nullopt, если ходов нет.
+         */
+        std::optional<std::pair<int, int>> get_move(Core::UnboundedSituation &board);
+
+        /**
+         * @brief Анализ позиции альфа-бета поиском (независимо от set_algorithm).
+         *
+         * Возвращает до multi_pv лучших ходов с точными оценками и основными
+         * линиями. Линии ищутся по очереди на каждой итерации: k-я - среди
+         * ходов, не вошедших в первые k, в окне вокруг своей оценки прошлой
+         * итерации с расширением при выходе за него. Таблица транспозиций
+         * у линий общая, поэтому поиск K линий заметно дешевле K поисков.
+         *
+         * @param multi_pv Число линий (не больше числа различных ходов).
+         */
+        SearchResult analyze(Core::Situation &situation, int multi_pv);
+
         /**
          * @brief Возвращает цвет игрока, за которого играет ИИ.
          *
          * @return Core::Color Цвет игрока.
          */
         Core::Color get_color();
+
+        /**
+         * @brief Задает веса паттернов оценочной функции.
+         */
+        void set_weights(const Patterns &weights);
+
+        const Patterns &get_weights() const;
+
+        /**
+         * @brief Задает алгоритм поиска (по умолчанию SEARCH_ALGORIMT).
+         */
+        void set_algorithm(Core::Constants::SearchAlgo algo);
+
+        /**
+         * @brief Задает размер таблицы транспозиций в мегабайтах.
+         */
+        void set_hash_size(std::size_t megabytes);
+
+        /**
+         * @brief Подключает общую таблицу транспозиций (nullptr - собственная).
+         *
+         * Таблицу могут одновременно использовать несколько экземпляров Ips
+         * в разных потоках; размер и поколения поиска (new_search) задает
+         * ее владелец. Таблица должна жить дольше Ips.
+         */
+        void set_shared_table(TranspositionTable *table);
+
+        /**
+         * @brief Забывает память поиска (новая партия).
+         *
+         * Общая таблица транспозиций не очищается.
+         */
+        void clear_memory();
+
+        /**
+         * @brief Сколько раз соперник отвечал ходом из основной линии прошлого поиска.
+         */
+        std::uint64_t get_pv_hits() const;
+
+        /**
+         * @brief Ограничения альфа-бета поиска.
+         *
+         * @param max_depth Предельная глубина итеративного углубления.
+         * @param time_ms Время на ход в миллисекундах (0 - только ограничение глубины).
+         */
+        void set_search_limits(int max_depth, int time_ms);
+
+        /**
+         * @brief Включает или выключает выборочный поиск (LMR, futility, multi-cut).
+         */
+        void set_pruning(bool enabled);
+
+        /**
+         * @brief Глубина последней завершенной итерации альфа-бета поиска.
+         */
+        int get_last_depth() const;
+
+        /**
+         * @brief Оценка лучшего хода последней завершенной итерации альфа-бета
+         * с точки зрения цвета Ips (0, если итераций не было).
+         */
+        int get_last_score() const;
+
+        /**
+         * @brief Задает параметры поиска Монте-Карло (время на ход, потоки и т.д.).
+         */
+        void set_mcts_options(const MctsOptions &options);
+
+        /**
+         * @brief Задает оценочную функцию.
+         *
+         * Нейросетевая оценка применяется, только если задана сеть для
+         * размера поля текущей позиции, иначе используется evaluate_position.
+         */
+        void set_evaluation(EvalKind kind);
+
+        /**
+         * @brief Задает сеть для EvalKind::Nnue (сеть должна жить дольше Ips).
+         */
+        void set_network(const Nnue::Network *network);
+
+        /**
+         * @brief Задает размер кэша статических оценок (EvalCache).
+         *
+         * @param entries Число записей (округляется вниз до степени двойки);
+         * 0 - оценки не кэшируются.
+         */
+        void set_eval_cache_size(std::size_t entries);
+
+        /**
+         * @brief Обращения к кэшу оценок и попадания с момента его создания.
+         */
+        const EvalCacheStats &get_eval_cache_stats() const;
+
+        /**
+         * @brief Число узлов (сделанных в поиске ходов) с момента создания.
+         *
+         * Для SearchAlgo::Mcts учитываются итерации (доигрывания).
+         */
+        std::uint64_t get_nodes() const;
+
+        /**
+         * @brief Признаки позиции для настройки весов.
+         *
+         * Оценка evaluate_position линейна по весам:
+         * evaluate_position(situation, color) == count_impact(count_features(situation, color), weights).
+         *
+         * @param situation Текущая игровая ситуация.
+         * @param color Цвет, с точки зрения которого считаются признаки.
+         * @return Patterns Взвешиваемые количества паттернов.
+         */
+        Patterns count_features(Core::Situation &situation, Core::Color color);
     };
 
 } // namespace AI
\ No newline at end of file
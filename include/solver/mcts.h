@@ -0,0 +1,163 @@
+#pragma once
+
+#include "core/board.h"
+#include "core/constans.h"
+#include "solver/movelist.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace AI
+{
+    class Ips;
+
+    /**
+     * @brief Параметры поиска Монте-Карло.
+     */
+    struct MctsOptions
+    {
+        int threads = 0;           ///< Число потоков (0 - по числу ядер).
+        int time_ms = Core::Constants::MCTS_TIME_MS; ///< Ограничение времени на ход.
+        int max_iterations = 0;    ///< Ограничение числа итераций (0 - без ограничения).
+        int max_nodes = 1 << 20;   ///< Размер пула узлов.
+        int max_children = 24;     ///< Сколько лучших по эвристике ходов раскрывается в узле.
+        double exploration = 1.4;  ///< Коэффициент исследования PUCT.
+        int virtual_loss = 3;      ///< Виртуальные проигрыши на узел, через который идет поток.
+        unsigned seed = 1;         ///< Зерно генераторов случайных чисел потоков.
+    };
+
+    /**
+     * @brief Поиск хода методом Монте-Карло по дереву (PUCT).
+     *
+     * Узлы дерева лежат в одном заранее выделенном массиве, дети узла
+     * занимают непрерывный отрезок, поэтому спуск по дереву обходит память
+     * последовательно. Объект принадлежит Ips и живет между ходами: пул
+     * узлов выделяется один раз, а раскрытие и доигрывания пользуются
+     * аренами потоков (SearchArena), поэтому итерации не обращаются к куче. Несколько потоков строят общее дерево; чтобы они
+     * не спускались по одному пути, пройденные узлы временно получают
+     * виртуальные проигрыши.
+     *
+     * Априорные вероятности ходов и ходы в случайных доигрываниях
+     * выбираются по паттернам Ips::row_assessment с весами Ips.
+     * Поиск ограничен по времени и в любой момент может вернуть лучший
+     * найденный ход.
+     */
+    class Mcts
+    {
+    private:
+        /**
+         * @brief Узел дерева: позиция после хода (x, y).
+         *
+         * Оценка value хранится с точки зрения игрока, сделавшего ход в узел:
+         * победа - 2, ничья - 1, поражение - 0.
+         */
+        struct Node
+        {
+            std::int16_t x, y;
+            float prior;                      ///< Априорная вероятность хода.
+            std::int32_t first_child;         ///< Индекс первого ребенка или -1.
+            std::int32_t child_count;
+            std::atomic<std::int32_t> visits; ///< Посещения (с учетом виртуальных).
+            std::atomic<std::int64_t> value;  ///< Сумма результатов.
+            std::atomic<std::uint8_t> state;  ///< 0 - лист, 1 - раскрывается, 2 - раскрыт.
+        };
+
+        /**
+         * @brief Рабочие объекты потока поиска, переиспользуемые между поисками.
+         */
+        struct Worker
+        {
+            Core::Situation situation; ///< Копия корневой позиции.
+            SearchArena arena;
+            std::vector<std::int32_t> path; ///< Узлы текущего спуска.
+
+            Worker();
+        };
+
+        Ips &m_ips; ///< Источник эвристик; используется только для чтения.
+        MctsOptions m_options;
+        std::unique_ptr<Node[]> m_pool;
+        std::int32_t m_capacity; ///< Размер выделенного пула узлов.
+        std::vector<Worker> m_workers;
+        std::atomic<std::int32_t> m_used;
+        std::atomic<std::int64_t> m_iterations;
+        std::atomic<bool> m_stop;
+        std::chrono::steady_clock::time_point m_deadline;
+
+        /**
+         * @brief Эвристическая срочность хода по паттернам row_assessment обеих сторон.
+         */
+        int urgency(Core::Situation &situation, std::pair<int, int> move, Core::Color color) const;
+
+        /**
+         * @brief Выделяет count подряд идущих узлов пула.
+         *
+         * @return std::int32_t Индекс первого узла или -1, если пул исчерпан.
+         */
+        std::int32_t allocate(int count);
+
+        /**
+         * @brief Раскрытие узла: дети - лучшие по эвристике ходы стороны color.
+         *
+         * Если среди ходов есть выигрывающий, раскрывается только он.
+         * Вызывающий поток должен перевести state узла из 0 в 1.
+         *
+         * @param arena Рабочая память генерации ходов вызывающего потока.
+         */
+        void expand(std::int32_t index, Core::Situation &situation, Core::Color color, SearchArena &arena);
+
+        /**
+         * @brief Выбор ребенка по формуле PUCT.
+         */
+        std::int32_t select(std::int32_t index) const;
+
+        /**
+         * @brief Случайное доигрывание от текущей позиции.
+         *
+         * @param color Цвет ходящего игрока.
+         * @return Core::Color Победитель или Core::Color::None при ничьей.
+         */
+        Core::Color playout(Core::Situation &situation, Core::Color color, std::mt19937 &rng,
+                            SearchArena &arena) const;
+
+        /**
+         * @brief Одна итерация: спуск, раскрытие, доигрывание, обратный проход.
+         */
+        void iterate(Core::Situation &situation, Core::Color root_color,
+                     std::vector<std::int32_t> &path, std::mt19937 &rng, SearchArena &arena);
+
+        void worker(Worker &state, Core::Color root_color, unsigned seed);
+
+    public:
+        /**
+         * @brief Пул узлов выделяется при первом поиске (см. search).
+         */
+        explicit Mcts(Ips &ips);
+
+        Mcts(const Mcts &) = delete;
+        Mcts &operator=(const Mcts &) = delete;
+
+        /**
+         * @brief Параметры следующих поисков.
+         */
+        void set_options(const MctsOptions &options);
+
+        /**
+         * @brief Поиск хода стороны color в позиции situation.
+         *
+         * @return std::pair<int, int> Самый посещаемый ход или {-1, -1}, если ходов нет.
+         */
+        std::pair<int, int> search(Core::Situation &situation, Core::Color color);
+
+        /**
+         * @brief Число выполненных итераций последнего поиска.
+         */
+        std::int64_t get_iterations() const;
+    };
+
+} // namespace AI
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace AI
+{
+    /**
+     * @brief Список ходов фиксированной емкости поверх чужого буфера.
+     *
+     * Память списку не принадлежит: ее выдает SearchArena, поэтому
+     * создание, заполнение и копирование списка не обращаются к куче.
+     */
+    class MoveList
+    {
+    private:
+        std::pair<int, int> *m_data;
+        int m_size;
+        int m_capacity;
+
+    public:
+        MoveList() : m_data(nullptr), m_size(0), m_capacity(0) {}
+        MoveList(std::pair<int, int> *data, int capacity) : m_data(data), m_size(0), m_capacity(capacity) {}
+
+        /**
+         * @brief Добавляет ход; при заполненном буфере ход отбрасывается.
+         */
+        void push_back(std::pair<int, int> move)
+        {
+            if (m_size < m_capacity)
+                m_data[m_size++] = move;
+        }
+
+        void clear() { m_size = 0; }
+
+        /**
+         * @brief Оставляет первые count ходов.
+         */
+        void truncate(std::size_t count)
+        {
+            if (count < size())
+                m_size = static_cast<int>(count);
+        }
+        bool empty() const { return m_size == 0; }
+        std::size_t size() const { return static_cast<std::size_t>(m_size); }
+        int capacity() const { return m_capacity; }
+
+        std::pair<int, int> &operator[](std::size_t i) { return m_data[i]; }
+        const std::pair<int, int> &operator[](std::size_t i) const { return m_data[i]; }
+
+        std::pair<int, int> *begin() { return m_data; }
+        std::pair<int, int> *end() { return m_data + m_size; }
+        const std::pair<int, int> *begin() const { return m_data; }
+        const std::pair<int, int> *end() const { return m_data + m_size; }
+    };
+
+    /**
+     * @brief Рабочая память поиска, выделяемая один раз на поиск.
+     *
+     * Каждому уровню ply принадлежит свой участок буферов ходов и флагов:
+     * они живут, пока узел перебирает детей. Буферы камней, оценок
+     * сортировки, ключей и отметок клеток общие, так как нужны только
+     * внутри генерации и сортировки ходов, которые не вызывают рекурсию.
+     *
+     * reserve выделяет память только при росте глубины или размера поля,
+     * поэтому повторные поиски на том же поле работают без выделений.
+     * Арена не потокобезопасна: каждому потоку нужна своя.
+     */
+    class SearchArena
+    {
+    private:
+        int m_plies;
+        int m_cells;
+        std::vector<std::pair<int, int>> m_moves; ///< Ходы уровней: m_plies x m_cells.
+        std::vector<std::uint8_t> m_flags;        ///< Флаги ходов уровней: m_plies x m_cells.
+        std::vector<std::pair<int, int>> m_stones;
+        std::vector<int> m_scores;
+        std::vector<std::uint64_t> m_keys;
+        std::vector<std::uint32_t> m_marks; ///< Метки клеток (совпадение с m_stamp - клетка отмечена).
+        std::uint32_t m_stamp;
+
+    public:
+        SearchArena();
+
+        /**
+         * @brief Готовит память для plies уровней поля из cells клеток.
+         */
+        void reserve(int plies, int cells);
+
+        int plies() const;
+
+        /**
+         * @brief Пустой список ходов уровня ply емкостью в поле.
+         */
+        MoveList moves(int ply);
+
+        /**
+         * @brief Флаги ходов уровня ply (по одному на ход списка moves(ply)).
+         */
+        std::uint8_t *flags(int ply);
+
+        /**
+         * @brief Пустой список для камней поля.
+         */
+        MoveList stones();
+
+        /**
+         * @brief Буфер оценок для сортировки ходов (по одной на клетку).
+         */
+        int *scores();
+
+        /**
+         * @brief Буфер 64-битных ключей (по одному на клетку), например хэшей позиций.
+         */
+        std::uint64_t *keys();
+
+        /**
+         * @brief Начинает новую отметку клеток: все клетки становятся неотмеченными.
+         */
+        void begin_marks();
+
+        /**
+         * @brief Отмечает клетку.
+         *
+         * @return true Если клетка не была отмечена с последнего begin_marks.
+         */
+        bool mark(int cell)
+        {
+            if (m_marks[cell] == m_stamp)
+                return false;
+            m_marks[cell] = m_stamp;
+            return true;
+        }
+
+        bool is_marked(int cell) const { return m_marks[cell] == m_stamp; }
+    };
+
+} // namespace AI
@@ -0,0 +1,199 @@
+#pragma once
+
+#include "core/board.h"
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace AI::Nnue
+{
+    /**
+     * @brief Число нейронов первого (аккумулирующего) слоя на одну перспективу.
+     *
+     * Кратно 16, чтобы векторные проходы Core::Simd не обрабатывали хвосты.
+     */
+    inline constexpr int HIDDEN = 128;
+
+    /**
+     * @brief Сдвиг, переводящий выход сети в единицы оценочной функции.
+     *
+     * Итоговая оценка: (bias + sum(clamp(acc) * w)) * scale >> OUTPUT_SHIFT.
+     */
+    inline constexpr int OUTPUT_SHIFT = 12;
+
+    /**
+     * @brief Квантованная сеть: доска -> HIDDEN x 2 -> 1.
+     *
+     * Вход - разреженные признаки "камень своего / чужого цвета в клетке".
+     * Для каждой перспективы (белые и черные) первый слой суммирует
+     * столбцы весов поставленных камней в аккумулятор int16. Выходной
+     * слой применяет ограниченную активацию clamp(0, 127) к аккумуляторам
+     * ходящей стороны и соперника и умножает их на int8-веса.
+     *
+     * Формат файла (little-endian):
+     *  - "RNUE", версия (uint32), размер поля (uint32), HIDDEN (uint32);
+     *  - смещения первого слоя: int16[HIDDEN];
+     *  - веса первого слоя: int16[2 * size * size][HIDDEN];
+     *  - веса выходного слоя: int8[2 * HIDDEN];
+     *  - смещение выхода (int32) и масштаб (int32).
+     */
+    class Network
+    {
+    private:
+        int m_size;
+        std::vector<std::int16_t> m_bias;    ///< Смещения первого слоя.
+        std::vector<std::int16_t> m_weights; ///< Столбцы признаков первого слоя.
+        std::vector<std::int8_t> m_output;   ///< Веса выходного слоя (свои, чужие).
+        std::int32_t m_output_bias;
+        std::int32_t m_scale;
+
+    public:
+        Network();
+
+        /**
+         * @brief Загружает сеть из файла.
+         *
+         * @return false Если файл не открыт, поврежден или собран для другого HIDDEN.
+         */
+        bool load(const std::string &path);
+
+        /**
+         * @brief Сохраняет сеть в файл (формат load).
+         */
+        bool save(const std::string &path) const;
+
+        /**
+         * @brief Заполняет сеть случайными весами.
+         *
+         * Используется для замеров скорости без обученной сети.
+         */
+        void randomize(int size, unsigned seed);
+
+        /**
+         * @brief Размер поля, для которого построена сеть (0 - сеть пуста).
+         */
+        int get_size() const;
+
+        /**
+         * @brief Номер признака камня цвета stone в клетке (x, y) для перспективы view.
+         */
+        int feature(int x, int y, Core::Color stone, Core::Color view) const;
+
+        /**
+         * @brief Столбец весов признака (HIDDEN значений).
+         */
+        const std::int16_t *column(int feature) const;
+
+        const std::int16_t *bias() const;
+
+        /**
+         * @brief Выход сети по аккумуляторам ходящей стороны и соперника.
+         */
+        int propagate(const std::int16_t *us, const std::int16_t *them) const;
+    };
+
+    /**
+     * @brief Аккумуляторы обеих перспектив для одной позиции.
+     */
+    struct Accumulator
+    {
+        alignas(32) std::int16_t values[2][HIDDEN]; ///< Индекс - Core::Color (White, Black).
+    };
+
+    /**
+     * @brief Инкрементальная оценка позиции в ходе поиска.
+     *
+     * Хранит стек аккумуляторов: push копирует верхний аккумулятор и
+     * добавляет столбцы поставленного камня, pop просто снимает его.
+     * refresh пересчитывает корневой аккумулятор с нуля.
+     */
+    class Evaluator
+    {
+    private:
+        const Network *m_network;
+        std::vector<Accumulator> m_stack;
+        int m_top;
+
+    public:
+        Evaluator();
+
+        /**
+         * @brief Задает сеть (nullptr - оценка отключена).
+         */
+        void set_network(const Network *network);
+
+        /**
+         * @brief Пригодна ли сеть для позиции (сеть задана и размер поля совпадает).
+         */
+        bool ready(Core::Situation &situation) const;
+
+        /**
+         * @brief Выделяет стек на depth ходов вперед, чтобы push не выделял память.
+         */
+        void reserve(int depth);
+
+        /**
+         * @brief Пересчитывает аккумулятор позиции с нуля и очищает стек.
+         */
+        void refresh(Core::Situation &situation);
+
+        /**
+         * @brief Добавляет в стек аккумулятор позиции после хода (x, y) цветом color.
+         */
+        void push(int x, int y, Core::Color color);
+
+        /**
+         * @brief Возвращается к аккумулятору позиции до последнего push.
+         */
+        void pop();
+
+        /**
+         * @brief Оценка текущей позиции с точки зрения цвета color.
+         */
+        int evaluate(Core::Color color) const;
+    };
+
+    /**
+     * @brief Запись обучающих данных для сети.
+     *
+     * Каждая позиция партии записывается строкой
+     * "<нотация Core::Notation>\t<результат>", где результат - 1, 0.5 или 0
+     * с точки зрения стороны, которой принадлежит ход.
+     */
+    class TrainingExporter
+    {
+    private:
+        std::ofstream m_file;
+        std::size_t m_written;
+
+    public:
+        /**
+         * @brief Открывает файл на дозапись.
+         */
+        explicit TrainingExporter(const std::string &path);
+
+        bool is_open() const;
+
+        /**
+         * @brief Записывает одну позицию.
+         */
+        void write(Core::Situation &situation, Core::Color to_move, Core::Status result);
+
+        /**
+         * @brief Записывает все позиции законченной партии.
+         *
+         * @param final Итоговая позиция; ходы и их цвета восстанавливаются по ее истории.
+         * @param setup_moves Число камней начальной расстановки (позиции до них не пишутся).
+         * @param result Итог партии.
+         */
+        void write_game(Core::Situation &final, int setup_moves, Core::Status result);
+
+        /**
+         * @brief Число записанных позиций.
+         */
+        std::size_t written() const;
+    };
+
+} // namespace AI::Nnue
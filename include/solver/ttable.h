@@ -0,0 +1,119 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace AI
+{
+    /**
+     * @brief Тип оценки, сохраненной в таблице.
+     */
+    enum class Bound : std::uint8_t
+    {
+        None,  ///< Пустая запись.
+        Exact, ///< Точная оценка.
+        Lower, ///< Оценка не меньше сохраненной (было отсечение по beta).
+        Upper  ///< Оценка не больше сохраненной (ни один ход не улучшил alpha).
+    };
+
+    /**
+     * @brief Запись таблицы транспозиций (распакованная).
+     */
+    struct TTEntry
+    {
+        std::uint64_t key;
+        std::int32_t score; ///< Оценка с точки зрения стороны, которой принадлежит ход.
+        std::int8_t depth;  ///< Оставшаяся глубина, на которой получена оценка.
+        Bound bound;
+        std::uint8_t age;   ///< Поколение поиска, записавшего оценку.
+        std::int8_t x, y;   ///< Лучший ход (-1, если неизвестен); поле не больше MAX_BOARD_SIZE.
+    };
+
+    /**
+     * @brief Таблица транспозиций, сохраняемая между ходами.
+     *
+     * Записи сгруппированы в корзины по 4 (одна линия кэша). При записи
+     * в заполненную корзину вытесняется запись с наименьшей ценностью:
+     * глубина минус удвоенный возраст. Поэтому записи прошлых поисков
+     * постепенно уступают место новым, но глубокие результаты, полезные
+     * после ожидаемого ответа соперника, сохраняются.
+     *
+     * Таблицу могут одновременно читать и писать несколько потоков без
+     * блокировок. Запись хранится двумя 64-битными словами: упакованные
+     * данные и ключ, сложенный с ними по XOR. Если слова записаны разными
+     * потоками, ключ не сойдется и запись будет считаться отсутствующей.
+     */
+    class TranspositionTable
+    {
+    private:
+        static constexpr int BUCKET = 4;
+
+        struct Slot
+        {
+            std::atomic<std::uint64_t> check{0}; ///< key ^ data.
+            std::atomic<std::uint64_t> data{0};  ///< Упакованная запись (pack).
+        };
+
+        std::unique_ptr<Slot[]> m_slots;
+        std::size_t m_count; ///< Число записей.
+        std::size_t m_mask;  ///< Число корзин минус 1.
+        std::atomic<std::uint8_t> m_age;
+
+        static std::uint64_t pack(int score, int depth, Bound bound, std::uint8_t age, int x, int y);
+        static TTEntry unpack(std::uint64_t key, std::uint64_t data);
+
+        /**
+         * @brief Чтение записи слота (key == 0 и Bound::None, если слот пуст).
+         */
+        static TTEntry read(const Slot &slot);
+
+    public:
+        /**
+         * @brief Создает таблицу примерно на megabytes мегабайт.
+         *
+         * @param megabytes Размер; 0 - пустая таблица без памяти (см. empty()).
+         */
+        explicit TranspositionTable(std::size_t megabytes = 0);
+
+        /**
+         * @brief Меняет размер таблицы (содержимое очищается).
+         *
+         * @warning В отличие от остальных методов не потокобезопасен.
+         */
+        void resize(std::size_t megabytes);
+
+        /**
+         * @brief Память под таблицу не выделена.
+         */
+        bool empty() const;
+
+        void clear();
+
+        /**
+         * @brief Начало нового поиска: записи предыдущих поисков стареют.
+         */
+        void new_search();
+
+        /**
+         * @brief Поиск записи позиции.
+         *
+         * @param key Ключ позиции.
+         * @param entry Копия найденной записи.
+         * @return true Если запись найдена.
+         */
+        bool probe(std::uint64_t key, TTEntry &entry) const;
+
+        /**
+         * @brief Сохраняет результат поиска позиции.
+         */
+        void store(std::uint64_t key, int depth, int score, Bound bound, int x, int y);
+
+        /**
+         * @brief Доля занятых записей текущего поколения в первых 1000 корзинах (в тысячных).
+         */
+        int hashfull() const;
+    };
+
+} // namespace AI
@@ -0,0 +1,244 @@
+#pragma once
+
+#include "core/board.h"
+
+#include <cstdint>
+#include <cstddef>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace Storage
+{
+    /**
+     * @brief Кто играл за сторону в записанной партии.
+     */
+    enum class PlayerKind : std::uint8_t
+    {
+        Human = 0,
+        Engine = 1,
+        Unknown = 255
+    };
+
+    /**
+     * @brief Максимальный размер поля, для которого ход помещается в один байт.
+     */
+    inline constexpr int MAX_RECORD_SIZE = 16;
+
+    /**
+     * @brief Заголовок одной партии в файле записей.
+     *
+     * Состоит только из байтовых полей, поэтому может читаться напрямую
+     * из отображенной в память области без выравнивания и копирования.
+     * За заголовком следуют setup_white + setup_black байт начальной
+     * расстановки (сначала белые, затем черные), затем move_count байт ходов.
+     * Ход кодируется как (y << 4) | x, цвета ходов чередуются начиная с цвета,
+     * заданного флагом FLAG_BLACK_FIRST.
+     */
+    struct RecordHeader
+    {
+        std::uint8_t size;         ///< Размер поля.
+        std::uint8_t rules;        ///< Core::Rules.
+        std::uint8_t white_player; ///< PlayerKind белых.
+        std::uint8_t black_player; ///< PlayerKind черных.
+        std::uint8_t result;       ///< Core::Status (white_wins, black_wins, draw, ongoing).
+        std::uint8_t flags;        ///< Битовые флаги, см. FLAG_*.
+        std::uint8_t setup_white;  ///< Число белых камней начальной расстановки.
+        std::uint8_t setup_black;  ///< Число черных камней начальной расстановки.
+        std::uint8_t move_count_lo;
+        std::uint8_t move_count_hi;
+
+        static constexpr std::uint8_t FLAG_BLACK_FIRST = 1;
+
+        int move_count() const { return move_count_lo | (move_count_hi << 8); }
+
+        int setup_count() const { return setup_white + setup_black; }
+
+        /**
+         * @brief Полный размер записи партии в байтах (заголовок и ходы).
+         */
+        std::size_t record_size() const { return sizeof(RecordHeader) + setup_count() + move_count(); }
+
+        /**
+         * @brief Проверяет поля заголовка: размер поля не больше
+         * MAX_RECORD_SIZE, известные правила, результат, игроки и флаги,
+         * камней не больше, чем клеток поля.
+         */
+        bool is_valid() const;
+    };
+
+    static_assert(sizeof(RecordHeader) == 10, "RecordHeader must stay byte-packed");
+
+    /**
+     * @brief Партия, подготовленная к записи.
+     */
+    struct GameRecord
+    {
+        RecordHeader header{};
+        std::vector<std::uint8_t> body; ///< Начальная расстановка и ходы.
+
+        /**
+         * @brief Собирает запись из истории ходов ситуации.
+         *
+         * Первые setup_moves ходов истории считаются начальной расстановкой,
+         * остальные - ходами партии. Цвета берутся с доски.
+         *
+         * @return false Если поле больше MAX_RECORD_SIZE или цвета ходов партии не чередуются.
+         */
+        bool assign(Core::Situation &situation, int setup_moves,
+                    PlayerKind white, PlayerKind black, Core::Status result);
+    };
+
+    /**
+     * @brief Легковесное представление партии внутри отображенного файла.
+     *
+     * Не владеет памятью и действительно, пока жив RecordReader. Заголовок
+     * партии, полученной от RecordReader, уже проверен (RecordHeader::is_valid).
+     */
+    struct GameView
+    {
+        const RecordHeader *header = nullptr;
+        const std::uint8_t *setup = nullptr;
+        const std::uint8_t *moves = nullptr;
+
+        int move_count() const { return header->move_count(); }
+
+        Core::Color first_color() const;
+
+        /**
+         * @brief Переигрывает партию в ситуацию.
+         *
+         * Ситуация очищается через Situation::reset, поэтому при совпадающем
+         * размере поля память не выделяется. Начальная расстановка ставится
+         * по свободным правилам, правила партии применяются после нее.
+         *
+         * @param situation Ситуация, в которую расставляются камни.
+         * @param moves Сколько ходов партии применить (-1 - все).
+         * @return false Если запись повреждена (ход вне поля или в занятую клетку).
+         */
+        bool replay(Core::Situation &situation, int moves = -1) const;
+
+        /**
+         * @brief Цвет хода с номером index (после начальной расстановки).
+         */
+        Core::Color move_color(int index) const;
+
+        /**
+         * @brief Декодирует байт хода в координаты.
+         */
+        static std::pair<int, int> decode(std::uint8_t move) { return {move & 0x0F, move >> 4}; }
+
+        static std::uint8_t encode(int x, int y) { return static_cast<std::uint8_t>((y << 4) | x); }
+    };
+
+    /**
+     * @brief Дописывает партии в конец файла записей и его индекса.
+     *
+     * Файл данных (path) начинается с 16-байтового заголовка, за которым
+     * подряд идут записи партий. Индекс (path + ".idx") хранит 64-битные
+     * смещения начала каждой партии.
+     *
+     * Если файл данных есть, а индекса нет, индекс восстанавливается по
+     * записям файла данных. Файл данных с чужой сигнатурой или обрезанной
+     * записью не открывается (is_open() == false).
+     */
+    class RecordWriter
+    {
+    private:
+        std::ofstream m_data;
+        std::ofstream m_index;
+        std::uint64_t m_offset;
+
+        /**
+         * @brief Записывает в m_index смещения всех партий файла данных.
+         *
+         * @return false Если сигнатура не совпала или запись повреждена.
+         */
+        bool rebuild_index(const std::string &path);
+
+    public:
+        explicit RecordWriter(const std::string &path);
+
+        bool is_open() const;
+
+        /**
+         * @brief Дописывает партию.
+         *
+         * @return false Если запись не удалась.
+         */
+        bool append(const GameRecord &record);
+
+        void flush();
+    };
+
+    /**
+     * @brief Читатель файла записей через отображение в память.
+     *
+     * Партии читаются без копирования и выделения памяти: GameView
+     * указывает прямо в отображенную область. Если индекс есть, доступ
+     * к партии по номеру выполняется за O(1), иначе - последовательный обход.
+     */
+    class RecordReader
+    {
+    private:
+        struct Mapping
+        {
+            const std::uint8_t *data = nullptr;
+            std::size_t size = 0;
+#ifdef _WIN32
+            void *file = nullptr;
+            void *map = nullptr;
+#endif
+        };
+
+        Mapping m_data;
+        Mapping m_index;
+
+        static Mapping map_file(const std::string &path);
+        static void unmap(Mapping &mapping);
+
+    public:
+        /**
+         * @brief Последовательный итератор по партиям.
+         */
+        class iterator
+        {
+        private:
+            const std::uint8_t *m_pos;
+            const std::uint8_t *m_end;
+
+        public:
+            iterator(const std::uint8_t *pos, const std::uint8_t *end);
+
+            GameView operator*() const;
+            iterator &operator++();
+            bool operator!=(const iterator &other) const { return m_pos != other.m_pos; }
+        };
+
+        explicit RecordReader(const std::string &path);
+        ~RecordReader();
+
+        RecordReader(const RecordReader &) = delete;
+        RecordReader &operator=(const RecordReader &) = delete;
+
+        bool is_open() const;
+
+        /**
+         * @brief Число партий по индексу (0, если индекса нет).
+         */
+        std::size_t indexed_count() const;
+
+        /**
+         * @brief Партия по номеру из индекса.
+         *
+         * @return std::nullopt Если номер не меньше indexed_count(), смещение
+         * из индекса указывает за пределы записей или запись повреждена.
+         */
+        std::optional<GameView> at(std::size_t index) const;
+
+        iterator begin() const;
+        iterator end() const;
+    };
+
+} // namespace Storage
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Tools
+{
+    /**
+     * @brief Ведется ли счетчик allocation_count.
+     *
+     * Глобальные operator new заменяются только в сборке с опцией CMake
+     * RENJU_COUNT_ALLOCATIONS.
+     */
+    bool allocation_counting();
+
+    /**
+     * @brief Число выделений памяти через operator new с начала работы программы.
+     *
+     * Счетчик ведут замененные глобальные operator new (src/tools/allocations.cpp);
+     * разность значений до и после участка кода показывает, сколько раз
+     * он обращался к куче. Используется командой "bench". Без опции
+     * RENJU_COUNT_ALLOCATIONS всегда 0.
+     */
+    std::uint64_t allocation_count();
+
+} // namespace Tools
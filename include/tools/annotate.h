@@ -0,0 +1,73 @@
+#pragma once
+
+#include "core/constans.h"
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+namespace Tools
+{
+    /**
+     * @brief Параметры разметки записанных партий.
+     */
+    struct AnnotateOptions
+    {
+        std::string input;           ///< Файл записей (Storage::RecordReader).
+        int threads = 0;             ///< Потоков (0 - по числу ядер).
+        std::size_t hash_mb = 64;    ///< Общая таблица транспозиций, МБ.
+        int depth = 4;               ///< Глубина альфа-бета поиска в каждой позиции.
+        int time_ms = 0;             ///< Время на позицию (0 - только глубина).
+        int blunder = static_cast<int>(Core::Constants::Heights::FourInRow); ///< Потеря оценки, считающаяся зевком.
+        long long games = -1;        ///< Сколько партий разметить (-1 - все).
+    };
+
+    /**
+     * @brief Итог разметки.
+     */
+    struct AnnotateStats
+    {
+        std::uint64_t games = 0;     ///< Размеченных партий.
+        std::uint64_t corrupt = 0;   ///< Поврежденных записей.
+        std::uint64_t positions = 0; ///< Позиций, в которых выполнен поиск.
+        std::uint64_t nodes = 0;     ///< Узлов поиска.
+        std::uint64_t blunders = 0;  ///< Ходов с пометкой blunder.
+        double seconds = 0;
+
+        double positions_per_second() const { return seconds > 0 ? positions / seconds : 0; }
+    };
+
+    /**
+     * @brief Размечает партии файла записей и пишет разметку в out.
+     *
+     * Каждая партия переигрывается через Core::Situation, и в позиции
+     * перед каждым ходом выполняется поиск AI::Ips с одинаковым бюджетом
+     * (depth, time_ms). Партии размечаются параллельно, по партии на
+     * задачу пула: у потока свои движки, таблица транспозиций общая.
+     * Разметка выводится по мере готовности, но в порядке партий в файле.
+     *
+     * Формат (оценки - с точки зрения сделавшего ход):
+     *   game <номер> size <n> result <итог> moves <m> blunders <белых> <черных>
+     *   move <номер> <w|b> <x> <y> score <оценка хода> best <x> <y> <оценка лучшего> [blunder]
+     * Оценка хода - оценка позиции после него (поиск соперника с обратным
+     * знаком). Ход помечается blunder, если он упускает выигрыш, ведет к
+     * проигрышу или хуже лучшего хода не меньше чем на blunder.
+     * Поврежденная запись дает строку
+     * "game <номер> corrupt".
+     */
+    AnnotateStats annotate_records(const AnnotateOptions &options, std::ostream &out);
+
+    /**
+     * @brief Точка входа команды "annotate".
+     *
+     * renju-game annotate --in file [--out file] [--threads N] [--hash MB]
+     *                     [--depth N] [--time ms] [--blunder N] [--games N]
+     *
+     * Без --out разметка печатается в стандартный вывод, итог (партии,
+     * позиции в секунду) - в стандартный поток ошибок.
+     *
+     * @return int Код возврата процесса.
+     */
+    int annotate_main(int argc, char **argv);
+
+} // namespace Tools
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "solver/ips.h"
+#include "core/constans.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Tools
+{
+    /**
+     * @brief Параметры замера скорости поиска.
+     */
+    struct BenchOptions
+    {
+        int positions = 4;            ///< Число случайных позиций (если не задан файл).
+        int board_size = Core::Constants::FIELD_SIZE;
+        unsigned seed = 1;            ///< Зерно генератора позиций.
+        Core::Constants::SearchAlgo algo = Core::Constants::SearchAlgo::AlphaBeta;
+        std::string positions_file;   ///< Файл позиций в нотации Core::Notation.
+        std::string network_file;     ///< Файл нейросети (пусто - случайная сеть).
+        int depth = Core::Constants::ALPHABETA_MAX_DEPTH; ///< Предельная глубина альфа-бета.
+        int time_ms = Core::Constants::SEARCH_TIME_MS;    ///< Время на позицию (0 - без ограничения).
+        bool pruning = true;          ///< Выборочный поиск альфа-бета.
+        std::vector<int> boards;      ///< Поля замера масштабирования (0 - неограниченное).
+        std::size_t eval_cache = AI::EvalCache::DEFAULT_ENTRIES; ///< Записей кэша оценок (0 - без кэша).
+    };
+
+    /**
+     * @brief Результат замера для одной оценочной функции.
+     */
+    struct BenchResult
+    {
+        std::uint64_t nodes = 0; ///< Узлов поиска по всем позициям.
+        double seconds = 0;      ///< Суммарное время поиска.
+        int depth_sum = 0;       ///< Сумма достигнутых глубин альфа-бета.
+        int positions = 0;
+        std::uint64_t allocations = 0; ///< Выделений памяти во время замеряемых поисков.
+        std::uint64_t eval_probes = 0; ///< Обращений к кэшу оценок.
+        std::uint64_t eval_hits = 0;   ///< Попаданий в кэш оценок.
+
+        double nodes_per_second() const { return seconds > 0 ? nodes / seconds : 0; }
+    };
+
+    /**
+     * @brief Поиск хода во всех позициях с оценкой kind.
+     *
+     * @param network Сеть для AI::EvalKind::Nnue (может быть nullptr для Handcrafted).
+     */
+    BenchResult run_bench(const BenchOptions &options, AI::EvalKind kind, const AI::Nnue::Network *network);
+
+    /**
+     * @brief Замер масштабирования по размеру поля (оценка Handcrafted).
+     *
+     * На каждом поле ищутся одни и те же случайные позиции: камни стоят
+     * в квадрате 7x7 вокруг центра. Размер 0 - неограниченное поле
+     * (Core::UnboundedSituation), позиции сдвигаются далеко от начала
+     * координат. Если поиск зависит от числа камней, а не от площади,
+     * время на узел одинаково на всех полях.
+     */
+    BenchResult run_board_bench(const BenchOptions &options, int size);
+
+    /**
+     * @brief Точка входа команды "bench".
+     *
+     * renju-game bench [--eval hce|nnue|both] [--net file] [--positions file]
+     *                  [--count N] [--size N] [--seed N] [--algo minimax|alphabeta|mcts]
+     *                  [--depth N] [--time ms] [--no-pruning] [--trace file]
+     *                  [--boards 15,19,31,unbounded] [--eval-cache N]
+     *
+     * Без --net используется сеть со случайными весами: для замера скорости
+     * значения весов не важны. В сборке с RENJU_COUNT_ALLOCATIONS в отчете
+     * печатается и число выделений памяти за время поиска (см.
+     * Tools::allocation_count): для минимакса и альфа-бета после прогрева
+     * оно должно быть нулевым. Если кэш
+     * оценок включен (--eval-cache, 0 - выключен), печатается доля попаданий.
+     *
+     * С --boards вместо обычного замера выполняется run_board_bench для
+     * каждого перечисленного поля.
+     *
+     * С --trace события меток трассировки (utils/trace.h) записываются
+     * в файл JSON Chrome trace.
+     *
+     * @return int Код возврата процесса.
+     */
+    int bench_main(int argc, char **argv);
+
+} // namespace Tools
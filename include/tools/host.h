@@ -0,0 +1,211 @@
+#pragma once
+
+#include "core/game.h"
+#include "core/constans.h"
+#include "solver/ips.h"
+#include "solver/ttable.h"
+#include "utils/thread_pool.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Tools
+{
+    /**
+     * @brief Параметры узла партий.
+     */
+    struct HostOptions
+    {
+        int workers = 0;            ///< Потоков поиска (0 - по числу ядер).
+        std::size_t hash_mb = 64;   ///< Общая таблица транспозиций, МБ.
+        int move_time_ms = Core::Constants::SEARCH_TIME_MS; ///< Предельное время хода ИИ.
+        int max_depth = Core::Constants::ALPHABETA_MAX_DEPTH;
+        Core::Constants::SearchAlgo algo = Core::Constants::SearchAlgo::AlphaBeta;
+    };
+
+    /**
+     * @brief Счетчики узла партий.
+     */
+    struct HostStats
+    {
+        std::size_t active_games = 0;   ///< Незавершенных партий.
+        std::size_t queued_moves = 0;   ///< Ходов ИИ, ожидающих потока.
+        std::size_t running_moves = 0;  ///< Ходов ИИ в поиске.
+        std::uint64_t ai_moves = 0;     ///< Сделанных ходов ИИ.
+        std::uint64_t finished_games = 0;
+        double latency_avg_ms = 0;      ///< Среднее ожидание хода ИИ в очереди.
+        double latency_max_ms = 0;      ///< Наибольшее ожидание.
+    };
+
+    /**
+     * @brief Узел, ведущий множество партий Core::Game одновременно.
+     *
+     * Партии не занимают потоков: ход ИИ - это задача в общем пуле
+     * Utils::WorkStealingPool по числу ядер. У каждого потока пула свои
+     * движки AI::Ips (по одному на цвет) с общей таблицей транспозиций,
+     * поэтому память не растет с числом партий.
+     *
+     * Справедливость: у партии в очереди не больше одного хода ИИ, а
+     * следующий ход ставится в конец очереди, после ходов других партий.
+     * Время хода ограничено move_time_ms и остатком контроля времени
+     * партии, поделенным на ожидаемое число оставшихся ходов, поэтому
+     * одна партия не может надолго занять поток.
+     */
+    class GameHost
+    {
+    public:
+        using SessionId = std::uint64_t;
+
+        /**
+         * @brief Вызывается из потока пула после каждого хода ИИ.
+         *
+         * Ходы одной партии сообщаются по порядку: следующий ход ИИ в ней
+         * ставится в очередь, только когда обработчик вернул управление.
+         */
+        using MoveCallback = std::function<void(SessionId, std::pair<int, int>, const Core::MoveResult &)>;
+
+    private:
+        struct Session
+        {
+            SessionId id;
+            Core::Game game;
+            bool ai[2];          ///< Играет ли ИИ белыми [0] и черными [1].
+            int clock_ms;        ///< Остаток времени ИИ на партию (< 0 - без контроля).
+            std::mutex mutex;    ///< Ход человека и ход ИИ не выполняются одновременно.
+            bool scheduled;      ///< Ход ИИ поставлен в очередь (под mutex).
+            bool closed;
+
+            Session(SessionId id, Core::Game game) : id(id), game(std::move(game)), ai{false, false},
+                                                     clock_ms(-1), scheduled(false), closed(false) {}
+        };
+
+        /**
+         * @brief Движки одного потока пула.
+         */
+        struct Engines
+        {
+            AI::Ips white;
+            AI::Ips black;
+            Engines() : white(Core::Color::White), black(Core::Color::Black) {}
+        };
+
+        HostOptions m_options;
+        AI::TranspositionTable m_table;
+        std::vector<std::unique_ptr<Engines>> m_engines;
+        MoveCallback m_callback;
+
+        std::mutex m_mutex;
+        std::condition_variable m_finished; ///< Завершилась партия.
+        std::unordered_map<SessionId, std::shared_ptr<Session>> m_sessions;
+        SessionId m_next_id;
+        std::size_t m_active;
+        std::uint64_t m_finished_games;
+        std::uint64_t m_ai_moves;
+        double m_latency_sum_ms;
+        double m_latency_max_ms;
+
+        std::atomic<std::size_t> m_queued;
+        std::atomic<std::size_t> m_running;
+
+        Utils::WorkStealingPool m_pool; ///< Последним: его потоки пользуются полями выше.
+
+        /**
+         * @brief Ставит ход ИИ, если ход за ИИ и он еще не в очереди.
+         *
+         * Вызывается под session.mutex.
+         */
+        void schedule(const std::shared_ptr<Session> &session);
+
+        /**
+         * @brief Задача пула: поиск и ход ИИ.
+         */
+        void think(const std::shared_ptr<Session> &session, std::chrono::steady_clock::time_point queued);
+
+        void finish(const Session &session);
+
+    public:
+        explicit GameHost(const HostOptions &options);
+        ~GameHost();
+
+        GameHost(const GameHost &) = delete;
+        GameHost &operator=(const GameHost &) = delete;
+
+        /**
+         * @brief Задает обработчик ходов ИИ (до создания партий).
+         */
+        void set_move_callback(MoveCallback callback);
+
+        /**
+         * @brief Создает партию; если первый ход за ИИ, он сразу ставится в очередь.
+         *
+         * @param turn Очередность хода: 1 - белые, -1 - черные.
+         * @param white_ai, black_ai Какими цветами играет ИИ.
+         * @param clock_ms Время ИИ на всю партию (< 0 - только move_time_ms на ход).
+         */
+        SessionId create(Core::Situation board, int turn, bool white_ai, bool black_ai, int clock_ms = -1);
+
+        /**
+         * @brief Ход человека в координатах от 0; ответ ИИ ставится в очередь.
+         *
+         * @return MoveResult Недопустимый, если партии нет, ход не за
+         * человеком или клетка занята.
+         */
+        Core::MoveResult play(SessionId id, int x, int y);
+
+        /**
+         * @brief Закрывает партию; ход ИИ в поиске доводится до конца, но не применяется.
+         */
+        void close(SessionId id);
+
+        /**
+         * @brief Итог партии (ongoing - партия идет или ее нет).
+         */
+        Core::Status get_result(SessionId id);
+
+        /**
+         * @brief Ждет, пока не останется незавершенных партий.
+         *
+         * Имеет смысл, когда все партии ведет ИИ.
+         */
+        void wait_all();
+
+        /**
+         * @brief Как wait_all, но не дольше timeout.
+         *
+         * @return true Если незавершенных партий не осталось.
+         */
+        bool wait_all_for(std::chrono::milliseconds timeout);
+
+        HostStats get_stats();
+    };
+
+    /**
+     * @brief Точка входа команды "host": параллельные партии ИИ против ИИ.
+     *
+     * renju-game host [--games N] [--workers N] [--size N] [--time ms]
+     *                 [--clock ms] [--depth N] [--hash MB] [--seed N]
+     *                 [--algo minimax|alphabeta|mcts] [--async] [--trace file]
+     *
+     * Печатает счетчики узла раз в секунду и итог: число партий, ходов в
+     * секунду и задержку планирования.
+     *
+     * С --async партии ведет не GameHost, а один цикл событий
+     * Utils::EventLoop: каждая партия - корутина Core::Game::run_async с
+     * игроками Player::Engine, поиск идет в Player::EnginePool. Контроль
+     * времени партии (--clock) в этом режиме не поддерживается, печатается
+     * только итог. Цикл событий собирается только на POSIX; на других
+     * платформах --async завершается с ошибкой.
+     *
+     * @return int Код возврата процесса.
+     */
+    int host_main(int argc, char **argv);
+
+} // namespace Tools
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "core/board.h"
+#include "core/constans.h"
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+namespace Tools
+{
+    /**
+     * @brief Параметры генератора дебютов.
+     */
+    struct OpeningOptions
+    {
+        int count = 1000;             ///< Сколько дебютов нужно.
+        int size = Core::Constants::FIELD_SIZE;
+        int min_stones = 2;           ///< Камней в дебюте: от min_stones до max_stones.
+        int max_stones = 8;
+        int radius = 3;               ///< Камни не дальше radius от центра (0 - все поле).
+        std::uint64_t seed = 1;
+        int threads = 0;              ///< Потоков (0 - по числу ядер).
+        int depth = 0;                ///< Глубина проверки альфа-бета (0 - без проверки).
+        int balance = 300;            ///< Допустимая оценка |score| при проверке движком.
+        bool unique = true;           ///< Отбрасывать дебюты, совпадающие с точностью до симметрии.
+    };
+
+    /**
+     * @brief Итог генерации.
+     */
+    struct OpeningStats
+    {
+        std::uint64_t written = 0;    ///< Записано дебютов.
+        std::uint64_t candidates = 0; ///< Рассмотрено расстановок.
+        std::uint64_t decided = 0;    ///< Отброшено: у стороны есть выигрыш в один ход.
+        std::uint64_t unbalanced = 0; ///< Отброшено по оценке движка.
+        std::uint64_t duplicates = 0; ///< Отброшено как повторы.
+    };
+
+    /**
+     * @brief Пишет count дебютов в out, по одному на строку в нотации Core::Notation.
+     *
+     * Дебют i строится Situation::create_random с зерном, полученным из
+     * seed и i, и проверяется независимо от остальных, поэтому кандидаты
+     * обрабатываются параллельно блоками, а результат не зависит от числа
+     * потоков: одни и те же параметры дают один и тот же файл.
+     *
+     * Дебют принимается, если ни у одной стороны нет пятерки в один ход,
+     * и, при depth > 0, если оценка альфа-бета поиска глубины depth (без
+     * ограничения времени) по модулю не больше balance.
+     */
+    OpeningStats generate_openings(const OpeningOptions &options, std::ostream &out);
+
+    /**
+     * @brief Точка входа команды "openings".
+     *
+     * renju-game openings [--count N] [--out file] [--size N] [--stones MIN MAX]
+     *                     [--radius N] [--seed N] [--threads N] [--depth N]
+     *                     [--balance N] [--allow-duplicates]
+     *
+     * Без --out дебюты печатаются в стандартный вывод.
+     *
+     * @return int Код возврата процесса.
+     */
+    int openings_main(int argc, char **argv);
+
+} // namespace Tools
@@ -0,0 +1,195 @@
+#pragma once
+
+#include "solver/ips.h"
+#include "solver/ttable.h"
+#include "core/constans.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Tools
+{
+    /**
+     * @brief Параметры сервера анализа.
+     */
+    struct ServerOptions
+    {
+        std::string socket_path = "/tmp/renju-game.sock"; ///< Путь Unix-сокета.
+        int port = 0;                 ///< Порт TCP на 127.0.0.1 (0 - Unix-сокет).
+        int workers = 0;              ///< Потоков поиска (0 - по числу ядер).
+        std::size_t hash_mb = 64;     ///< Размер общей таблицы транспозиций, МБ.
+        int default_time_ms = Core::Constants::SEARCH_TIME_MS; ///< Время запроса без явного ограничения.
+        int max_time_ms = 60000;      ///< Верхняя граница времени одного запроса.
+        std::size_t max_queue = 256;  ///< Длина очереди, сверх которой запросы отклоняются.
+        Core::Constants::SearchAlgo algo = Core::Constants::SearchAlgo::AlphaBeta;
+    };
+
+    /**
+     * @brief Счетчики сервера.
+     */
+    struct ServerStats
+    {
+        std::size_t queued = 0;       ///< Запросов в очереди.
+        std::size_t running = 0;      ///< Запросов в поиске.
+        std::uint64_t completed = 0;  ///< Выполненных запросов.
+        std::uint64_t rejected = 0;   ///< Отклоненных из-за переполнения очереди.
+        double latency_avg_ms = 0;    ///< Средняя задержка (от приема до ответа).
+        double latency_max_ms = 0;    ///< Наибольшая задержка.
+        int hashfull = 0;             ///< Заполненность общей таблицы, тысячные.
+    };
+
+    /**
+     * @brief Долгоживущий сервер анализа позиций.
+     *
+     * Сервер слушает Unix-сокет (или TCP на 127.0.0.1) и принимает
+     * построчные запросы. Запросы анализа ставятся в общую очередь и
+     * выполняются пулом потоков поиска. У каждого потока свои экземпляры
+     * AI::Ips, но таблица транспозиций общая (AI::Ips::set_shared_table),
+     * поэтому результаты одних запросов ускоряют другие.
+     *
+     * Протокол (строки через '\n'):
+     *  - "go <метка> <время, мс> <позиция>" - лучший ход в позиции в нотации
+     *    Core::Notation; время 0 - ограничение по умолчанию. Время считается
+     *    с момента приема: ожидание в очереди уменьшает время поиска.
+     *    Ответ: "bestmove <метка> <x> <y> depth <d> nodes <n> wait_ms <w> search_ms <s>"
+     *    (x и y равны -1, если ходов нет).
+     *  - "analyze <метка> <время, мс> <K> <позиция>" - K лучших ходов
+     *    альфа-бета поиском (AI::Ips::analyze): по строке на ход
+     *    "line <метка> <номер> <x> <y> score <s> pv <x>,<y> ...", затем
+     *    строка "bestmove" как у "go".
+     *  - "stats" - "stats queued <q> running <r> completed <c> rejected <j>
+     *    latency_avg_ms <a> latency_max_ms <m> hashfull <h>".
+     *  - "quit" - закрыть соединение; "shutdown" - остановить сервер.
+     * Ошибки: "error <метка> <сообщение>" или "error <сообщение>".
+     *
+     * Ответы на запросы анализа приходят по мере готовности, поэтому
+     * клиент может отправить несколько запросов подряд и сопоставить
+     * ответы по меткам.
+     */
+    class AnalysisServer
+    {
+    public:
+        using Reply = std::function<void(const std::string &)>;
+
+    private:
+        struct Request
+        {
+            std::string tag;
+            Core::Situation situation;
+            Core::Color to_move;
+            int time_ms;
+            int multi_pv; ///< 0 - запрос "go", иначе число линий "analyze".
+            std::chrono::steady_clock::time_point received;
+            Reply reply;
+        };
+
+        struct Connection;
+
+        ServerOptions m_options;
+        AI::TranspositionTable m_table;
+
+        std::mutex m_mutex;
+        std::condition_variable m_ready;
+        std::deque<Request> m_queue;
+        bool m_stopping;
+        std::size_t m_running;
+        std::uint64_t m_completed;
+        std::uint64_t m_rejected;
+        double m_latency_sum_ms;
+        double m_latency_max_ms;
+        std::vector<std::thread> m_workers;
+
+        int m_listen_fd;
+        std::atomic<bool> m_shutdown;
+        std::mutex m_connections_mutex;
+        std::condition_variable m_connections_closed;
+        std::vector<std::weak_ptr<Connection>> m_connections; ///< Для закрытия при остановке.
+        int m_connection_count;                               ///< Работающих потоков соединений.
+
+        /**
+         * @brief Цикл потока поиска: запросы берутся из очереди до остановки.
+         */
+        void worker();
+
+        /**
+         * @brief Поиск одного запроса и отправка ответа.
+         */
+        void process(Request &request, AI::Ips &white, AI::Ips &black);
+
+        /**
+         * @brief Чтение строк соединения до его закрытия.
+         */
+        void serve_connection(std::shared_ptr<Connection> connection);
+
+        /**
+         * @brief Ставит запрос в очередь; false, если очередь заполнена.
+         */
+        bool enqueue(Request request);
+
+    public:
+        explicit AnalysisServer(const ServerOptions &options);
+
+        /**
+         * @brief Останавливает потоки поиска; запросы в очереди отбрасываются.
+         */
+        ~AnalysisServer();
+
+        AnalysisServer(const AnalysisServer &) = delete;
+        AnalysisServer &operator=(const AnalysisServer &) = delete;
+
+        /**
+         * @brief Обрабатывает одну строку протокола.
+         *
+         * Ответ передается в reply; для запросов анализа - позже, из
+         * потока поиска. Метод потокобезопасен и не требует сокета.
+         *
+         * @return false Если соединение нужно закрыть ("quit", "shutdown").
+         */
+        bool handle_line(const std::string &line, const Reply &reply);
+
+        ServerStats get_stats();
+
+        /**
+         * @brief Открывает сокет.
+         *
+         * @return false Если сокет не удалось создать или привязать.
+         */
+        bool listen();
+
+        /**
+         * @brief Принимает соединения до вызова stop() или команды "shutdown".
+         *
+         * Перед возвратом закрывает все соединения и ждет их потоки.
+         */
+        void serve();
+
+        /**
+         * @brief Прекращает прием соединений (можно вызывать из любого потока).
+         */
+        void stop();
+    };
+
+    /**
+     * @brief Точка входа команды "serve".
+     *
+     * renju-game serve [--socket path | --port N] [--workers N] [--hash MB]
+     *                  [--time ms] [--max-time ms] [--queue N]
+     *                  [--algo minimax|alphabeta|mcts] [--trace file]
+     *
+     * С --trace события меток трассировки записываются в файл JSON Chrome
+     * trace при остановке сервера (команда "shutdown").
+     *
+     * @return int Код возврата процесса.
+     */
+    int server_main(int argc, char **argv);
+
+} // namespace Tools
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "solver/ips.h"
+#include "core/constans.h"
+
+#include <string>
+#include <vector>
+
+namespace Tools
+{
+    /**
+     * @brief Параметры настройки весов оценочной функции.
+     */
+    struct TunerOptions
+    {
+        int threads = 0;               ///< Число потоков (0 - по числу ядер).
+        int iterations = 100;          ///< Число итераций оптимизации.
+        int games_per_iteration = 16;  ///< SPSA: партий на итерацию (четное число).
+        int board_size = Core::Constants::FIELD_SIZE;
+        unsigned seed = 1;             ///< Зерно генератора случайных чисел.
+        Core::Constants::SearchAlgo algo = Core::Constants::SearchAlgo::AlphaBeta;
+        std::string output = "weights.txt";
+        AI::Patterns initial = AI::default_weights();
+    };
+
+    /**
+     * @brief Настройка весов логистической регрессией (метод Texel).
+     *
+     * Из записанных партий (см. Storage::RecordReader) извлекаются позиции
+     * и их признаки Ips::count_features. Затем веса подбираются так, чтобы
+     * sigmoid(K * оценка) лучше всего предсказывал результат партии.
+     * Извлечение признаков и вычисление градиента распараллелены.
+     *
+     * @param record_files Файлы записей партий.
+     * @param options Параметры настройки.
+     * @return AI::Patterns Настроенные веса.
+     */
+    AI::Patterns tune_texel(const std::vector<std::string> &record_files, const TunerOptions &options);
+
+    /**
+     * @brief Настройка весов методом SPSA по результатам самоигры.
+     *
+     * На каждой итерации все веса одновременно возмущаются в случайную
+     * сторону, пара движков с весами theta + c*delta и theta - c*delta
+     * играет серию партий (параллельно, с обменом цветами), и веса
+     * сдвигаются в сторону победившего набора.
+     *
+     * @param options Параметры настройки.
+     * @return AI::Patterns Настроенные веса.
+     */
+    AI::Patterns tune_spsa(const TunerOptions &options);
+
+    /**
+     * @brief Точка входа команды "tune".
+     *
+     * renju-game tune texel <records>... [--iterations N] [--threads N] [--weights in] [--out path]
+     * renju-game tune spsa [--iterations N] [--games N] [--threads N] [--size N] [--seed N]
+     *                      [--algo minimax|alphabeta|heuristic|mcts] [--weights in] [--out path]
+     *
+     * @return int Код возврата процесса.
+     */
+    int tune_main(int argc, char **argv);
+
+} // namespace Tools
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+
+namespace Utils
+{
+    template <typename T>
+    class Async;
+
+    namespace Detail
+    {
+        /**
+         * @brief Общая часть обещаний Async: продолжение и исключение.
+         *
+         * По завершении корутина передает управление ожидающей ее
+         * корутине (симметричная передача), поэтому цепочки co_await
+         * не растят стек.
+         */
+        class AsyncPromiseBase
+        {
+        private:
+            struct FinalAwaiter
+            {
+                bool await_ready() noexcept { return false; }
+
+                template <typename Promise>
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept
+                {
+                    const std::coroutine_handle<> next = handle.promise().m_continuation;
+                    return next ? next : std::noop_coroutine();
+                }
+
+                void await_resume() noexcept {}
+            };
+
+        public:
+            std::coroutine_handle<> m_continuation;
+            std::exception_ptr m_exception;
+
+            std::suspend_always initial_suspend() noexcept { return {}; }
+
+            FinalAwaiter final_suspend() noexcept { return {}; }
+
+            void unhandled_exception() { m_exception = std::current_exception(); }
+
+            void rethrow()
+            {
+                if (m_exception)
+                    std::rethrow_exception(m_exception);
+            }
+        };
+
+        template <typename T>
+        class AsyncPromise : public AsyncPromiseBase
+        {
+        public:
+            std::optional<T> m_value;
+
+            Async<T> get_return_object();
+
+            template <typename U>
+            void return_value(U &&value) { m_value.emplace(std::forward<U>(value)); }
+
+            T take()
+            {
+                rethrow();
+                return std::move(*m_value);
+            }
+        };
+
+        template <>
+        class AsyncPromise<void> : public AsyncPromiseBase
+        {
+        public:
+            Async<void> get_return_object();
+
+            void return_void() {}
+
+            void take() { rethrow(); }
+        };
+    } // namespace Detail
+
+    /**
+     * @brief Результат корутины: значение типа T, которое будет готово позже.
+     *
+     * Корутина ленивая: она начинает выполняться, когда ее ожидают
+     * (co_await) или запускают в цикле событий (EventLoop::spawn). Объект
+     * владеет кадром корутины и уничтожает его в деструкторе. Исключение,
+     * выброшенное в корутине, передается ожидающему в co_await.
+     */
+    template <typename T = void>
+    class Async
+    {
+    public:
+        using promise_type = Detail::AsyncPromise<T>;
+
+    private:
+        std::coroutine_handle<promise_type> m_handle;
+
+    public:
+        explicit Async(std::coroutine_handle<promise_type> handle) : m_handle(handle) {}
+
+        Async(Async &&other) noexcept : m_handle(std::exchange(other.m_handle, nullptr)) {}
+
+        Async &operator=(Async &&other) noexcept
+        {
+            if (this != &other)
+            {
+                if (m_handle)
+                    m_handle.destroy();
+                m_handle = std::exchange(other.m_handle, nullptr);
+            }
+            return *this;
+        }
+
+        Async(const Async &) = delete;
+        Async &operator=(const Async &) = delete;
+
+        ~Async()
+        {
+            if (m_handle)
+                m_handle.destroy();
+        }
+
+        bool await_ready() const noexcept { return !m_handle || m_handle.done(); }
+
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> continuation) noexcept
+        {
+            m_handle.promise().m_continuation = continuation;
+            return m_handle;
+        }
+
+        T await_resume() { return m_handle.promise().take(); }
+    };
+
+    namespace Detail
+    {
+        template <typename T>
+        Async<T> AsyncPromise<T>::get_return_object()
+        {
+            return Async<T>(std::coroutine_handle<AsyncPromise<T>>::from_promise(*this));
+        }
+
+        inline Async<void> AsyncPromise<void>::get_return_object()
+        {
+            return Async<void>(std::coroutine_handle<AsyncPromise<void>>::from_promise(*this));
+        }
+    } // namespace Detail
+
+} // namespace Utils
@@ -0,0 +1,239 @@
+#pragma once
+
+#include "utils/async.h"
+#include "utils/thread_pool.h"
+
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Utils
+{
+    /**
+     * @brief Однопоточный цикл событий для корутин Async.
+     *
+     * Корутины выполняются в потоке, вызвавшем run(), по очереди. Ожидание
+     * ввода (readable, writable) не занимает потока: корутина
+     * приостанавливается, а цикл ждет готовности всех дескрипторов сразу
+     * одним вызовом poll. Долгие вычисления (поиск хода) выносятся в пул
+     * потоков через offload, и корутина продолжается в цикле, когда
+     * результат готов. Поэтому тысячи партий, ожидающих людей или движок,
+     * обслуживаются одним потоком цикла.
+     */
+    class EventLoop
+    {
+    private:
+        struct Waiter
+        {
+            int fd;
+            short events;
+            std::coroutine_handle<> handle;
+        };
+
+        /**
+         * @brief Ожидание готовности дескриптора.
+         */
+        struct FdAwaiter
+        {
+            EventLoop &loop;
+            int fd;
+            short events;
+
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> handle) { loop.m_waiters.push_back({fd, events, handle}); }
+            void await_resume() const noexcept {}
+        };
+
+        /**
+         * @brief Вычисление в пуле потоков с продолжением в цикле.
+         */
+        template <typename F>
+        struct OffloadAwaiter
+        {
+            using Result = std::invoke_result_t<F &>;
+
+            EventLoop &loop;
+            WorkStealingPool &pool;
+            F function;
+            std::optional<Result> result;
+            std::exception_ptr exception;
+
+            bool await_ready() const noexcept { return false; }
+
+            void await_suspend(std::coroutine_handle<> handle)
+            {
+                pool.submit([this, handle]
+                            {
+                                try
+                                {
+                                    result.emplace(function());
+                                }
+                                catch (...)
+                                {
+                                    exception = std::current_exception();
+                                }
+                                loop.post(handle); });
+            }
+
+            Result await_resume()
+            {
+                if (exception)
+                    std::rethrow_exception(exception);
+                return std::move(*result);
+            }
+        };
+
+        /**
+         * @brief Корутина-обертка запущенной задачи: уничтожает себя по завершении.
+         */
+        struct Detached
+        {
+            struct promise_type
+            {
+                Detached get_return_object() { return {std::coroutine_handle<promise_type>::from_promise(*this)}; }
+                std::suspend_always initial_suspend() noexcept { return {}; }
+                std::suspend_never final_suspend() noexcept { return {}; }
+                void return_void() {}
+                void unhandled_exception() { std::terminate(); }
+            };
+
+            std::coroutine_handle<promise_type> handle;
+        };
+
+        std::deque<std::coroutine_handle<>> m_ready; ///< Готовые к продолжению (поток цикла).
+        std::vector<Waiter> m_waiters;               ///< Ждут готовности дескрипторов.
+        std::size_t m_tasks;                         ///< Незавершенных задач spawn.
+        std::exception_ptr m_error;                  ///< Первое исключение задачи.
+
+        std::mutex m_mutex;
+        std::vector<std::coroutine_handle<>> m_posted; ///< Продолжения из других потоков (под m_mutex).
+        int m_wake[2];                                 ///< Канал пробуждения poll из других потоков.
+
+        template <typename T>
+        static Detached run_task(EventLoop &loop, Async<T> task)
+        {
+            try
+            {
+                co_await task;
+            }
+            catch (...)
+            {
+                if (!loop.m_error)
+                    loop.m_error = std::current_exception();
+            }
+            loop.m_tasks--;
+        }
+
+        /**
+         * @brief Ждет событий дескрипторов и пробуждений; готовые корутины
+         * переносятся в m_ready.
+         *
+         * @param timeout_ms Предел ожидания (-1 - без предела, 0 - только проверка).
+         */
+        void wait_events(int timeout_ms);
+
+    public:
+        EventLoop();
+        ~EventLoop();
+
+        EventLoop(const EventLoop &) = delete;
+        EventLoop &operator=(const EventLoop &) = delete;
+
+        /**
+         * @brief Ставит задачу в цикл; она начнет выполняться в run().
+         *
+         * Результат задачи отбрасывается. Вызывается из потока цикла (в том
+         * числе из корутин).
+         */
+        template <typename T>
+        void spawn(Async<T> task)
+        {
+            m_tasks++;
+            m_ready.push_back(run_task(*this, std::move(task)).handle);
+        }
+
+        /**
+         * @brief Продолжает корутину в потоке цикла (можно вызывать из любого потока).
+         */
+        void post(std::coroutine_handle<> handle);
+
+        /**
+         * @brief co_await loop.readable(fd) - ждет данных (или конца ввода) в fd.
+         */
+        FdAwaiter readable(int fd);
+
+        /**
+         * @brief co_await loop.writable(fd) - ждет места для записи в fd.
+         */
+        FdAwaiter writable(int fd);
+
+        /**
+         * @brief co_await loop.offload(pool, function) - выполняет function
+         * в потоке пула и возвращает ее результат (не void).
+         *
+         * Пока функция выполняется, корутина приостановлена, поэтому
+         * функция может пользоваться ее данными без блокировок.
+         */
+        template <typename F>
+        OffloadAwaiter<F> offload(WorkStealingPool &pool, F function)
+        {
+            return {*this, pool, std::move(function), std::nullopt, nullptr};
+        }
+
+        /**
+         * @brief Выполняет задачи, пока не завершатся все поставленные spawn.
+         *
+         * Если задача выбросила исключение, оно выбрасывается из run()
+         * после завершения остальных задач.
+         */
+        void run();
+
+        /**
+         * @brief Число незавершенных задач.
+         */
+        std::size_t tasks() const;
+    };
+
+    /**
+     * @brief Построчное чтение дескриптора в цикле событий.
+     *
+     * Дескриптор не переводится в неблокирующий режим: read вызывается
+     * только после того, как poll сообщил о готовности, поэтому можно
+     * читать и стандартный ввод терминала.
+     */
+    class LineReader
+    {
+    private:
+        EventLoop &m_loop;
+        int m_fd;
+        std::string m_buffer;
+        bool m_eof;
+
+    public:
+        LineReader(EventLoop &loop, int fd);
+
+        /**
+         * @brief Следующая строка без '\n' (std::nullopt - ввод закончился).
+         */
+        Async<std::optional<std::string>> read_line();
+    };
+
+    /**
+     * @brief Записывает text в неблокирующий дескриптор целиком, ожидая
+     * места в цикле событий.
+     *
+     * В сокет запись идет без SIGPIPE, поэтому удаленный игрок лучше
+     * подключать через socketpair, а не pipe.
+     *
+     * @return false Если запись не удалась (например, читатель закрыл канал).
+     */
+    Async<bool> write_all(EventLoop &loop, int fd, std::string text);
+
+} // namespace Utils
@@ -2,12 +2,18 @@
 #include "core/board.h"
 
 #include "string"
+#include <chrono>
 
 namespace Utils
 {
 
     /**
      * @brief Класс, ответственный за отрисовку
+     *
+     * Кадр собирается в одном буфере и выводится одной записью.
+     * Между кадрами перерисовываются только изменившиеся клетки
+     * (перемещение курсора ANSI-последовательностями), поэтому
+     * консоль не очищается и не мерцает.
      */
     class Render
     {
@@ -17,13 +23,34 @@ namespace Utils
          * @brief Функция отрисовки доски в консоли
          *
          * @param board состояние поля и информация о камнях
+         * @param force нарисовать кадр, даже если интервал не прошел (перед
+         * ходом человека)
+         *
+         * @note Если задан интервал между кадрами (set_frame_interval) и он
+         * еще не прошел, кадр пропускается. Пропущенные изменения попадут
+         * в следующий выведенный кадр.
          */
-        static void very_simple_draw(Core::Situation &board);
+        static void very_simple_draw(Core::Situation &board, bool force = false);
         
 
         static void win(Core::Situation &board, Core::Status mess);
 
         static void mess(std::string mess);
+
+        /**
+         * @brief Включает ограничение частоты кадров.
+         *
+         * Полезно при наблюдении за партиями компьютер против компьютера,
+         * где ходы делаются быстрее, чем их имеет смысл отрисовывать.
+         *
+         * @param interval Минимальный интервал между кадрами (0 - без ограничения).
+         */
+        static void set_frame_interval(std::chrono::milliseconds interval);
+
+        /**
+         * @brief Сбрасывает сохраненный кадр: следующий кадр будет нарисован целиком.
+         */
+        static void invalidate();
         
     };
 } // namespace Utils
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Utils
+{
+    /**
+     * @brief Пул потоков с перехватом задач (work stealing).
+     *
+     * У каждого потока своя очередь. Задача, поставленная из потока пула,
+     * попадает в его очередь, поставленная извне - в очереди потоков по
+     * кругу. Поток берет задачи из начала своей очереди, а опустевший -
+     * перехватывает из конца чужих. Своя очередь разбирается по порядку
+     * (FIFO), поэтому задача, поставленная повторно, встает после уже
+     * ожидающих и не вытесняет их.
+     */
+    class WorkStealingPool
+    {
+    public:
+        using Task = std::function<void()>;
+
+    private:
+        struct Queue
+        {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        std::vector<std::unique_ptr<Queue>> m_queues;
+        std::vector<std::thread> m_threads;
+        std::atomic<std::size_t> m_next;    ///< Очередь для следующей внешней задачи.
+        std::atomic<std::size_t> m_pending; ///< Задач в очередях.
+
+        std::mutex m_mutex;
+        std::condition_variable m_wake; ///< Появилась задача или пул останавливается.
+        std::condition_variable m_idle; ///< Все задачи выполнены.
+        std::size_t m_unfinished;       ///< Поставлено, но не выполнено (под m_mutex).
+        bool m_stopping;
+
+        void worker(int index);
+
+        /**
+         * @brief Берет задачу из своей очереди или перехватывает чужую.
+         */
+        bool take(int index, Task &task);
+
+    public:
+        /**
+         * @param threads Число потоков (0 - по числу ядер).
+         */
+        explicit WorkStealingPool(int threads = 0);
+
+        /**
+         * @brief Останавливает потоки; невыполненные задачи отбрасываются.
+         */
+        ~WorkStealingPool();
+
+        WorkStealingPool(const WorkStealingPool &) = delete;
+        WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+        void submit(Task task);
+
+        /**
+         * @brief Ждет, пока не будут выполнены все задачи, включая
+         * поставленные во время ожидания.
+         */
+        void wait_idle();
+
+        int size() const;
+
+        /**
+         * @brief Число задач, ожидающих в очередях.
+         */
+        std::size_t pending() const;
+
+        /**
+         * @brief Номер вызывающего потока в пуле или -1 для чужого потока.
+         *
+         * Позволяет задачам пользоваться данными, заведенными на каждый
+         * поток пула, без блокировок.
+         */
+        int current_index() const;
+    };
+
+} // namespace Utils
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Трассировка горячих путей.
+ *
+ * Метки RENJU_TRACE_SCOPE("имя") записывают длительность области видимости
+ * в кольцевой буфер своего потока. Без опции сборки RENJU_TRACE метки
+ * раскрываются в пустой оператор и ничего не стоят; со сборочной опцией
+ * запись идет, только пока трассировка включена Utils::Trace::set_enabled,
+ * а выключенная метка стоит одной проверки флага.
+ *
+ * Записанное выгружается Utils::Trace::write_chrome_json в формате Chrome
+ * trace event: файл открывается в chrome://tracing или Perfetto.
+ */
+#ifdef RENJU_TRACE
+#define RENJU_TRACE_CONCAT_IMPL(a, b) a##b
+#define RENJU_TRACE_CONCAT(a, b) RENJU_TRACE_CONCAT_IMPL(a, b)
+#define RENJU_TRACE_SCOPE(name) \
+    ::Utils::Trace::Scope RENJU_TRACE_CONCAT(renju_trace_scope_, __LINE__)(name)
+#define RENJU_TRACE_SCOPE_VALUE(name, value) \
+    ::Utils::Trace::Scope RENJU_TRACE_CONCAT(renju_trace_scope_, __LINE__)(name, value)
+#else
+#define RENJU_TRACE_SCOPE(name) ((void)0)
+#define RENJU_TRACE_SCOPE_VALUE(name, value) ((void)0)
+#endif
+
+namespace Utils::Trace
+{
+    /**
+     * @brief Событий в буфере одного потока; старые события затираются.
+     */
+    inline constexpr std::uint32_t BUFFER_EVENTS = 1 << 16;
+
+    /**
+     * @brief Собрана ли программа с метками трассировки.
+     */
+    inline constexpr bool compiled_in()
+    {
+#ifdef RENJU_TRACE
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * @brief Флаг записи. Не использовать напрямую: см. set_enabled.
+     */
+    extern std::atomic<bool> g_enabled;
+
+    /**
+     * @brief Включает или выключает запись событий во всех потоках.
+     */
+    void set_enabled(bool enabled);
+
+    inline bool is_enabled()
+    {
+        return g_enabled.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Наносекунды от начала работы программы (steady_clock).
+     */
+    std::uint64_t now_ns();
+
+    /**
+     * @brief Записывает завершенное событие в буфер вызывающего потока.
+     *
+     * Без блокировок: у буфера один писатель, а читатель (выгрузка)
+     * по счетчику событий отбрасывает записи, которые могли быть затерты.
+     *
+     * @param name Имя события: литерал (строка должна жить до выгрузки)
+     * без кавычек и обратных косых черт - он пишется в JSON как есть.
+     * @param value Числовой аргумент события (например, глубина), < 0 - нет.
+     */
+    void record(const char *name, std::uint64_t start_ns, std::uint64_t end_ns, std::int64_t value);
+
+    /**
+     * @brief Выгружает события всех потоков в файл JSON Chrome trace.
+     *
+     * Можно вызывать, пока другие потоки пишут события: попадут те,
+     * что были завершены к началу выгрузки.
+     *
+     * @return false Если файл не удалось записать.
+     */
+    bool write_chrome_json(const std::string &path);
+
+    /**
+     * @brief Забывает записанные события.
+     */
+    void clear();
+
+    /**
+     * @brief Область видимости, записываемая как одно событие.
+     */
+    class Scope
+    {
+    private:
+        const char *m_name;
+        std::int64_t m_value;
+        std::uint64_t m_start; ///< 0 - запись выключена.
+
+    public:
+        explicit Scope(const char *name, std::int64_t value = -1)
+            : m_name(name), m_value(value), m_start(is_enabled() ? now_ns() : 0) {}
+
+        ~Scope()
+        {
+            if (m_start)
+                record(m_name, m_start, now_ns(), m_value);
+        }
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+    };
+
+} // namespace Utils::Trace
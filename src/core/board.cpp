@@ -1,13 +1,18 @@
 #include "core/board.h"
 #include "core/stone.h"
 #include "core/constans.h"
+#include "core/simd.h"
+#include "core/lines.h"
+#include "core/zobrist.h"
 #include "utils/render.h"
 
+#include <algorithm>
+#include <iterator>
 #include <stdexcept>
 #include <string>
 #include <vector>
 #include <optional>
-#include <ctime>
+#include <random>
 
 namespace Core
 {
@@ -18,11 +23,172 @@ namespace Core
      * Инициализирует двумерный вектор размером m_size x m_size,
      * где каждый элемент по умолчанию имеет цвет Color::None.
      */
-    Situation::Situation(int size)
+    Situation::Situation(int size) : m_rules(freestyle)
     {
+        reset(size);
+    }
+
+    /**
+     * @brief Очистка поля.
+     *
+     * assign() переиспользует уже выделенную память векторов,
+     * если новый размер не больше прежнего.
+     */
+    void Situation::reset(int size)
+    {
+        if (size < 0 || size > Constants::MAX_BOARD_SIZE)
+        {
+            throw std::invalid_argument("Board size " + std::to_string(size) + " is out of range");
+        }
         m_size = size;
         m_draw_counter = size * size;
-        m_stones = std::vector<std::vector<Stone>>(m_size, std::vector<Stone>(m_size));
+        std::fill(std::begin(m_hashes), std::end(m_hashes), 0);
+        m_stones.resize(m_size);
+        for (auto &row : m_stones)
+        {
+            row.assign(m_size, Stone());
+        }
+        if (m_size <= Simd::MAX_BITBOARD_SIZE)
+        {
+            m_rows[Color::White].assign(m_size + Simd::ROWS_PADDING, 0);
+            m_rows[Color::Black].assign(m_size + Simd::ROWS_PADDING, 0);
+        }
+        else
+        {
+            m_rows[Color::White].clear();
+            m_rows[Color::Black].clear();
+        }
+        m_runs.assign(m_size * m_size * Constants::DIRECTIONS_COUNT * 2 * 2, 0);
+        last_move.clear();
+        m_stone_list.clear();
+        m_stone_slots.assign(m_size * m_size, -1);
+
+        // Клетки за краем поля блокируют линию для обоих цветов
+        m_codes.assign(m_size * m_size * Constants::DIRECTIONS_COUNT * 2, 0);
+        for (int y = 0; y < m_size; ++y)
+        {
+            for (int x = 0; x < m_size; ++x)
+            {
+                for (int dir = 0; dir < Constants::DIRECTIONS_COUNT; ++dir)
+                {
+                    std::uint16_t code = 0;
+                    for (int i = 0; i < Lines::WINDOW; ++i)
+                    {
+                        int offset = Lines::offset_of(i);
+                        if (!is_within_bounds(x + Constants::DIRECTIONS[dir][0] * offset,
+                                              y + Constants::DIRECTIONS[dir][1] * offset))
+                        {
+                            code += Lines::blocked * Lines::weight(i);
+                        }
+                    }
+                    m_codes[code_index(x, y, dir, Color::White)] = code;
+                    m_codes[code_index(x, y, dir, Color::Black)] = code;
+                }
+            }
+        }
+
+        m_threats.assign(m_size * m_size * 2, 0);
+        m_forbidden.assign(m_size * m_size, 0);
+        m_three_slots.assign(m_size * m_size, -1);
+        m_three_cells.clear();
+        if (m_rules == renju)
+        {
+            refresh_forbidden();
+        }
+    }
+
+    /**
+     * @brief Индекс длины серии: клетка -> направление -> цвет -> сторона.
+     */
+    int Situation::run_index(int x, int y, int dir, Color color, int side) const
+    {
+        return (((y * m_size + x) * Constants::DIRECTIONS_COUNT + dir) * 2 + color) * 2 + side;
+    }
+
+    /**
+     * @brief Изменяет цвет клетки и синхронизирует битовые маски строк.
+     *
+     * @warning Не выполняет проверку границ - ответственность на вызывающей стороне.
+     */
+    void Situation::set_stone(int x, int y, Color color)
+    {
+        Color old_color = m_stones[y][x].get_color();
+        m_stones[y][x].set_color(color);
+
+        for (int s = 0; s < Symmetry::COUNT; ++s)
+        {
+            const auto [sx, sy] = Symmetry::apply(s, x, y, m_size);
+            if (old_color != Color::None)
+                m_hashes[s] ^= Zobrist::key(sx, sy, old_color);
+            if (color != Color::None)
+                m_hashes[s] ^= Zobrist::key(sx, sy, color);
+        }
+
+        // Снятый камень заменяется последним в списке
+        const int cell = y * m_size + x;
+        if (old_color == Color::None && color != Color::None)
+        {
+            m_stone_slots[cell] = static_cast<int>(m_stone_list.size());
+            m_stone_list.push_back({x, y});
+        }
+        else if (old_color != Color::None && color == Color::None)
+        {
+            const int slot = m_stone_slots[cell];
+            const std::pair<int, int> moved = m_stone_list.back();
+            m_stone_list[slot] = moved;
+            m_stone_slots[moved.second * m_size + moved.first] = slot;
+            m_stone_list.pop_back();
+            m_stone_slots[cell] = -1;
+        }
+
+        if (!m_rows[Color::White].empty())
+        {
+            const std::uint32_t bit = std::uint32_t(1) << x;
+            if (old_color != Color::None)
+                m_rows[old_color][y] &= ~bit;
+            if (color != Color::None)
+                m_rows[color][y] |= bit;
+        }
+
+        // Камень меняет только серии своего цвета: для другого цвета
+        // и пустая клетка, и чужой камень одинаково разрывают серию.
+        const bool placed = color != Color::None;
+        const Color run_color = placed ? color : old_color;
+        if (run_color == Color::None)
+            return;
+
+        for (int dir = 0; dir < Constants::DIRECTIONS_COUNT; ++dir)
+        {
+            const int dx = Constants::DIRECTIONS[dir][0];
+            const int dy = Constants::DIRECTIONS[dir][1];
+            const int before = m_runs[run_index(x, y, dir, run_color, 0)];
+            const int after = m_runs[run_index(x, y, dir, run_color, 1)];
+
+            // Клетки после (x, y): серия камней и первая клетка за ней
+            for (int k = 1; k <= after + 1; ++k)
+            {
+                int nx = x + dx * k, ny = y + dy * k;
+                if (!is_within_bounds(nx, ny))
+                    break;
+                m_runs[run_index(nx, ny, dir, run_color, 0)] = placed ? k + before : k - 1;
+            }
+
+            // Клетки перед (x, y)
+            for (int k = 1; k <= before + 1; ++k)
+            {
+                int nx = x - dx * k, ny = y - dy * k;
+                if (!is_within_bounds(nx, ny))
+                    break;
+                m_runs[run_index(nx, ny, dir, run_color, 1)] = placed ? k + after : k - 1;
+            }
+        }
+
+        apply_codes(x, y, run_color, placed ? 1 : -1);
+        update_threats(x, y);
+        if (m_rules == renju)
+        {
+            update_forbidden(x, y);
+        }
     }
 
     /**
@@ -35,7 +201,7 @@ namespace Core
      * @note После расстановки камней проверяет, не является ли позиция
      * уже завершённой (победной или ничейной).
      */
-    static std::optional<Situation> create_from_template(
+    std::optional<Situation> Situation::create_from_template(
         int size,
         std::vector<std::vector<int>> white,
         std::vector<std::vector<int>> black)
@@ -64,41 +230,80 @@ namespace Core
      */
     Situation Situation::create_with_openning(int size)
     {
-        std::srand(static_cast<unsigned int>(std::time(nullptr)));
+        std::random_device device;
+        const std::uint64_t seed = (static_cast<std::uint64_t>(device()) << 32) | device();
+        return create_with_openning(size, seed);
+    }
+
+    Situation Situation::create_with_openning(int size, std::uint64_t seed)
+    {
+        std::mt19937_64 rng(seed);
+        const int max_stones = std::max(1, size * size / 2);
+        const int stones = static_cast<int>(rng() % max_stones) + 1; // От 1 до max_stones
+        return create_random(size, stones, 0, rng());
+    }
 
+    Situation Situation::create_random(int size, int stones, int radius, std::uint64_t seed)
+    {
         Situation board(size);
-        int max_stones = size * size / 2;
-        int num_stones = rand() % max_stones + 1; // От 1 до max_stones
+        board.fill_random(size, stones, radius, seed);
+        return board;
+    }
 
-        for (int i = 0; i < num_stones; ++i)
-        {
-            int x, y;
+    /**
+     * @brief Частичное перемешивание Фишера - Йейтса: i-й камень ставится
+     * на случайную клетку из еще не просмотренных.
+     *
+     * Остаток по модулю вместо std::uniform_int_distribution нужен ради
+     * одинаковых расстановок в разных стандартных библиотеках.
+     */
+    void Situation::fill_random(int size, int stones, int radius, std::uint64_t seed)
+    {
+        reset(size);
+        std::mt19937_64 rng(seed);
 
-            do
-            {
-                x = rand() % size;
-                y = rand() % size;
-            } while (board.is_within_bounds(x,y) && !board.is_empty(x, y));
+        const int center = size / 2;
+        const int low = (radius > 0) ? std::max(0, center - radius) : 0;
+        const int high = (radius > 0) ? std::min(size - 1, center + radius) : size - 1;
 
-            Core::Color color = (i % 2 == 0) ? Core::Color::White : Core::Color::Black;
+        std::vector<std::pair<int, int>> cells;
+        cells.reserve(static_cast<std::size_t>(high - low + 1) * (high - low + 1));
+        for (int y = low; y <= high; ++y)
+        {
+            for (int x = low; x <= high; ++x)
+            {
+                cells.emplace_back(x, y);
+            }
+        }
 
-            board.move(x, y, color);
+        int placed = 0;
+        for (std::size_t i = 0; i < cells.size() && placed < stones; ++i)
+        {
+            const std::size_t j = i + static_cast<std::size_t>(rng() % (cells.size() - i));
+            std::swap(cells[i], cells[j]);
 
-            if (board.check_win(x, y) != 0)
+            const auto [x, y] = cells[i];
+            const Core::Color color = (placed % 2 == 0) ? Core::Color::White : Core::Color::Black;
+            if (!move(x, y, color))
             {
-                board.un_move();
-                i--;
+                continue;
             }
+            if (is_five(x, y))
+            {
+                un_move();
+                continue;
+            }
+            placed++;
         }
-
-        return board;
     }
 
     /**
      * @brief Настраивает начальную позицию игрового поля.
      *
      * Инициализирует доску заданным набором белых и чёрных камней.
-     * Выполняет проверку валидности позиции и соответствия правилам игры.
+     * Выполняет проверку валидности позиции и соответствия правилам игры:
+     * как и в move(), клетка должна быть на поле и пуста, поэтому
+     * повторная координата тоже делает позицию невалидной.
      *
      * @param white Вектор координат белых камней в формате {{x1, y1}, {x2, y2}, ...}
      * @param black Вектор координат чёрных камней в формате {{x1, y1}, {x2, y2}, ...}
@@ -115,9 +320,9 @@ namespace Core
                 int x = pos[0];
                 int y = pos[1];
 
-                if (x >= 0 && x < m_size && y >= 0 && y < m_size)
+                if (is_within_bounds(x, y) && m_stones[y][x].get_color() == Color::None)
                 {
-                    m_stones[y][x].set_color(Color::White);
+                    set_stone(x, y, Color::White);
                     m_draw_counter--;
                 }
                 else
@@ -134,9 +339,9 @@ namespace Core
                 int x = pos[0];
                 int y = pos[1];
 
-                if (x >= 0 && x < m_size && y >= 0 && y < m_size)
+                if (is_within_bounds(x, y) && m_stones[y][x].get_color() == Color::None)
                 {
-                    m_stones[y][x].set_color(Color::Black);
+                    set_stone(x, y, Color::Black);
                     m_draw_counter--;
                 }
                 else
@@ -161,13 +366,13 @@ namespace Core
         {
             return false;
         }
-        m_stones[y][x].set_color(color);
-        m_draw_counter -= 1;
-        last_move.push_back({x, y});
-        if (last_move.size() > Constants::MAX_SEARCH_DEPTH)
+        if (color == Color::Black && is_forbidden(x, y))
         {
-            last_move.pop_front();
+            return false;
         }
+        set_stone(x, y, color);
+        m_draw_counter -= 1;
+        last_move.push_back({x, y});
 
         return true;
     }
@@ -189,7 +394,8 @@ namespace Core
         }
         auto [x, y] = last_move.back();
         last_move.pop_back();
-        m_stones[y][x].set_color(None);
+        set_stone(x, y, None);
+        m_draw_counter += 1;
         return true;
     }
 
@@ -203,6 +409,72 @@ namespace Core
         return m_size;
     }
 
+    Rules Situation::get_rules() const
+    {
+        return m_rules;
+    }
+
+    void Situation::set_rules(Rules rules)
+    {
+        const bool changed = m_rules != rules;
+        m_rules = rules;
+        if (changed)
+        {
+            // Пятерка черных в рэндзю - ровно пять камней
+            refresh_all_threats();
+        }
+        if (changed && m_rules == renju)
+        {
+            refresh_forbidden();
+        }
+    }
+
+    const std::vector<std::pair<int, int>> &Situation::get_history() const
+    {
+        return last_move;
+    }
+
+    const std::vector<std::pair<int, int>> &Situation::get_stones() const
+    {
+        return m_stone_list;
+    }
+
+    void Situation::reserve_capacity()
+    {
+        const std::size_t cells = static_cast<std::size_t>(m_size) * m_size;
+        last_move.reserve(cells);
+        m_stone_list.reserve(cells);
+        m_three_cells.reserve(cells);
+        m_scratch.reserve(cells);
+    }
+
+    std::uint64_t Situation::get_hash() const
+    {
+        return m_hashes[Symmetry::IDENTITY];
+    }
+
+    std::uint64_t Situation::get_symmetric_hash(int symmetry) const
+    {
+        return m_hashes[symmetry];
+    }
+
+    /**
+     * @brief Представитель класса - образ с наименьшим хэшем; при равенстве
+     * берется симметрия с меньшим номером, поэтому результат однозначен.
+     */
+    Canonical Situation::get_canonical() const
+    {
+        Canonical result{m_hashes[0], 0};
+        for (int s = 1; s < Symmetry::COUNT; ++s)
+        {
+            if (m_hashes[s] < result.hash)
+            {
+                result = {m_hashes[s], s};
+            }
+        }
+        return result;
+    }
+
     /**
      * @brief Реализация получения цвета камня.
      *
@@ -229,25 +501,64 @@ namespace Core
      */
     int Situation::check_win(int x, int y)
     {
+        if (is_five(x, y))
+            return 1; // победа
+
         if (m_draw_counter <= 0)
             return 2; // ничья
 
-        const Color base_color = m_stones[y][x].get_color();
+        return 0; // игра продолжается
+    }
 
-        const int directions[4][2] = {
-            {1, 0}, // горизонталь
-            {0, 1}, // вертикаль
-            {1, 1}, // диагональ верх лево -> право низ
-            {-1, 1} // диагональ другая
-        };
+    /**
+     * @brief Длина серии через клетку: камни перед ней, сама клетка и камни после.
+     */
+    int Situation::run_length(int x, int y, int dir, Color color) const
+    {
+        return m_runs[run_index(x, y, dir, color, 0)] + 1 + m_runs[run_index(x, y, dir, color, 1)];
+    }
+
+    /**
+     * @brief Длина серии и свободные концы.
+     *
+     * Концы серии находятся сразу за последними камнями с каждой стороны,
+     * их адреса вычисляются по хранимым длинам без обхода линии.
+     */
+    RunInfo Situation::run_info(int x, int y, int dir, Color color) const
+    {
+        const int dx = Constants::DIRECTIONS[dir][0];
+        const int dy = Constants::DIRECTIONS[dir][1];
+        const int before = m_runs[run_index(x, y, dir, color, 0)];
+        const int after = m_runs[run_index(x, y, dir, color, 1)];
+
+        RunInfo info{before + 1 + after, 0};
+
+        int bx = x - dx * (before + 1), by = y - dy * (before + 1);
+        if (is_within_bounds(bx, by) && m_stones[by][bx].get_color() == Color::None)
+            info.open_ends++;
+
+        int ax = x + dx * (after + 1), ay = y + dy * (after + 1);
+        if (is_within_bounds(ax, ay) && m_stones[ay][ax].get_color() == Color::None)
+            info.open_ends++;
+
+        return info;
+    }
+
+    /**
+     * @brief Проверка пятерки через хранимые длины серий.
+     */
+    bool Situation::is_five(int x, int y) const
+    {
+        const Color color = m_stones[y][x].get_color();
+        if (color == Color::None)
+            return false;
 
-        for (const auto &dir : directions)
+        for (int dir = 0; dir < Constants::DIRECTIONS_COUNT; ++dir)
         {
-            if (has_five_in_a_row(x, y, dir[0], dir[1], base_color))
-                return 1; // победа
+            if (run_length(x, y, dir, color) >= 5)
+                return true;
         }
-
-        return 0; // игра продолжается
+        return false;
     }
 
     /**
@@ -258,9 +569,19 @@ namespace Core
      * - 0 — игра продолжается.
      *
      * @note Используется при инициализации или отладке партий.
+     * Если поле помещается в 32-битные маски, проверка выполняется
+     * через Simd::has_five, иначе - поклеточным перебором.
      */
     int Situation::check_win()
     {
+        if (!m_rows[Color::White].empty())
+        {
+            return (Simd::has_five(m_rows[Color::White].data(), m_size) ||
+                    Simd::has_five(m_rows[Color::Black].data(), m_size))
+                       ? 1
+                       : 0;
+        }
+
         const int directions[4][2] = {
             {1, 0}, {0, 1}, {1, 1}, {-1, 1}};
 
@@ -372,7 +693,7 @@ namespace Core
     {
         if (is_within_bounds(x, y))
         {
-            return m_stones[x][y];
+            return m_stones[y][x];
         }
         throw std::out_of_range("Coordinates (" + std::to_string(x) + ", " + std::to_string(y) + ") are out of bounds");
     }
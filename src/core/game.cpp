@@ -1,9 +1,46 @@
 #include "core/game.h"
-#include "player/human.h"
 #include "solver/ips.h"
+#include "solver/nnue.h"
+#include "core/constans.h"
+#include "storage/record.h"
+#include "utils/trace.h"
+
+#ifdef RENJU_EVENT_LOOP
+    #include "player/human.h"
+    #include "player/engine.h"
+    #include "utils/event_loop.h"
+#else
+    #include <iostream>
+    #include <sstream>
+#endif
+
+#include <chrono>
 
 namespace Core
 {
+    namespace
+    {
+        /**
+         * @brief Веса из файла weights_path и нейросеть (если загружена) для движка.
+         */
+        void setup_engine(AI::Ips &ips, const std::string &weights_path, AI::Nnue::Network *network)
+        {
+            if (!weights_path.empty())
+            {
+                AI::Patterns weights = ips.get_weights();
+                if (AI::load_weights(weights_path, weights))
+                {
+                    ips.set_weights(weights);
+                }
+            }
+            if (network)
+            {
+                ips.set_network(network);
+                ips.set_evaluation(AI::EvalKind::Nnue);
+            }
+        }
+    } // namespace
+
     /**
      * @brief Конструктор новой игры.
      *
@@ -13,7 +50,9 @@ namespace Core
      * @param type Тип игры (например, с ботом или между игроками).
      */
     Game::Game(Core::Situation board, Type type)
-        : m_size(board.get_size()), m_type(type), m_situation(board), m_turn(1), m_is_valid_move(true) {}
+        : m_size(board.get_size()), m_type(type), m_situation(board), m_turn(1), m_is_valid_move(true),
+          m_setup_moves(static_cast<int>(board.get_history().size())), m_result(ongoing),
+          m_headless(false) {}
 
     /**
      * @brief Конструктор игры с уже установленным состоянием поля.
@@ -28,7 +67,9 @@ namespace Core
      */
     Game::Game(Core::Situation board, Type type, int turn)
         : m_size(board.get_size()), m_type(type), m_situation(board),
-          m_turn(turn)
+          m_turn(turn), m_is_valid_move(true),
+          m_setup_moves(static_cast<int>(board.get_history().size())), m_result(ongoing),
+          m_headless(false)
     {
     }
 
@@ -45,8 +86,19 @@ namespace Core
     MoveResult Game::move(int x, int y)
     {
         // Нормализация координаты
-        x--;
-        y--;
+        return play(x - 1, y - 1);
+    }
+
+    /**
+     * @brief Ход в координатах от 0.
+     */
+    MoveResult Game::play(int x, int y)
+    {
+        RENJU_TRACE_SCOPE("Game::move");
+        if (m_result != ongoing)
+        {
+            return MoveResult::invalid();
+        }
 
         if (m_turn > 0)
         {
@@ -68,52 +120,208 @@ namespace Core
         if (cw == 1)
         {
             Color winner = (m_turn > 0) ? Color::Black : Color::White;
-            Utils::Render::win(m_situation, (winner == Color::White) ? white_wins : black_wins);
+            m_result = (winner == Color::White) ? white_wins : black_wins;
+            if (!m_headless)
+            {
+                Utils::Render::win(m_situation, m_result);
+            }
             return MoveResult::win(winner);
         }
         else if (cw == 2)
         {
-            Utils::Render::win(m_situation, draw);
+            m_result = draw;
+            if (!m_headless)
+            {
+                Utils::Render::win(m_situation, draw);
+            }
             return MoveResult::draw();
         }
 
         return MoveResult::ongoing();
     }
 
-    void Game::render()
+    void Game::set_headless(bool headless)
     {
-        Utils::Render::very_simple_draw(m_situation);
+        m_headless = headless;
+    }
+
+    Color Game::get_to_move() const
+    {
+        return (m_turn > 0) ? Color::White : Color::Black;
+    }
+
+    Situation &Game::get_situation()
+    {
+        return m_situation;
+    }
+
+    Status Game::get_result() const
+    {
+        return m_result;
+    }
+
+    bool Game::is_over() const
+    {
+        return m_result != ongoing;
+    }
+
+    void Game::render(bool force)
+    {
+        Utils::Render::very_simple_draw(m_situation, force);
     }
     /**
      * @brief Main-loop
      *  Основной игровой цикл, работает с ips и игроком
+     *
+     * Цикл событий есть только на POSIX (RENJU_EVENT_LOOP); на других
+     * платформах ввод человека читается блокирующе, а движок ищет в том
+     * же потоке.
      */
     void Game::run()
     {
+        AI::Nnue::Network network;
+        const bool use_network = !m_network_path.empty() && network.load(m_network_path);
+
+        // Ограничение частоты не прячет позицию от человека: кадр перед
+        // его ходом рисуется всегда
+        if (m_type == eve)
+        {
+            Utils::Render::set_frame_interval(
+                std::chrono::milliseconds(Constants::EVE_FRAME_INTERVAL_MS));
+        }
+
+#ifdef RENJU_EVENT_LOOP
+        // Один поток поиска: партия одна, память поиска сохраняется между ходами
+        Utils::EventLoop loop;
+        Player::EnginePool engines(1);
+        engines.configure([&](AI::Ips &ips)
+                          { setup_engine(ips, m_weights_path, use_network ? &network : nullptr); });
+
+        Player::Human human(White, loop);
+        Player::Engine engine(Black, loop, engines);
+
+        loop.spawn(run_async(human, engine));
+        loop.run();
+#else
         AI::Ips ips(Black);
-        Player::Human human(White);
-        std::pair<int, int> move_pos;
+        setup_engine(ips, m_weights_path, use_network ? &network : nullptr);
 
-        while (true)
+        std::string line;
+        while (!is_over())
         {
-            render();
+            if (!m_headless)
+            {
+                render(m_turn > 0);
+            }
 
             if (m_turn > 0)
             {
-                move_pos = human.get_move();
+                if (!std::getline(std::cin, line))
+                {
+                    break;
+                }
+
+                // Человек вводит координаты от 1; нераспознанные строки пропускаются
+                int x, y;
+                std::istringstream input(line);
+                if ((input >> x >> y) && !move(x, y).valid)
+                {
+                    std::cout << "Недопустимый ход: " << x << ' ' << y << std::endl;
+                }
             }
             else
             {
-                move_pos = ips.get_move(m_situation);
+                const std::pair<int, int> move_pos = ips.get_move(m_situation);
+                if (!play(move_pos.first, move_pos.second).valid)
+                {
+                    break;
+                }
+            }
+        }
+#endif
+
+        // Прерванная партия (ввод закончился) не записывается
+        if (!is_over())
+        {
+            return;
+        }
+
+        if (!m_record_path.empty())
+        {
+            save(m_record_path);
+        }
+
+        if (!m_training_path.empty())
+        {
+            AI::Nnue::TrainingExporter exporter(m_training_path);
+            exporter.write_game(m_situation, m_setup_moves, m_result);
+        }
+    }
+
+    Utils::Async<Status> Game::run_async(Player::Player &white, Player::Player &black)
+    {
+        while (!is_over())
+        {
+            Player::Player &player = (m_turn > 0) ? white : black;
+            if (!m_headless)
+            {
+                // Человек должен видеть позицию, на которую отвечает
+                render(player.interactive());
             }
 
-            MoveResult result = move(move_pos.first, move_pos.second);
+            const std::pair<int, int> move = co_await player.get_move(m_situation);
+            if (move.first < 0)
+            {
+                break;
+            }
 
-            if (result.status == game_end)
+            // Как и GameHost, партию с недопустимым ходом программы не продолжаем
+            if (!play(move.first, move.second).valid && !player.on_invalid_move(move))
             {
                 break;
             }
         }
+        co_return m_result;
+    }
+
+    void Game::set_record_file(const std::string &path)
+    {
+        m_record_path = path;
+    }
+
+    void Game::set_weights_file(const std::string &path)
+    {
+        m_weights_path = path;
+    }
+
+    void Game::set_network_file(const std::string &path)
+    {
+        m_network_path = path;
+    }
+
+    void Game::set_training_file(const std::string &path)
+    {
+        m_training_path = path;
+    }
+
+    /**
+     * @brief Сохранение партии в файл записей.
+     *
+     * Камни, стоявшие на поле при создании игры, записываются как начальная
+     * расстановка, остальные - как ходы партии. В текущем цикле run()
+     * белыми играет человек, черными - ИИ.
+     */
+    bool Game::save(const std::string &path)
+    {
+        Storage::GameRecord record;
+        if (!record.assign(m_situation, m_setup_moves,
+                           Storage::PlayerKind::Human, Storage::PlayerKind::Engine, m_result))
+        {
+            return false;
+        }
+
+        Storage::RecordWriter writer(path);
+        return writer.append(record);
     }
 
 } // namespace Core
@@ -0,0 +1,177 @@
+#include "core/lines.h"
+
+#include <vector>
+
+namespace Core::Lines
+{
+    namespace
+    {
+        constexpr int CENTER = REACH;
+        constexpr int CELLS = WINDOW + 1;
+
+        /**
+         * @brief Границы серии своих камней через клетку i.
+         */
+        void run_bounds(const int *cells, int i, int &lo, int &hi)
+        {
+            lo = i;
+            hi = i;
+            while (lo > 0 && cells[lo - 1] == own)
+                lo--;
+            while (hi < CELLS - 1 && cells[hi + 1] == own)
+                hi++;
+        }
+
+        bool makes_five(const int *cells, int i, bool exact)
+        {
+            int lo, hi;
+            run_bounds(cells, i, lo, hi);
+            int len = hi - lo + 1;
+            return exact ? len == 5 : len >= 5;
+        }
+
+        /**
+         * @brief Четверки, которые образует камень в центре.
+         *
+         * Четверка - набор из четырех камней, который одним ходом
+         * превращается в пятерку, содержащую центр. Точки завершения,
+         * дополняющие один и тот же набор камней, относятся к одной
+         * четверке (открытая четверка .XXXX. - одна четверка с двумя
+         * точками завершения).
+         *
+         * @param straight Устанавливается, если среди четверок есть открытая.
+         * @return int Число различных четверок (не больше 2).
+         */
+        int count_fours(int *cells, bool exact, bool &straight)
+        {
+            int masks[CELLS];
+            int points[CELLS];
+            int distinct = 0;
+            straight = false;
+
+            for (int q = 0; q < CELLS; ++q)
+            {
+                if (q == CENTER || cells[q] != empty)
+                    continue;
+
+                cells[q] = own;
+                int lo, hi;
+                run_bounds(cells, q, lo, hi);
+                if (lo <= CENTER && CENTER <= hi && makes_five(cells, q, exact))
+                {
+                    int mask = 0;
+                    for (int i = lo; i <= hi; ++i)
+                    {
+                        if (i != q)
+                            mask |= 1 << i;
+                    }
+
+                    int found = -1;
+                    for (int k = 0; k < distinct; ++k)
+                    {
+                        if (masks[k] == mask)
+                            found = k;
+                    }
+                    if (found < 0)
+                    {
+                        masks[distinct] = mask;
+                        points[distinct] = 1;
+                        distinct++;
+                    }
+                    else if (++points[found] >= 2)
+                    {
+                        straight = true;
+                    }
+                }
+                cells[q] = empty;
+            }
+            return distinct > 2 ? 2 : distinct;
+        }
+
+        /**
+         * @brief Построение элемента таблицы для раскладки cells (центр - свой камень).
+         */
+        LineInfo build(int *cells, bool exact)
+        {
+            LineInfo info{0};
+
+            int lo, hi;
+            run_bounds(cells, CENTER, lo, hi);
+            const int len = hi - lo + 1;
+
+            if (exact ? len == 5 : len >= 5)
+            {
+                info.bits |= 1;
+                return info;
+            }
+            if (len >= 6)
+            {
+                info.bits |= 2;
+                return info;
+            }
+
+            bool straight;
+            int fours = count_fours(cells, exact, straight);
+            info.bits |= static_cast<std::uint16_t>(fours << 2);
+            if (straight)
+                info.bits |= 16;
+            if (fours > 0)
+                return info;
+
+            // Тройки: ходы, после которых в линии появляется открытая четверка
+            int three_mask = 0;
+            bool closed = false;
+            for (int q = 0; q < CELLS; ++q)
+            {
+                if (q == CENTER || cells[q] != empty)
+                    continue;
+
+                cells[q] = own;
+                bool next_straight;
+                if (count_fours(cells, exact, next_straight) > 0)
+                {
+                    if (next_straight)
+                        three_mask |= 1 << index_of(q - CENTER);
+                    else
+                        closed = true;
+                }
+                cells[q] = empty;
+            }
+
+            info.bits |= static_cast<std::uint16_t>(three_mask << 5);
+            if (closed)
+                info.bits |= 0x8000;
+            return info;
+        }
+
+        std::vector<LineInfo> build_table(bool exact)
+        {
+            std::vector<LineInfo> table(CODE_COUNT);
+            int cells[CELLS];
+
+            for (int code = 0; code < CODE_COUNT; ++code)
+            {
+                int rest = code;
+                for (int i = 0; i < WINDOW; ++i)
+                {
+                    cells[offset_of(i) + CENTER] = rest % 3;
+                    rest /= 3;
+                }
+                cells[CENTER] = own;
+                table[code] = build(cells, exact);
+            }
+            return table;
+        }
+    } // namespace
+
+    /**
+     * @brief Таблицы строятся один раз при первом обращении.
+     */
+    const LineInfo &lookup(std::uint16_t code, bool exact)
+    {
+        static const std::vector<LineInfo> exact_table = build_table(true);
+        static const std::vector<LineInfo> free_table = build_table(false);
+        return exact ? exact_table[code] : free_table[code];
+    }
+
+} // namespace Core::Lines
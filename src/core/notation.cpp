@@ -0,0 +1,229 @@
+#include "core/notation.h"
+#include "core/constans.h"
+
+#include <charconv>
+#include <fstream>
+
+namespace Core::Notation
+{
+    namespace
+    {
+        char stone_char(Color color)
+        {
+            return color == Color::White ? 'x' : 'o';
+        }
+
+        bool parse_color(char c, Color &color)
+        {
+            switch (c)
+            {
+            case 'x':
+            case 'X':
+                color = Color::White;
+                return true;
+            case 'o':
+            case 'O':
+                color = Color::Black;
+                return true;
+            default:
+                return false;
+            }
+        }
+
+        bool is_space(char c)
+        {
+            return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+        }
+    } // namespace
+
+    /**
+     * @brief Разбор строки позиции в два прохода.
+     *
+     * Первый проход определяет размер поля по числу строк, второй
+     * расставляет камни. Камни ставятся через Situation::move по
+     * свободным правилам (в рэндзю часть черных камней могла бы попасть
+     * на запрещенные клетки), правила из строки применяются после
+     * расстановки. Все производные структуры ситуации обновляются.
+     */
+    bool parse(std::string_view text, Situation &situation, Color &to_move)
+    {
+        const std::size_t board_end = text.find(' ');
+        if (board_end == std::string_view::npos)
+        {
+            return false;
+        }
+
+        int size = 1;
+        for (std::size_t i = 0; i < board_end; ++i)
+        {
+            if (text[i] == '/' && ++size > Constants::MAX_BOARD_SIZE)
+                return false;
+        }
+
+        situation.reset(size);
+        situation.set_rules(freestyle);
+
+        int x = 0, y = 0;
+        for (std::size_t i = 0; i < board_end; ++i)
+        {
+            const char c = text[i];
+            Color color;
+
+            if (c == '/')
+            {
+                if (x != size)
+                    return false;
+                x = 0;
+                y++;
+            }
+            else if (c >= '0' && c <= '9')
+            {
+                // Число больше оставшейся части строки поля - ошибка,
+                // поэтому накопление не переполняется
+                int empty = 0;
+                while (i < board_end && text[i] >= '0' && text[i] <= '9')
+                {
+                    empty = empty * 10 + (text[i] - '0');
+                    if (x + empty > size)
+                        return false;
+                    i++;
+                }
+                i--;
+                x += empty;
+            }
+            else if (parse_color(c, color))
+            {
+                if (!situation.move(x, y, color))
+                    return false;
+                x++;
+            }
+            else
+            {
+                return false;
+            }
+        }
+        if (x != size)
+        {
+            return false;
+        }
+
+        // Суффикс: "<ход> <правила>"
+        std::size_t pos = board_end + 1;
+        if (pos >= text.size() || !parse_color(text[pos], to_move))
+        {
+            return false;
+        }
+        pos++;
+
+        Rules rules = freestyle;
+        if (pos + 1 < text.size() && text[pos] == ' ' && !is_space(text[pos + 1]))
+        {
+            switch (text[pos + 1])
+            {
+            case 'f':
+                rules = freestyle;
+                break;
+            case 'r':
+                rules = renju;
+                break;
+            default:
+                return false;
+            }
+            pos += 2;
+        }
+
+        // После суффикса допустимы только пробельные символы
+        while (pos < text.size() && is_space(text[pos]))
+        {
+            pos++;
+        }
+        if (pos != text.size())
+        {
+            return false;
+        }
+
+        situation.set_rules(rules);
+        return true;
+    }
+
+    /**
+     * @brief Запись позиции: пустые клетки сворачиваются в числа.
+     */
+    std::size_t write(Situation &situation, Color to_move, char *buffer, std::size_t capacity)
+    {
+        const int size = situation.get_size();
+        if (capacity < max_length(size))
+        {
+            return 0;
+        }
+
+        std::size_t len = 0;
+        auto flush_empty = [&](int &empty)
+        {
+            if (empty > 0)
+            {
+                len = std::to_chars(buffer + len, buffer + capacity, empty).ptr - buffer;
+            }
+            empty = 0;
+        };
+
+        for (int y = 0; y < size; ++y)
+        {
+            if (y > 0)
+                buffer[len++] = '/';
+
+            int empty = 0;
+            for (int x = 0; x < size; ++x)
+            {
+                Color color = situation.get_stone_color(x, y);
+                if (color == Color::None)
+                {
+                    empty++;
+                    continue;
+                }
+                flush_empty(empty);
+                buffer[len++] = stone_char(color);
+            }
+            flush_empty(empty);
+        }
+
+        buffer[len++] = ' ';
+        buffer[len++] = stone_char(to_move);
+        buffer[len++] = ' ';
+        buffer[len++] = situation.get_rules() == renju ? 'r' : 'f';
+        return len;
+    }
+
+    std::string to_string(Situation &situation, Color to_move)
+    {
+        std::string result(max_length(situation.get_size()), '\0');
+        result.resize(write(situation, to_move, result.data(), result.size()));
+        return result;
+    }
+
+    std::size_t load(const std::string &path,
+                     const std::function<void(Situation &, Color)> &visit)
+    {
+        std::ifstream file(path);
+        std::string line;
+        Situation situation(0);
+        Color to_move;
+        std::size_t accepted = 0;
+
+        while (std::getline(file, line))
+        {
+            if (line.empty() || line[0] == '#')
+            {
+                continue;
+            }
+            if (!parse(line, situation, to_move) || situation.check_win())
+            {
+                continue;
+            }
+            visit(situation, to_move);
+            accepted++;
+        }
+        return accepted;
+    }
+
+} // namespace Core::Notation
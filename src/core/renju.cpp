@@ -0,0 +1,214 @@
+#include "core/board.h"
+#include "core/constans.h"
+#include "core/lines.h"
+
+namespace Core
+{
+    namespace
+    {
+        /**
+         * @brief Предел глубины проверки ложных троек.
+         *
+         * На большей глубине тройка считается настоящей. В реальных
+         * позициях цепочки зависимостей длиннее двух-трех ходов не встречаются.
+         */
+        constexpr int MAX_FORBIDDEN_DEPTH = 4;
+    } // namespace
+
+    /**
+     * @brief Индекс кода: клетка -> направление -> цвет.
+     */
+    int Situation::code_index(int x, int y, int dir, Color color) const
+    {
+        return ((y * m_size + x) * Constants::DIRECTIONS_COUNT + dir) * 2 + color;
+    }
+
+    /**
+     * @brief Обновление кодов соседей на четырех линиях.
+     *
+     * Для цвета камня клетка становится "своей" (1), для соперника -
+     * "заблокированной" (2). Меняется по одной цифре троичного кода
+     * у каждой из не более чем 4 * 2 * Lines::REACH клеток.
+     */
+    void Situation::apply_codes(int x, int y, Color color, int sign)
+    {
+        const Color other = (color == Color::White) ? Color::Black : Color::White;
+
+        for (int dir = 0; dir < Constants::DIRECTIONS_COUNT; ++dir)
+        {
+            const int dx = Constants::DIRECTIONS[dir][0];
+            const int dy = Constants::DIRECTIONS[dir][1];
+
+            for (int i = 0; i < Lines::WINDOW; ++i)
+            {
+                const int offset = Lines::offset_of(i);
+                const int nx = x + dx * offset;
+                const int ny = y + dy * offset;
+                if (!is_within_bounds(nx, ny))
+                    continue;
+
+                // Для соседа (nx, ny) наша клетка находится на смещении -offset
+                const std::uint16_t w = Lines::weight(Lines::index_of(-offset));
+                m_codes[code_index(nx, ny, dir, color)] += sign * Lines::own * w;
+                m_codes[code_index(nx, ny, dir, other)] += sign * Lines::blocked * w;
+            }
+        }
+    }
+
+    std::uint16_t Situation::line_code(int x, int y, int dir, Color color) const
+    {
+        return m_codes[code_index(x, y, dir, color)];
+    }
+
+    bool Situation::is_forbidden(int x, int y) const
+    {
+        return m_rules == renju && m_forbidden[y * m_size + x];
+    }
+
+    /**
+     * @brief Рекурсивная проверка запрещенного хода черных.
+     *
+     * Используются только коды линий, поэтому временный камень ставится
+     * через apply_codes без изменения остальных структур ситуации.
+     */
+    bool Situation::compute_forbidden(int x, int y, int depth)
+    {
+        int fours = 0;
+        int three_dirs[Constants::DIRECTIONS_COUNT];
+        int three_masks[Constants::DIRECTIONS_COUNT];
+        int threes = 0;
+        bool overline = false;
+
+        for (int dir = 0; dir < Constants::DIRECTIONS_COUNT; ++dir)
+        {
+            const Lines::LineInfo &info = Lines::lookup(line_code(x, y, dir, Color::Black), true);
+            if (info.five())
+            {
+                return false; // пятерка выигрывает даже вместе с запрещенной фигурой
+            }
+            overline |= info.overline();
+            fours += info.fours();
+            if (info.three_mask())
+            {
+                three_dirs[threes] = dir;
+                three_masks[threes] = info.three_mask();
+                threes++;
+            }
+        }
+
+        if (overline || fours >= 2)
+        {
+            return true;
+        }
+        if (threes < 2)
+        {
+            return false;
+        }
+        if (depth >= MAX_FORBIDDEN_DEPTH)
+        {
+            return true;
+        }
+
+        apply_codes(x, y, Color::Black, 1);
+
+        int real_threes = 0;
+        for (int t = 0; t < threes; ++t)
+        {
+            const int dx = Constants::DIRECTIONS[three_dirs[t]][0];
+            const int dy = Constants::DIRECTIONS[three_dirs[t]][1];
+
+            for (int i = 0; i < Lines::WINDOW; ++i)
+            {
+                if (!(three_masks[t] & (1 << i)))
+                    continue;
+
+                const int offset = Lines::offset_of(i);
+                if (!compute_forbidden(x + dx * offset, y + dy * offset, depth + 1))
+                {
+                    real_threes++;
+                    break;
+                }
+            }
+        }
+
+        apply_codes(x, y, Color::Black, -1);
+        return real_threes >= 2;
+    }
+
+    void Situation::refresh_cell(int x, int y)
+    {
+        const int cell = y * m_size + x;
+        int threes = 0;
+
+        if (m_stones[y][x].get_color() == Color::None)
+        {
+            for (int dir = 0; dir < Constants::DIRECTIONS_COUNT; ++dir)
+            {
+                if (Lines::lookup(line_code(x, y, dir, Color::Black), true).three_mask())
+                    threes++;
+            }
+            m_forbidden[cell] = compute_forbidden(x, y, 0);
+        }
+        else
+        {
+            m_forbidden[cell] = 0;
+        }
+
+        // Поддержка множества клеток с двумя и более тройками
+        const bool listed = m_three_slots[cell] >= 0;
+        if (threes >= 2 && !listed)
+        {
+            m_three_slots[cell] = static_cast<int>(m_three_cells.size());
+            m_three_cells.push_back(cell);
+        }
+        else if (threes < 2 && listed)
+        {
+            const int slot = m_three_slots[cell];
+            const int last = m_three_cells.back();
+            m_three_cells[slot] = last;
+            m_three_slots[last] = slot;
+            m_three_cells.pop_back();
+            m_three_slots[cell] = -1;
+        }
+    }
+
+    void Situation::update_forbidden(int x, int y)
+    {
+        refresh_cell(x, y);
+
+        for (int dir = 0; dir < Constants::DIRECTIONS_COUNT; ++dir)
+        {
+            const int dx = Constants::DIRECTIONS[dir][0];
+            const int dy = Constants::DIRECTIONS[dir][1];
+
+            for (int offset = -Lines::REACH; offset <= Lines::REACH; ++offset)
+            {
+                const int nx = x + dx * offset;
+                const int ny = y + dy * offset;
+                if (offset != 0 && is_within_bounds(nx, ny))
+                {
+                    refresh_cell(nx, ny);
+                }
+            }
+        }
+
+        // refresh_cell может изменить m_three_cells, поэтому обходим копию
+        m_scratch.assign(m_three_cells.begin(), m_three_cells.end());
+        for (int cell : m_scratch)
+        {
+            refresh_cell(cell % m_size, cell / m_size);
+        }
+    }
+
+    void Situation::refresh_forbidden()
+    {
+        for (int y = 0; y < m_size; ++y)
+        {
+            for (int x = 0; x < m_size; ++x)
+            {
+                refresh_cell(x, y);
+            }
+        }
+    }
+
+} // namespace Core
@@ -0,0 +1,355 @@
+#include "core/simd.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+    #define RENJU_SSE2 1
+    #include <immintrin.h>
+#endif
+
+#if defined(RENJU_SSE2) && (defined(__GNUC__) || defined(__clang__))
+    #define RENJU_AVX2_DISPATCH 1
+#endif
+
+namespace Core::Simd
+{
+    /**
+     * @brief Скалярная проверка: для каждой строки y объединяет сдвинутые
+     * маски соседних строк.
+     *
+     * Бит x результата установлен, если от клетки (x, y) начинается пятерка
+     * в соответствующем направлении. Строки за пределами поля нулевые,
+     * поэтому отдельная проверка границ не нужна.
+     */
+    bool has_five_scalar(const std::uint32_t *rows, int size)
+    {
+        for (int y = 0; y < size; ++y)
+        {
+            const std::uint32_t r0 = rows[y];
+            if (!r0)
+                continue;
+
+            const std::uint32_t r1 = rows[y + 1], r2 = rows[y + 2],
+                                r3 = rows[y + 3], r4 = rows[y + 4];
+
+            std::uint32_t hits = r0 & (r0 >> 1) & (r0 >> 2) & (r0 >> 3) & (r0 >> 4);
+            hits |= r0 & r1 & r2 & r3 & r4;
+            hits |= r0 & (r1 >> 1) & (r2 >> 2) & (r3 >> 3) & (r4 >> 4);
+            hits |= r0 & (r1 << 1) & (r2 << 2) & (r3 << 3) & (r4 << 4);
+
+            if (hits)
+                return true;
+        }
+        return false;
+    }
+
+#ifdef RENJU_SSE2
+    /**
+     * @brief SSE2-версия: обрабатывает четыре строки за итерацию.
+     */
+    static bool has_five_sse2(const std::uint32_t *rows, int size)
+    {
+        for (int y = 0; y < size; y += 4)
+        {
+            const __m128i r0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rows + y));
+            const __m128i r1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rows + y + 1));
+            const __m128i r2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rows + y + 2));
+            const __m128i r3 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rows + y + 3));
+            const __m128i r4 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rows + y + 4));
+
+            __m128i horizontal = _mm_and_si128(
+                _mm_and_si128(r0, _mm_srli_epi32(r0, 1)),
+                _mm_and_si128(_mm_and_si128(_mm_srli_epi32(r0, 2), _mm_srli_epi32(r0, 3)),
+                              _mm_srli_epi32(r0, 4)));
+
+            __m128i vertical = _mm_and_si128(
+                _mm_and_si128(r0, r1),
+                _mm_and_si128(_mm_and_si128(r2, r3), r4));
+
+            __m128i diagonal = _mm_and_si128(
+                _mm_and_si128(r0, _mm_srli_epi32(r1, 1)),
+                _mm_and_si128(_mm_and_si128(_mm_srli_epi32(r2, 2), _mm_srli_epi32(r3, 3)),
+                              _mm_srli_epi32(r4, 4)));
+
+            __m128i anti_diagonal = _mm_and_si128(
+                _mm_and_si128(r0, _mm_slli_epi32(r1, 1)),
+                _mm_and_si128(_mm_and_si128(_mm_slli_epi32(r2, 2), _mm_slli_epi32(r3, 3)),
+                              _mm_slli_epi32(r4, 4)));
+
+            __m128i hits = _mm_or_si128(_mm_or_si128(horizontal, vertical),
+                                        _mm_or_si128(diagonal, anti_diagonal));
+
+            if (_mm_movemask_epi8(_mm_cmpeq_epi32(hits, _mm_setzero_si128())) != 0xFFFF)
+                return true;
+        }
+        return false;
+    }
+#endif
+
+#ifdef RENJU_AVX2_DISPATCH
+    /**
+     * @brief AVX2-версия: обрабатывает восемь строк за итерацию.
+     *
+     * @note Компилируется с атрибутом target("avx2") и вызывается только
+     * после проверки поддержки инструкций процессором.
+     */
+    __attribute__((target("avx2"))) static bool has_five_avx2(const std::uint32_t *rows, int size)
+    {
+        for (int y = 0; y < size; y += 8)
+        {
+            const __m256i r0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(rows + y));
+            const __m256i r1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(rows + y + 1));
+            const __m256i r2 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(rows + y + 2));
+            const __m256i r3 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(rows + y + 3));
+            const __m256i r4 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(rows + y + 4));
+
+            __m256i horizontal = _mm256_and_si256(
+                _mm256_and_si256(r0, _mm256_srli_epi32(r0, 1)),
+                _mm256_and_si256(_mm256_and_si256(_mm256_srli_epi32(r0, 2), _mm256_srli_epi32(r0, 3)),
+                                 _mm256_srli_epi32(r0, 4)));
+
+            __m256i vertical = _mm256_and_si256(
+                _mm256_and_si256(r0, r1),
+                _mm256_and_si256(_mm256_and_si256(r2, r3), r4));
+
+            __m256i diagonal = _mm256_and_si256(
+                _mm256_and_si256(r0, _mm256_srli_epi32(r1, 1)),
+                _mm256_and_si256(_mm256_and_si256(_mm256_srli_epi32(r2, 2), _mm256_srli_epi32(r3, 3)),
+                                 _mm256_srli_epi32(r4, 4)));
+
+            __m256i anti_diagonal = _mm256_and_si256(
+                _mm256_and_si256(r0, _mm256_slli_epi32(r1, 1)),
+                _mm256_and_si256(_mm256_and_si256(_mm256_slli_epi32(r2, 2), _mm256_slli_epi32(r3, 3)),
+                                 _mm256_slli_epi32(r4, 4)));
+
+            __m256i hits = _mm256_or_si256(_mm256_or_si256(horizontal, vertical),
+                                           _mm256_or_si256(diagonal, anti_diagonal));
+
+            if (!_mm256_testz_si256(hits, hits))
+                return true;
+        }
+        return false;
+    }
+#endif
+
+    /**
+     * @brief Определение набора инструкций.
+     *
+     * AVX2 проверяется через __builtin_cpu_supports, SSE2 входит в базовый
+     * набор x86-64. На остальных платформах используется скалярная версия.
+     */
+    Level detect_level()
+    {
+        static const Level level = []
+        {
+#if defined(RENJU_AVX2_DISPATCH)
+            if (__builtin_cpu_supports("avx2"))
+                return Level::Avx2;
+#endif
+#if defined(RENJU_SSE2)
+            return Level::Sse2;
+#else
+            return Level::Scalar;
+#endif
+        }();
+        return level;
+    }
+
+    /**
+     * @brief Диспетчер: вызывает самую быструю доступную реализацию.
+     */
+    bool has_five(const std::uint32_t *rows, int size)
+    {
+        switch (detect_level())
+        {
+#ifdef RENJU_AVX2_DISPATCH
+        case Level::Avx2:
+            return has_five_avx2(rows, size);
+#endif
+#ifdef RENJU_SSE2
+        case Level::Sse2:
+            return has_five_sse2(rows, size);
+#endif
+        default:
+            return has_five_scalar(rows, size);
+        }
+    }
+
+
+    /**
+     * @brief Векторные операции для нейросетевой оценки.
+     *
+     * Длины векторов кратны 16, поэтому хвосты не обрабатываются.
+     */
+    static void add_i16_scalar(std::int16_t *dst, const std::int16_t *src, const std::int16_t *add, int n)
+    {
+        for (int i = 0; i < n; ++i)
+            dst[i] = static_cast<std::int16_t>(src[i] + add[i]);
+    }
+
+    static void sub_i16_scalar(std::int16_t *dst, const std::int16_t *src, const std::int16_t *sub, int n)
+    {
+        for (int i = 0; i < n; ++i)
+            dst[i] = static_cast<std::int16_t>(src[i] - sub[i]);
+    }
+
+    static std::int32_t dot_crelu_scalar(const std::int16_t *x, const std::int8_t *w, int n)
+    {
+        std::int32_t sum = 0;
+        for (int i = 0; i < n; ++i)
+        {
+            const int v = x[i] < 0 ? 0 : (x[i] > 127 ? 127 : x[i]);
+            sum += v * w[i];
+        }
+        return sum;
+    }
+
+#ifdef RENJU_SSE2
+    static void add_i16_sse2(std::int16_t *dst, const std::int16_t *src, const std::int16_t *add, int n)
+    {
+        for (int i = 0; i < n; i += 8)
+        {
+            const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+            const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(add + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_add_epi16(a, b));
+        }
+    }
+
+    static void sub_i16_sse2(std::int16_t *dst, const std::int16_t *src, const std::int16_t *sub, int n)
+    {
+        for (int i = 0; i < n; i += 8)
+        {
+            const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+            const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(sub + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_sub_epi16(a, b));
+        }
+    }
+
+    /**
+     * @brief SSE2: int8-веса расширяются до int16, _mm_madd_epi16 дает
+     * попарные суммы в int32.
+     */
+    static std::int32_t dot_crelu_sse2(const std::int16_t *x, const std::int8_t *w, int n)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i limit = _mm_set1_epi16(127);
+        __m128i sum = _mm_setzero_si128();
+
+        for (int i = 0; i < n; i += 16)
+        {
+            const __m128i x0 = _mm_min_epi16(_mm_max_epi16(
+                                                 _mm_loadu_si128(reinterpret_cast<const __m128i *>(x + i)), zero),
+                                             limit);
+            const __m128i x1 = _mm_min_epi16(_mm_max_epi16(
+                                                 _mm_loadu_si128(reinterpret_cast<const __m128i *>(x + i + 8)), zero),
+                                             limit);
+
+            const __m128i wb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(w + i));
+            const __m128i w0 = _mm_srai_epi16(_mm_unpacklo_epi8(wb, wb), 8);
+            const __m128i w1 = _mm_srai_epi16(_mm_unpackhi_epi8(wb, wb), 8);
+
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(x0, w0));
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(x1, w1));
+        }
+
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm_cvtsi128_si32(sum);
+    }
+#endif
+
+#ifdef RENJU_AVX2_DISPATCH
+    __attribute__((target("avx2"))) static void add_i16_avx2(std::int16_t *dst, const std::int16_t *src,
+                                                             const std::int16_t *add, int n)
+    {
+        for (int i = 0; i < n; i += 16)
+        {
+            const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+            const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(add + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_add_epi16(a, b));
+        }
+    }
+
+    __attribute__((target("avx2"))) static void sub_i16_avx2(std::int16_t *dst, const std::int16_t *src,
+                                                             const std::int16_t *sub, int n)
+    {
+        for (int i = 0; i < n; i += 16)
+        {
+            const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+            const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(sub + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_sub_epi16(a, b));
+        }
+    }
+
+    __attribute__((target("avx2"))) static std::int32_t dot_crelu_avx2(const std::int16_t *x, const std::int8_t *w, int n)
+    {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i limit = _mm256_set1_epi16(127);
+        __m256i sum = _mm256_setzero_si256();
+
+        for (int i = 0; i < n; i += 16)
+        {
+            const __m256i xv = _mm256_min_epi16(_mm256_max_epi16(
+                                                    _mm256_loadu_si256(reinterpret_cast<const __m256i *>(x + i)), zero),
+                                                limit);
+            const __m256i wv = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(w + i)));
+            sum = _mm256_add_epi32(sum, _mm256_madd_epi16(xv, wv));
+        }
+
+        __m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+        half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+        half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm_cvtsi128_si32(half);
+    }
+#endif
+
+    void add_i16(std::int16_t *dst, const std::int16_t *src, const std::int16_t *add, int n)
+    {
+        switch (detect_level())
+        {
+#ifdef RENJU_AVX2_DISPATCH
+        case Level::Avx2:
+            return add_i16_avx2(dst, src, add, n);
+#endif
+#ifdef RENJU_SSE2
+        case Level::Sse2:
+            return add_i16_sse2(dst, src, add, n);
+#endif
+        default:
+            return add_i16_scalar(dst, src, add, n);
+        }
+    }
+
+    void sub_i16(std::int16_t *dst, const std::int16_t *src, const std::int16_t *sub, int n)
+    {
+        switch (detect_level())
+        {
+#ifdef RENJU_AVX2_DISPATCH
+        case Level::Avx2:
+            return sub_i16_avx2(dst, src, sub, n);
+#endif
+#ifdef RENJU_SSE2
+        case Level::Sse2:
+            return sub_i16_sse2(dst, src, sub, n);
+#endif
+        default:
+            return sub_i16_scalar(dst, src, sub, n);
+        }
+    }
+
+    std::int32_t dot_crelu_i16_i8(const std::int16_t *x, const std::int8_t *w, int n)
+    {
+        switch (detect_level())
+        {
+#ifdef RENJU_AVX2_DISPATCH
+        case Level::Avx2:
+            return dot_crelu_avx2(x, w, n);
+#endif
+#ifdef RENJU_SSE2
+        case Level::Sse2:
+            return dot_crelu_sse2(x, w, n);
+#endif
+        default:
+            return dot_crelu_scalar(x, w, n);
+        }
+    }
+
+} // namespace Core::Simd
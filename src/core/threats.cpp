@@ -0,0 +1,106 @@
+#include "core/board.h"
+#include "core/constans.h"
+#include "core/lines.h"
+#include "core/threats.h"
+
+namespace Core
+{
+    std::uint8_t Situation::threats(int x, int y, Color color) const
+    {
+        return m_threats[(y * m_size + x) * 2 + color];
+    }
+
+    /**
+     * @brief Маска угроз клетки по кодам ее четырех линий.
+     */
+    std::uint8_t Situation::compute_threats(int x, int y, Color color) const
+    {
+        const bool exact = m_rules == renju && color == Color::Black;
+        int fours = 0;
+        int three_lines = 0;
+        int four_lines = 0;
+        std::uint8_t mask = 0;
+
+        for (int dir = 0; dir < Constants::DIRECTIONS_COUNT; ++dir)
+        {
+            const Lines::LineInfo &info = Lines::lookup(line_code(x, y, dir, color), exact);
+            if (info.five())
+                mask |= Threats::five;
+            if (info.straight_four())
+                mask |= Threats::straight_four;
+            if (info.fours() > 0)
+            {
+                fours += info.fours();
+                four_lines++;
+            }
+            else if (info.three_mask())
+            {
+                three_lines++;
+            }
+            if (info.closed_three())
+                mask |= Threats::closed_three;
+        }
+
+        if (fours > 0)
+            mask |= Threats::four;
+        if (fours >= 2)
+            mask |= Threats::double_four;
+        if (three_lines > 0)
+            mask |= Threats::open_three;
+        if (three_lines >= 2)
+            mask |= Threats::double_three;
+        if (four_lines > 0 && three_lines > 0)
+            mask |= Threats::four_three;
+        return mask;
+    }
+
+    void Situation::refresh_threats(int x, int y)
+    {
+        const int cell = (y * m_size + x) * 2;
+        if (m_stones[y][x].get_color() != Color::None)
+        {
+            m_threats[cell + Color::White] = 0;
+            m_threats[cell + Color::Black] = 0;
+            return;
+        }
+        m_threats[cell + Color::White] = compute_threats(x, y, Color::White);
+        m_threats[cell + Color::Black] = compute_threats(x, y, Color::Black);
+    }
+
+    /**
+     * @brief Коды линий меняются только у клеток в пределах Lines::REACH
+     * на четырех линиях через (x, y): пересчитываются только они.
+     */
+    void Situation::update_threats(int x, int y)
+    {
+        refresh_threats(x, y);
+
+        for (int dir = 0; dir < Constants::DIRECTIONS_COUNT; ++dir)
+        {
+            const int dx = Constants::DIRECTIONS[dir][0];
+            const int dy = Constants::DIRECTIONS[dir][1];
+
+            for (int offset = -Lines::REACH; offset <= Lines::REACH; ++offset)
+            {
+                const int nx = x + dx * offset;
+                const int ny = y + dy * offset;
+                if (offset != 0 && is_within_bounds(nx, ny))
+                {
+                    refresh_threats(nx, ny);
+                }
+            }
+        }
+    }
+
+    void Situation::refresh_all_threats()
+    {
+        for (int y = 0; y < m_size; ++y)
+        {
+            for (int x = 0; x < m_size; ++x)
+            {
+                refresh_threats(x, y);
+            }
+        }
+    }
+
+} // namespace Core
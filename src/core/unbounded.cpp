@@ -0,0 +1,168 @@
+#include "core/unbounded.h"
+#include "core/constans.h"
+
+#include <algorithm>
+
+namespace Core
+{
+    UnboundedSituation::UnboundedSituation()
+        : m_window(2 * MARGIN + 1), m_origin_x(-MARGIN), m_origin_y(-MARGIN) {}
+
+    bool UnboundedSituation::fits(int x, int y)
+    {
+        const int size = m_window.get_size();
+        const int lx = x - m_origin_x;
+        const int ly = y - m_origin_y;
+        return lx >= MARGIN && ly >= MARGIN && lx < size - MARGIN && ly < size - MARGIN;
+    }
+
+    bool UnboundedSituation::in_range(int x, int y)
+    {
+        return x >= -MAX_COORDINATE && x <= MAX_COORDINATE && y >= -MAX_COORDINATE && y <= MAX_COORDINATE;
+    }
+
+    /**
+     * @brief Рост окна.
+     *
+     * Новое окно квадратное, охватывающий прямоугольник камней стоит в
+     * его середине. Камни переставляются в порядке истории по свободным
+     * правилам, а запреты рэндзю пересчитываются один раз после перестановки.
+     */
+    bool UnboundedSituation::grow(int x, int y)
+    {
+        int min_x = x, max_x = x, min_y = y, max_y = y;
+        for (const auto &[sx, sy] : m_history)
+        {
+            min_x = std::min(min_x, sx);
+            max_x = std::max(max_x, sx);
+            min_y = std::min(min_y, sy);
+            max_y = std::max(max_y, sy);
+        }
+
+        // Координаты не больше MAX_COORDINATE по модулю: разности помещаются в int
+        const int width = max_x - min_x + 1;
+        const int height = max_y - min_y + 1;
+        const int needed = std::max(width, height) + 2 * MARGIN;
+        if (needed > Constants::MAX_BOARD_SIZE)
+        {
+            return false;
+        }
+        const int size = std::min(std::max(needed, m_window.get_size() * 3 / 2), Constants::MAX_BOARD_SIZE);
+
+        std::vector<Color> colors;
+        colors.reserve(m_history.size());
+        for (const auto &[sx, sy] : m_history)
+        {
+            colors.push_back(get_stone_color(sx, sy));
+        }
+
+        m_origin_x = min_x - (size - width) / 2;
+        m_origin_y = min_y - (size - height) / 2;
+
+        const Rules rules = m_window.get_rules();
+        m_window.set_rules(freestyle);
+        m_window.reset(size);
+        for (std::size_t i = 0; i < m_history.size(); ++i)
+        {
+            const auto [lx, ly] = to_window(m_history[i].first, m_history[i].second);
+            m_window.move(lx, ly, colors[i]);
+        }
+        m_window.set_rules(rules);
+        return true;
+    }
+
+    bool UnboundedSituation::move(int x, int y, Color color)
+    {
+        if (!in_range(x, y) || (!fits(x, y) && !grow(x, y)))
+        {
+            return false;
+        }
+
+        const auto [lx, ly] = to_window(x, y);
+        if (!m_window.move(lx, ly, color))
+        {
+            return false;
+        }
+        m_history.push_back({x, y});
+        return true;
+    }
+
+    bool UnboundedSituation::un_move()
+    {
+        if (!m_window.un_move())
+        {
+            return false;
+        }
+        m_history.pop_back();
+        return true;
+    }
+
+    Color UnboundedSituation::get_stone_color(int x, int y)
+    {
+        if (!in_range(x, y))
+        {
+            return Color::None;
+        }
+        const auto [lx, ly] = to_window(x, y);
+        return m_window.is_within_bounds(lx, ly) ? m_window.get_stone_color(lx, ly) : Color::None;
+    }
+
+    bool UnboundedSituation::is_empty(int x, int y)
+    {
+        return get_stone_color(x, y) == Color::None;
+    }
+
+    bool UnboundedSituation::is_five(int x, int y) const
+    {
+        if (!in_range(x, y))
+        {
+            return false;
+        }
+        const auto [lx, ly] = to_window(x, y);
+        return m_window.is_within_bounds(lx, ly) && m_window.is_five(lx, ly);
+    }
+
+    /**
+     * @brief Клетки за окном дальше MARGIN от камней и запрещенными быть не могут.
+     */
+    bool UnboundedSituation::is_forbidden(int x, int y) const
+    {
+        if (!in_range(x, y))
+        {
+            return false;
+        }
+        const auto [lx, ly] = to_window(x, y);
+        return m_window.is_within_bounds(lx, ly) && m_window.is_forbidden(lx, ly);
+    }
+
+    Rules UnboundedSituation::get_rules() const
+    {
+        return m_window.get_rules();
+    }
+
+    void UnboundedSituation::set_rules(Rules rules)
+    {
+        m_window.set_rules(rules);
+    }
+
+    const std::vector<std::pair<int, int>> &UnboundedSituation::get_history() const
+    {
+        return m_history;
+    }
+
+    Situation &UnboundedSituation::window()
+    {
+        return m_window;
+    }
+
+    std::pair<int, int> UnboundedSituation::to_window(int x, int y) const
+    {
+        return {x - m_origin_x, y - m_origin_y};
+    }
+
+    std::pair<int, int> UnboundedSituation::from_window(std::pair<int, int> cell) const
+    {
+        return {cell.first + m_origin_x, cell.second + m_origin_y};
+    }
+
+} // namespace Core
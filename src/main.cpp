@@ -11,15 +11,123 @@
 #include "utils/render.h"
 #include "core/constans.h"
 #include "core/board.h"
+#include "core/notation.h"
+#include "tools/tuner.h"
+#include "tools/bench.h"
+#include "tools/host.h"
+#include "tools/openings.h"
+#include "tools/annotate.h"
+#include "utils/trace.h"
+
+#ifdef RENJU_SERVER
+    #include "tools/server.h"
+#endif
 
 #include <iostream>
+#include <string>
 
 
-int main()
+int main(int argc, char **argv)
 {
-    
-    Core::Game game(Core::Situation::create_with_openning(Core::Constants::FIELD_SIZE), Core::Type::pve);
+    if (argc > 1 && std::string(argv[1]) == "tune")
+    {
+        return Tools::tune_main(argc - 1, argv + 1);
+    }
+    if (argc > 1 && std::string(argv[1]) == "bench")
+    {
+        return Tools::bench_main(argc - 1, argv + 1);
+    }
+    if (argc > 1 && std::string(argv[1]) == "serve")
+    {
+#ifdef RENJU_SERVER
+        return Tools::server_main(argc - 1, argv + 1);
+#else
+        std::cerr << "Команда serve не поддерживается на этой платформе" << std::endl;
+        return 1;
+#endif
+    }
+    if (argc > 1 && std::string(argv[1]) == "host")
+    {
+        return Tools::host_main(argc - 1, argv + 1);
+    }
+    if (argc > 1 && std::string(argv[1]) == "openings")
+    {
+        return Tools::openings_main(argc - 1, argv + 1);
+    }
+    if (argc > 1 && std::string(argv[1]) == "annotate")
+    {
+        return Tools::annotate_main(argc - 1, argv + 1);
+    }
+
+    std::string record_path;
+    std::string weights_path;
+    std::string position;
+    std::string network_path;
+    std::string training_path;
+    std::string trace_path;
+
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--record")
+        {
+            record_path = argv[++i];
+        }
+        else if (arg == "--position")
+        {
+            position = argv[++i];
+        }
+        else if (arg == "--weights")
+        {
+            weights_path = argv[++i];
+        }
+        else if (arg == "--net")
+        {
+            network_path = argv[++i];
+        }
+        else if (arg == "--training-data")
+        {
+            training_path = argv[++i];
+        }
+        else if (arg == "--trace")
+        {
+            trace_path = argv[++i];
+        }
+    }
+
+    Core::Situation board = Core::Situation::create_with_openning(Core::Constants::FIELD_SIZE);
+    int turn = 1;
+
+    if (!position.empty())
+    {
+        Core::Color to_move;
+        if (!Core::Notation::parse(position, board, to_move) || board.check_win())
+        {
+            std::cerr << "Некорректная позиция: " << position << std::endl;
+            return 1;
+        }
+        turn = (to_move == Core::Color::White) ? 1 : -1;
+    }
+
+    Core::Game game(board, Core::Type::pve, turn);
+    game.set_record_file(record_path);
+    game.set_weights_file(weights_path);
+    game.set_network_file(network_path);
+    game.set_training_file(training_path);
+
+    if (!trace_path.empty())
+    {
+        if (!Utils::Trace::compiled_in())
+            std::cerr << "Метки трассировки не собраны (опция CMake RENJU_TRACE)" << std::endl;
+        Utils::Trace::set_enabled(true);
+    }
+
     game.run();
+
+    if (!trace_path.empty() && !Utils::Trace::write_chrome_json(trace_path))
+    {
+        std::cerr << "Не удалось записать трассировку в " << trace_path << std::endl;
+    }
 /*
     Core::Status f = Core::ongoing;
 
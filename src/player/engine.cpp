@@ -0,0 +1,52 @@
+#include "player/engine.h"
+#include "utils/trace.h"
+
+namespace Player
+{
+    EnginePool::EnginePool(int threads, std::size_t hash_mb)
+        : m_table(hash_mb), m_next_id(1), m_pool(threads)
+    {
+        for (int i = 0; i < m_pool.size(); ++i)
+        {
+            auto engines = std::make_unique<Engines>();
+            engines->white.set_shared_table(&m_table);
+            engines->black.set_shared_table(&m_table);
+            m_engines.push_back(std::move(engines));
+        }
+    }
+
+    void EnginePool::configure(const std::function<void(AI::Ips &)> &setup)
+    {
+        for (auto &engines : m_engines)
+        {
+            setup(engines->white);
+            setup(engines->black);
+        }
+    }
+
+    std::pair<int, int> EnginePool::search(std::uint64_t owner, Core::Situation &situation, Core::Color color)
+    {
+        RENJU_TRACE_SCOPE("Engine::get_move");
+        Engines &engines = *m_engines[m_pool.current_index()];
+        const int side = (color == Core::Color::White) ? 0 : 1;
+        AI::Ips &engine = side == 0 ? engines.white : engines.black;
+
+        // Основная линия и история другой партии только мешают
+        if (engines.owner[side] != owner)
+        {
+            engine.clear_memory();
+            engines.owner[side] = owner;
+        }
+        return engine.get_move(situation);
+    }
+
+    Engine::Engine(Core::Color color, Utils::EventLoop &loop, EnginePool &pool)
+        : Player(color), m_loop(loop), m_pool(pool), m_id(pool.m_next_id.fetch_add(1)) {}
+
+    Utils::Async<std::pair<int, int>> Engine::get_move(Core::Situation &situation)
+    {
+        co_return co_await m_loop.offload(m_pool.m_pool, [this, &situation]
+                                          { return m_pool.search(m_id, situation, m_color); });
+    }
+
+} // namespace Player
@@ -1,24 +1,39 @@
 #include "core/board.h"
 #include "player/human.h"
 
-#include <utility>
 #include <iostream>
+#include <utility>
+#include <sstream>
 
 namespace Player
 {
 
-    Human::Human(Core::Color color) : m_color(color) {}
+    Human::Human(Core::Color color, Utils::EventLoop &loop, int fd) : Player(color), m_input(loop, fd) {}
 
-    std::pair<int, int> Human::get_move()
+    Utils::Async<std::pair<int, int>> Human::get_move(Core::Situation &)
     {
-        int x, y;
-        std::cin >> x >> y;
-        return std::make_pair(x, y);
+        while (true)
+        {
+            const std::optional<std::string> line = co_await m_input.read_line();
+            if (!line)
+            {
+                co_return std::make_pair(-1, -1);
+            }
+
+            int x, y;
+            std::istringstream input(*line);
+            if (input >> x >> y)
+            {
+                // Человек вводит координаты от 1
+                co_return std::make_pair(x - 1, y - 1);
+            }
+        }
     }
 
-    Core::Color Human::get_color()
+    bool Human::on_invalid_move(std::pair<int, int> move)
     {
-        return m_color;
+        std::cout << "Недопустимый ход: " << move.first + 1 << ' ' << move.second + 1 << std::endl;
+        return true;
     }
 
 }; // namespace Player
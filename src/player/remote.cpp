@@ -0,0 +1,40 @@
+#include "player/remote.h"
+#include "core/notation.h"
+
+#include <sstream>
+#include <string>
+
+#include <fcntl.h>
+
+namespace Player
+{
+    Remote::Remote(Core::Color color, Utils::EventLoop &loop, int input_fd, int output_fd)
+        : Player(color), m_loop(loop), m_input(loop, input_fd), m_output(output_fd)
+    {
+        ::fcntl(m_output, F_SETFL, ::fcntl(m_output, F_GETFL) | O_NONBLOCK);
+    }
+
+    Utils::Async<std::pair<int, int>> Remote::get_move(Core::Situation &situation)
+    {
+        const std::string request = "position " + Core::Notation::to_string(situation, m_color) + "\n";
+        if (!co_await Utils::write_all(m_loop, m_output, request))
+        {
+            co_return std::make_pair(-1, -1);
+        }
+
+        std::optional<std::string> line;
+        do
+        {
+            line = co_await m_input.read_line();
+        } while (line && line->find_first_not_of(" \t\r") == std::string::npos);
+
+        int x, y;
+        std::istringstream reply(line ? *line : std::string());
+        if (!(reply >> x >> y))
+        {
+            co_return std::make_pair(-1, -1);
+        }
+        co_return std::make_pair(x, y);
+    }
+
+} // namespace Player
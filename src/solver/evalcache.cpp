@@ -0,0 +1,54 @@
+#include "solver/evalcache.h"
+
+#include <algorithm>
+
+namespace AI
+{
+    EvalCache::EvalCache(std::size_t entries)
+        : m_mask(0)
+    {
+        resize(entries);
+    }
+
+    void EvalCache::resize(std::size_t entries)
+    {
+        std::size_t count = 0;
+        if (entries > 0)
+        {
+            count = 1;
+            while (count * 2 <= entries)
+                count *= 2;
+        }
+
+        // Пустой вектор освобождает память, а не только обнуляет размер
+        std::vector<Entry>(count).swap(m_entries);
+        m_mask = count > 0 ? count - 1 : 0;
+        m_stats = EvalCacheStats();
+    }
+
+    bool EvalCache::empty() const
+    {
+        return m_entries.empty();
+    }
+
+    std::size_t EvalCache::size() const
+    {
+        return m_entries.size();
+    }
+
+    void EvalCache::clear()
+    {
+        std::fill(m_entries.begin(), m_entries.end(), Entry());
+    }
+
+    const EvalCacheStats &EvalCache::stats() const
+    {
+        return m_stats;
+    }
+
+    void EvalCache::reset_stats()
+    {
+        m_stats = EvalCacheStats();
+    }
+
+} // namespace AI
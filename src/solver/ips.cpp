@@ -1,12 +1,20 @@
 #include "solver/ips.h"
 #include "core/board.h"
 #include "core/constans.h"
+#include "core/zobrist.h"
+#include "core/symmetry.h"
+#include "core/lines.h"
+#include "core/threats.h"
+#include "utils/trace.h"
 
 #include <utility>
 #include <stdexcept>
 #include <random>
 #include <set>
 #include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
 
 namespace AI
 {
@@ -15,45 +23,181 @@ namespace AI
     {
         return color == Core::Color::Black ? Core::Color::White : Core::Color::Black;
     }
+    Patterns default_weights()
+    {
+        using Core::Constants::Heights;
+        return {(int)Heights::TwoInRow, (int)Heights::ThreeInRow, (int)Heights::FourInRow,
+                (int)Heights::FiveInRow, (int)Heights::OpenEnd, (int)Heights::DoubleThreat};
+    }
+
     /**
      * @brief Подсчет итогового веса паттерна.
      * @param pattern Структура с подсчитанными паттернами.
+     * @param weights Веса паттернов.
      * @return Суммарный вес позиции.
      */
-    int count_impact(Patterns pattern)
+    int count_impact(const Patterns &pattern, const Patterns &weights)
     {
-        return pattern.TwoInRow * (int)Core::Constants::Heights::TwoInRow +
-               pattern.ThreeInRow * (int)Core::Constants::Heights::ThreeInRow +
-               pattern.FourInRow * (int)Core::Constants::Heights::FourInRow +
-               pattern.FiveInRow * (int)Core::Constants::Heights::FiveInRow +
-               pattern.OpenEnd * (int)Core::Constants::Heights::OpenEnd +
-               pattern.DoubleThreat * (int)Core::Constants::Heights::DoubleThreat;
+        return pattern.TwoInRow * weights.TwoInRow +
+               pattern.ThreeInRow * weights.ThreeInRow +
+               pattern.FourInRow * weights.FourInRow +
+               pattern.FiveInRow * weights.FiveInRow +
+               pattern.OpenEnd * weights.OpenEnd +
+               pattern.DoubleThreat * weights.DoubleThreat;
     }
 
-    /**
-     * @brief Извлекает все камни с доски в виде вектора координат.
-     *
-     * Проходит по всем клеткам доски и добавляет координаты занятых клеток в вектор.
-     *
-     * @param situation Текущая игровая ситуация.
-     * @return std::vector<std::pair<int, int>> Вектор координат всех камней.
-     */
-    std::vector<std::pair<int, int>> Ips::extract_stones(Core::Situation &situation)
+    namespace
     {
-        std::vector<std::pair<int, int>> stones;
+        struct WeightField
+        {
+            const char *name;
+            int Patterns::*field;
+        };
 
-        for (int i = 0; i < Core::Constants::FIELD_SIZE; ++i)
+        constexpr WeightField WEIGHT_FIELDS[] = {
+            {"TwoInRow", &Patterns::TwoInRow},
+            {"ThreeInRow", &Patterns::ThreeInRow},
+            {"FourInRow", &Patterns::FourInRow},
+            {"FiveInRow", &Patterns::FiveInRow},
+            {"OpenEnd", &Patterns::OpenEnd},
+            {"DoubleThreat", &Patterns::DoubleThreat}};
+
+        // Параметры выборочного поиска alphabeta_recursive
+        constexpr int LMR_DEPTH = 3;             ///< Минимальная глубина для сокращений.
+        constexpr int LMR_MOVES = 3;             ///< Сколько первых ходов не сокращается.
+        constexpr int FUTILITY_DEPTH = 2;        ///< Глубина, на которой работают razoring и futility.
+        constexpr int FUTILITY_MARGIN = 4;       ///< Запас в весах ThreeInRow на единицу глубины.
+        constexpr int FUTILITY_GAIN = 4;         ///< Множитель оценки appraiser как возможного прироста.
+        constexpr int RAZOR_FACTOR = 4;          ///< Razoring требует запаса в RAZOR_FACTOR раз больше.
+        constexpr int MULTI_CUT_DEPTH = 4;       ///< Минимальная глубина для multi-cut.
+        constexpr int MULTI_CUT_MOVES = 6;       ///< Сколько ходов проверяется.
+        constexpr int MULTI_CUT_REQUIRED = 3;    ///< Сколько из них должны дать отсечение.
+        constexpr int MULTI_CUT_REDUCTION = 2;   ///< Сокращение глубины проверки.
+        constexpr std::uint64_t TIME_CHECK_MASK = 255; ///< Время проверяется раз в 256 узлов.
+        constexpr int ASPIRATION_WINDOW = 50;    ///< Полуширина окна линий multi-PV.
+        constexpr int ASPIRATION_LIMIT = 5000;   ///< Шире окно не растет: дальше поиск без границы.
+        constexpr int PATTERN_REACH = 4;         ///< Полуширина окна row_assessment.
+
+        /**
+         * @brief Перевод оценки выигрыша в расстояние от узла ply для таблицы:
+         * одна и та же позиция может встретиться на разной глубине.
+         */
+        int score_to_tt(int score, int ply)
         {
-            for (int j = 0; j < Core::Constants::FIELD_SIZE; ++j)
+            return shift_mate(score, -ply);
+        }
+
+        int score_from_tt(int score, int ply)
+        {
+            return shift_mate(score, ply);
+        }
+
+        /**
+         * @brief Биты угроз цвета color в клетке без двойных угроз, которые
+         * черные не могут создать: в рэндзю ход в запрещенную клетку невозможен.
+         */
+        std::uint8_t playable_threats(Core::Situation &situation, int x, int y, Core::Color color)
+        {
+            const std::uint8_t threats = situation.threats(x, y, color);
+            if (color == Core::Color::Black && (threats & Core::Threats::DOUBLE) && situation.is_forbidden(x, y))
+            {
+                return threats & ~Core::Threats::DOUBLE;
+            }
+            return threats;
+        }
+
+        /**
+         * @brief Двойная угроза цвета color в клетке (+1), соперника (-1) или 0.
+         */
+        int double_threat_balance(Core::Situation &situation, int x, int y, Core::Color color)
+        {
+            const Core::Color other = color == Core::Color::Black ? Core::Color::White : Core::Color::Black;
+            return ((playable_threats(situation, x, y, color) & Core::Threats::DOUBLE) != 0) -
+                   ((playable_threats(situation, x, y, other) & Core::Threats::DOUBLE) != 0);
+        }
+
+        /**
+         * @brief Обход пустых клеток, у которых row_assessment может найти паттерн.
+         *
+         * Паттерн в клетке возможен, только если на одной из четырех ее
+         * линий в пределах PATTERN_REACH есть камень. Остальные клетки
+         * дают одинаковый (нулевой) вклад обоим цветам, поэтому обход
+         * камней вместо всего поля не меняет оценку, а время зависит от
+         * числа камней, а не от площади. Каждая клетка посещается один раз.
+         */
+        template <typename Visit>
+        void for_each_pattern_cell(Core::Situation &situation, SearchArena &arena, Visit visit)
+        {
+            const int size = situation.get_size();
+            arena.begin_marks();
+            for (const auto &stone : situation.get_stones())
             {
-                if (!situation.is_empty(i, j))
+                for (const auto &dir : Core::Constants::DIRECTIONS)
                 {
-                    stones.emplace_back(i, j);
+                    for (int offset = -PATTERN_REACH; offset <= PATTERN_REACH; ++offset)
+                    {
+                        const int x = stone.first + dir[0] * offset;
+                        const int y = stone.second + dir[1] * offset;
+                        if (situation.is_empty(x, y) && arena.mark(y * size + x))
+                        {
+                            visit(x, y);
+                        }
+                    }
                 }
             }
         }
+    } // namespace
+
+    bool load_weights(const std::string &path, Patterns &weights)
+    {
+        std::ifstream file(path);
+        if (!file)
+        {
+            return false;
+        }
+
+        std::string name;
+        int value;
+        while (file >> name >> value)
+        {
+            auto it = std::find_if(std::begin(WEIGHT_FIELDS), std::end(WEIGHT_FIELDS),
+                                   [&](const WeightField &f)
+                                   { return name == f.name; });
+            if (it == std::end(WEIGHT_FIELDS))
+            {
+                return false;
+            }
+            weights.*(it->field) = value;
+        }
+        return file.eof();
+    }
 
-        return stones;
+    bool save_weights(const std::string &path, const Patterns &weights)
+    {
+        std::ofstream file(path);
+        for (const auto &f : WEIGHT_FIELDS)
+        {
+            file << f.name << ' ' << weights.*(f.field) << '\n';
+        }
+        return static_cast<bool>(file);
+    }
+
+    /**
+     * @brief Извлекает все камни с доски в список координат.
+     *
+     * Камни берутся из списка Situation::get_stones, без обхода клеток.
+     *
+     * @param situation Текущая игровая ситуация.
+     * @param stones Список, в который записываются координаты всех камней.
+     */
+    void Ips::extract_stones(Core::Situation &situation, MoveList &stones)
+    {
+        stones.clear();
+
+        for (const auto &stone : situation.get_stones())
+        {
+            stones.push_back(stone);
+        }
     }
 
     /**
@@ -67,12 +211,13 @@ namespace AI
     std::vector<std::pair<int, int>> Ips::generate_moves_base(Core::Situation &situation)
     {
         std::vector<std::pair<int, int>> moves;
+        const int size = situation.get_size();
 
-        for (int i = 0; i < Core::Constants::FIELD_SIZE; i++)
+        for (int i = 0; i < size; i++)
         {
-            for (int j = 0; j < Core::Constants::FIELD_SIZE; j++)
+            for (int j = 0; j < size; j++)
             {
-                if (situation.is_within_bounds(i, j) && situation.is_empty(i, j))
+                if (situation.is_empty(i, j))
                 {
                     moves.push_back(std::pair<int, int>(i, j));
                 }
@@ -87,22 +232,33 @@ namespace AI
      *
      * Если на доске нет камней, возвращает ход в центр доски.
      * Иначе генерирует ходы в радиусе 2 клеток от каждого существующего камня.
+     * Повторы отсекаются метками арены, после чего отмеченные клетки
+     * выписываются обходом охватывающего прямоугольника в порядке (x, y).
      *
      * @param situation Текущая игровая ситуация.
-     * @return std::vector<std::pair<int, int>> Вектор координат "умных" ходов.
+     * @param color Цвет ходящего игрока.
+     * @param arena Рабочая память (камни и метки клеток).
+     * @param moves Список, в который записываются ходы.
+     *
+     * @note По правилам рэндзю запрещенные для черных клетки не генерируются.
      */
-    std::vector<std::pair<int, int>> Ips::generate_moves_smart(Core::Situation &situation)
+    void Ips::generate_moves_smart(Core::Situation &situation, Core::Color color,
+                                   SearchArena &arena, MoveList &moves)
     {
-        std::vector<std::pair<int, int>> moves;
+        RENJU_TRACE_SCOPE("Ips::generate_moves");
+        moves.clear();
 
-        const auto &stones = extract_stones(situation);
+        MoveList stones = arena.stones();
+        extract_stones(situation, stones);
+        const int size = situation.get_size();
         if (stones.empty())
         {
-            return {{(int)(Core::Constants::FIELD_SIZE / 2),
-                     (int)(Core::Constants::FIELD_SIZE / 2)}};
+            moves.push_back({size / 2, size / 2});
+            return;
         }
 
-        std::set<std::pair<int, int>> unique_moves;
+        int min_x = size, min_y = size, max_x = -1, max_y = -1;
+        arena.begin_marks();
 
         for (const auto &stone : stones)
         {
@@ -113,43 +269,188 @@ namespace AI
                     int x = stone.first + dx;
                     int y = stone.second + dy;
 
-                    if (situation.is_within_bounds(x, y) && situation.is_empty(x, y))
+                    if (situation.is_within_bounds(x, y) && situation.is_empty(x, y) &&
+                        !(color == Core::Color::Black && situation.is_forbidden(x, y)) &&
+                        arena.mark(y * size + x))
                     {
-                        unique_moves.emplace(x, y);
+                        min_x = std::min(min_x, x);
+                        max_x = std::max(max_x, x);
+                        min_y = std::min(min_y, y);
+                        max_y = std::max(max_y, y);
                     }
                 }
             }
         }
 
-        moves.assign(unique_moves.begin(), unique_moves.end());
-        return moves;
+        for (int x = min_x; x <= max_x; ++x)
+        {
+            for (int y = min_y; y <= max_y; ++y)
+            {
+                if (arena.is_marked(y * size + x))
+                {
+                    moves.push_back({x, y});
+                }
+            }
+        }
+
+        restrict_forced(situation, color, moves);
+    }
+
+    /**
+     * @brief Все клетки угроз лежат не дальше двух клеток от камней, поэтому
+     * достаточно просмотреть уже созданные ходы.
+     *
+     * Против открытой тройки остаются клетки, где соперник получил бы
+     * четверку (это и концы тройки, и дальние блоки вида O.XXX..), и
+     * собственные четверки как встречные угрозы. Тройка черных, которую
+     * по правилам рэндзю нельзя превратить в открытую четверку, не угроза.
+     * Если ни один вынужденный ход не разрешен правилами, список не
+     * меняется: позиция проиграна, и поиск оценит ее обычным образом.
+     */
+    void Ips::restrict_forced(Core::Situation &situation, Core::Color color, MoveList &moves)
+    {
+        using namespace Core::Threats;
+        const Core::Color other = next_color(color);
+        bool block_five = false;
+        bool open_three = false;
+
+        for (const auto &move : moves)
+        {
+            const std::uint8_t own = situation.threats(move.first, move.second, color);
+            const std::uint8_t theirs = situation.threats(move.first, move.second, other);
+            if (own & five)
+            {
+                moves.clear();
+                moves.push_back(move);
+                return;
+            }
+            block_five |= (theirs & five) != 0;
+            open_three |= (theirs & straight_four) != 0 &&
+                          !(other == Core::Color::Black && situation.is_forbidden(move.first, move.second));
+        }
+
+        if (!block_five && !open_three)
+        {
+            return;
+        }
+
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < moves.size(); ++i)
+        {
+            const std::uint8_t own = situation.threats(moves[i].first, moves[i].second, color);
+            const std::uint8_t theirs = situation.threats(moves[i].first, moves[i].second, other);
+            const bool forced = block_five ? (theirs & five) != 0
+                                           : (theirs & four) != 0 || (own & four) != 0;
+            if (forced)
+            {
+                moves[kept++] = moves[i];
+            }
+        }
+        if (kept > 0)
+        {
+            moves.truncate(kept);
+        }
+    }
+
+    /**
+     * @brief Выбор оценки перед поиском.
+     *
+     * Нейросетевая оценка включается, только если сеть подходит к размеру
+     * поля; корневой аккумулятор пересчитывается с нуля. Здесь же
+     * выделяется вся рабочая память поиска: дальше узлы ее только
+     * переиспользуют.
+     */
+    void Ips::prepare_search(Core::Situation &situation)
+    {
+        const int size = situation.get_size();
+        const int plies = std::max(m_max_depth, Core::Constants::MAX_SEARCH_DEPTH) + 2;
+        m_arena.reserve(plies, size * size);
+        situation.reserve_capacity();
+        if (m_eval_cache.empty() && m_eval_cache_entries > 0)
+        {
+            m_eval_cache.resize(m_eval_cache_entries);
+        }
+
+        m_nnue_active = (m_eval == EvalKind::Nnue) && m_nnue.ready(situation);
+        if (m_nnue_active)
+        {
+            m_nnue.reserve(plies);
+            m_nnue.refresh(situation);
+        }
+    }
+
+    /**
+     * @brief Хэш позиции не зависит от размера поля и правил, а оценка
+     * зависит еще и от цвета и оценочной функции: они добавляются солью.
+     */
+    std::uint64_t Ips::eval_key(Core::Situation &situation, Core::Color color) const
+    {
+        const std::uint64_t salt = (static_cast<std::uint64_t>(situation.get_size()) << 8) ^
+                                   (static_cast<std::uint64_t>(situation.get_rules()) << 4) ^
+                                   (static_cast<std::uint64_t>(color) << 1) ^
+                                   (m_nnue_active ? 1u : 0u);
+        return situation.get_hash() ^ Core::Zobrist::mix(salt);
+    }
+
+    /**
+     * @brief Ход в ходе поиска: ситуация и аккумулятор сети меняются вместе.
+     */
+    void Ips::make_move(Core::Situation &situation, std::pair<int, int> move, Core::Color color)
+    {
+        situation.move(move.first, move.second, color);
+        if (m_nnue_active)
+        {
+            m_nnue.push(move.first, move.second, color);
+        }
+        m_nodes++;
+    }
+
+    void Ips::undo_move(Core::Situation &situation)
+    {
+        situation.un_move();
+        if (m_nnue_active)
+        {
+            m_nnue.pop();
+        }
     }
 
     /**
      * @brief Оценка текущей ситуации для минимакса
      *
+     * Сумма оценок appraiser по клеткам вблизи камней и вес DoubleThreat
+     * за каждую клетку с двойной угрозой по карте угроз (своей - со знаком
+     * плюс, соперника - со знаком минус). Оценки уже встречавшихся
+     * позиций берутся из кэша оценок.
+     *
      * @param situation Текущая игровая ситуация
      * @param color Цвет игрока, для которого оцениваем
      * @return int Оценка позиции
      */
     int Ips::evaluate_position(Core::Situation &situation, Core::Color color)
     {
+        RENJU_TRACE_SCOPE("Ips::evaluate");
+        const std::uint64_t key = eval_key(situation, color);
         int total_score = 0;
-
-        for (int i = 0; i < Core::Constants::FIELD_SIZE; i++)
+        if (m_eval_cache.probe(key, total_score))
         {
-            for (int j = 0; j < Core::Constants::FIELD_SIZE; j++)
-            {
-                if (situation.is_empty(i, j))
-                {
-
-                    total_score += appraiser(situation, {i, j}, color);
+            return total_score;
+        }
 
-                    total_score -= appraiser(situation, {i, j}, next_color(color));
-                }
-            }
+        if (m_nnue_active)
+        {
+            total_score = m_nnue.evaluate(color);
+        }
+        else
+        {
+            for_each_pattern_cell(situation, m_arena, [&](int x, int y)
+                                  {
+                                      total_score += appraiser(situation, {x, y}, color);
+                                      total_score -= appraiser(situation, {x, y}, next_color(color));
+                                      total_score += m_weights.DoubleThreat * double_threat_balance(situation, x, y, color);
+                                  });
         }
 
+        m_eval_cache.store(key, total_score);
         return total_score;
     }
 
@@ -158,11 +459,12 @@ namespace AI
      *
      * @param situation Текущая игровая ситуация (будет изменяться и восстанавливаться)
      * @param depth Текущая глубина поиска
+     * @param ply Расстояние от корня (уровень буферов арены)
      * @param maximizing_player Истина, если это ход максимизирующего игрока (наш ИИ)
      * @param color Цвет текущего игрока
      * @return int Оценка позиции
      */
-    int Ips::minimax_recursive(Core::Situation &situation, int depth, bool maximizing_player, Core::Color color)
+    int Ips::minimax_recursive(Core::Situation &situation, int depth, int ply, bool maximizing_player, Core::Color color)
     {
 
         if (depth == 0)
@@ -170,7 +472,8 @@ namespace AI
             return evaluate_position(situation, m_color);
         }
 
-        std::vector<std::pair<int, int>> moves = generate_moves_smart(situation);
+        MoveList moves = m_arena.moves(ply);
+        generate_moves_smart(situation, color, m_arena, moves);
 
         if (moves.empty())
         {
@@ -186,11 +489,13 @@ namespace AI
             {
                 std::pair<int, int> move = moves[i];
 
-                situation.move(move.first, move.second, color);
+                make_move(situation, move, color);
 
-                int score = minimax_recursive(situation, depth - 1, false, next_color(color));
+                int score = situation.is_five(move.first, move.second)
+                                ? win_in(ply + 1)
+                                : minimax_recursive(situation, depth - 1, ply + 1, false, next_color(color));
 
-                situation.un_move();
+                undo_move(situation);
 
                 if (score > best_score)
                 {
@@ -208,11 +513,13 @@ namespace AI
             {
                 std::pair<int, int> move = moves[i];
 
-                situation.move(move.first, move.second, color);
+                make_move(situation, move, color);
 
-                int score = minimax_recursive(situation, depth - 1, true, next_color(color));
+                int score = situation.is_five(move.first, move.second)
+                                ? -win_in(ply + 1)
+                                : minimax_recursive(situation, depth - 1, ply + 1, true, next_color(color));
 
-                situation.un_move();
+                undo_move(situation);
 
                 if (score < best_score)
                 {
@@ -232,13 +539,20 @@ namespace AI
      */
     std::pair<int, int> Ips::minimax(Core::Situation &situation)
     {
-        std::vector<std::pair<int, int>> moves = generate_moves_smart(situation);
+        prepare_search(situation);
+        MoveList moves = m_arena.moves(0);
+        generate_moves_smart(situation, m_color, m_arena, moves);
 
         if (moves.empty())
         {
             return {-1, -1};
         }
+        if (moves.size() == 1)
+        {
+            return moves[0]; // вынужденный ход (restrict_forced)
+        }
 
+        remove_symmetric_moves(situation, moves, m_color);
         std::pair<int, int> best_move = moves[0];
         int best_score = std::numeric_limits<int>::min();
 
@@ -246,11 +560,13 @@ namespace AI
         {
             std::pair<int, int> move = moves[i];
 
-            situation.move(move.first, move.second, m_color);
+            make_move(situation, move, m_color);
 
-            int score = minimax_recursive(situation, Core::Constants::MAX_SEARCH_DEPTH - 1, false, next_color(m_color));
+            int score = situation.is_five(move.first, move.second)
+                            ? win_in(1)
+                            : minimax_recursive(situation, Core::Constants::MAX_SEARCH_DEPTH - 1, 1, false, next_color(m_color));
 
-            situation.un_move();
+            undo_move(situation);
 
             if (score > best_score)
             {
@@ -271,8 +587,9 @@ namespace AI
      */
     std::pair<int, int> Ips::heur_find(Core::Situation &situation)
     {
-
-        std::vector<std::pair<int, int>> moves = generate_moves_smart(situation);
+        prepare_search(situation);
+        MoveList moves = m_arena.moves(0);
+        generate_moves_smart(situation, m_color, m_arena, moves);
         std::pair<int, int> best_move = moves[0];
         int max_score = std::numeric_limits<int>::min();
 
@@ -295,171 +612,803 @@ namespace AI
         return best_move;
     }
 
+    /**
+     * @brief Ключ позиции для таблицы транспозиций (камни, очередь хода,
+     * размер поля и правила).
+     *
+     * Ключ канонический: симметричные позиции делят одну запись. Ходы
+     * в записи хранятся в координатах канонической позиции, их переводят
+     * to_canonical и from_canonical. Хэш камней не зависит от размера поля
+     * и правил, поэтому они добавляются солью, как в eval_key: общей
+     * таблицей пользуются поиски на разных полях и по разным правилам.
+     */
+    static Core::Canonical position_key(Core::Situation &situation, Core::Color color)
+    {
+        const std::uint64_t salt = (static_cast<std::uint64_t>(situation.get_size()) << 8) ^
+                                   (static_cast<std::uint64_t>(situation.get_rules()) << 4);
+        Core::Canonical key = situation.get_canonical();
+        key.hash ^= Core::Zobrist::mix(salt) ^ (color == Core::Color::Black ? Core::Zobrist::BLACK_TO_MOVE : 0);
+        return key;
+    }
+
+    /**
+     * @brief Тип оценки после смены точки зрения (оценка меняет знак).
+     */
+    static Bound flip_bound(Bound bound)
+    {
+        return bound == Bound::Lower   ? Bound::Upper
+               : bound == Bound::Upper ? Bound::Lower
+                                       : bound;
+    }
+
+    static std::pair<int, int> to_canonical(const Core::Canonical &key, std::pair<int, int> move, int size)
+    {
+        if (move.first < 0)
+            return move;
+        return Core::Symmetry::apply(key.symmetry, move.first, move.second, size);
+    }
+
+    static std::pair<int, int> from_canonical(const Core::Canonical &key, std::pair<int, int> move, int size)
+    {
+        if (move.first < 0)
+            return move;
+        return Core::Symmetry::apply(Core::Symmetry::inverse(key.symmetry), move.first, move.second, size);
+    }
+
+    /**
+     * @brief Удаление корневых ходов, ведущих в симметричные позиции.
+     *
+     * Канонический хэш позиции после хода считается без хода на доске:
+     * хэш каждого образа дополняется ключом образа клетки хода. Из
+     * ходов с одинаковым хэшем остается первый.
+     */
+    void Ips::remove_symmetric_moves(Core::Situation &situation, MoveList &moves, Core::Color color)
+    {
+        const int size = situation.get_size();
+        std::uint64_t *keys = m_arena.keys();
+        std::size_t kept = 0;
+
+        for (std::size_t i = 0; i < moves.size(); ++i)
+        {
+            const std::pair<int, int> move = moves[i];
+            std::uint64_t key = std::numeric_limits<std::uint64_t>::max();
+            for (int s = 0; s < Core::Symmetry::COUNT; ++s)
+            {
+                const auto [x, y] = Core::Symmetry::apply(s, move.first, move.second, size);
+                key = std::min(key, situation.get_symmetric_hash(s) ^ Core::Zobrist::key(x, y, color));
+            }
+
+            if (std::find(keys, keys + kept, key) == keys + kept)
+            {
+                keys[kept] = key;
+                moves[kept++] = move;
+            }
+        }
+
+        moves.truncate(kept);
+    }
+
     /**
      * @brief Рекурсивный альфа-бета с отсечениями.
+     *
+     * Оценки в поиске считаются с точки зрения m_color (максимизирующего
+     * игрока), а в таблицу транспозиций записываются с точки зрения
+     * стороны, которой принадлежит ход. Поэтому записи остаются верными
+     * на следующих ходах партии и для других экземпляров Ips, разделяющих
+     * таблицу.
+     *
      * @param situation Ситуация (изменяется в процессе поиска).
-     * @param depth Глубина поиска.
+     * @param depth Оставшаяся глубина поиска.
+     * @param ply Расстояние от корня.
      * @param alpha Нижняя граница для отсечений.
      * @param beta Верхняя граница для отсечений.
      * @param maximizing_player Флаг максимизирующего игрока.
      * @param color Цвет текущего игрока.
+     * @param cut_node Ожидается отсечение (узел не на основной линии).
      * @return Лучшая оценка для текущей ветви.
+     *
+     * @note Выборочный поиск (m_pruning): поздние тихие ходы сокращаются
+     * (LMR) с перепроверкой на полной глубине, у листьев применяются
+     * razoring и отсечение по appraiser, в ожидаемых узлах отсечения -
+     * multi-cut. Ходы-угрозы (is_threat) не сокращаются и не отсекаются.
      */
 
-    int Ips::alphabeta_recursive(Core::Situation &situation, int depth, int alpha, int beta,
-                                 bool maximizing_player, Core::Color color)
+    int Ips::alphabeta_recursive(Core::Situation &situation, int depth, int ply, int alpha, int beta,
+                                 bool maximizing_player, Core::Color color, bool cut_node)
     {
-        if (depth == 0)
+        m_pv_lines[ply].clear();
+
+        if ((m_nodes & TIME_CHECK_MASK) == 0 && time_is_up())
         {
-            return evaluate_position(situation, color);
+            m_aborted = true;
+        }
+        if (m_aborted)
+        {
+            return 0;
         }
 
-        std::vector<std::pair<int, int>> moves = generate_moves_smart(situation);
+        // Отсечение по расстоянию до выигрыша: ходящий в лучшем случае
+        // выигрывает следующим ходом
+        if (maximizing_player)
+        {
+            beta = std::min(beta, win_in(ply + 1));
+            if (alpha >= beta)
+                return beta;
+        }
+        else
+        {
+            alpha = std::max(alpha, -win_in(ply + 1));
+            if (alpha >= beta)
+                return alpha;
+        }
+
+        const int alpha_start = alpha;
+        const int beta_start = beta;
+        const int size = situation.get_size();
+        const Core::Canonical key = position_key(situation, color);
+        std::pair<int, int> tt_move{-1, -1};
 
-        generate_moves_sorted(moves, situation, color, maximizing_player);
+        TTEntry entry;
+        if (m_table->probe(key.hash, entry))
+        {
+            tt_move = from_canonical(key, {entry.x, entry.y}, size);
+            if (entry.depth >= depth)
+            {
+                const bool own = color == m_color;
+                const int score = score_from_tt(own ? entry.score : -entry.score, ply);
+                const Bound bound = own ? entry.bound : flip_bound(entry.bound);
+
+                if (bound == Bound::Exact)
+                    return score;
+                if (bound == Bound::Lower)
+                    alpha = std::max(alpha, score);
+                else if (bound == Bound::Upper)
+                    beta = std::min(beta, score);
+                if (alpha >= beta)
+                    return score;
+            }
+        }
+
+        if (depth <= 0)
+        {
+            return evaluate_position(situation, m_color);
+        }
+
+        MoveList moves = m_arena.moves(ply);
+        generate_moves_smart(situation, color, m_arena, moves);
 
         if (moves.empty())
         {
-            return evaluate_position(situation, color);
+            return evaluate_position(situation, m_color);
         }
 
-        if (maximizing_player)
+        generate_moves_sorted(moves, situation, color, tt_move, ply);
+
+        const int five = maximizing_player ? win_in(ply + 1) : -win_in(ply + 1);
+        // Отсечения используют только границу, которую улучшает ходящий игрок
+        const bool bounded = maximizing_player ? alpha != std::numeric_limits<int>::min()
+                                               : beta != std::numeric_limits<int>::max();
+        const bool cut_bounded = maximizing_player ? beta != std::numeric_limits<int>::max()
+                                                   : alpha != std::numeric_limits<int>::min();
+        const bool selective = m_pruning && bounded;
+
+        // Угрозы (свои четверки и тройки, защита от чужих) не сокращаются и не отсекаются
+        std::uint8_t *threats = m_arena.flags(ply);
+        bool any_threat = false;
+        for (size_t i = 0; i < moves.size(); ++i)
         {
-            int best_score = std::numeric_limits<int>::min();
+            threats[i] = is_threat(situation, moves[i], color);
+            any_threat |= threats[i] != 0;
+        }
+
+        // Статическая оценка для razoring и отсечения бесперспективных ходов
+        int static_eval = 0;
+        const bool frontier = selective && depth <= FUTILITY_DEPTH;
+        if (frontier)
+        {
+            static_eval = evaluate_position(situation, m_color);
+            const int margin = futility_margin(depth) * RAZOR_FACTOR;
 
-            for (const auto &move : moves)
+            // Razoring: без угроз позиция слишком плоха, чтобы ее спасти
+            if (!any_threat &&
+                (maximizing_player ? static_eval + margin <= alpha : static_eval - margin >= beta))
             {
-                situation.move(move.first, move.second, color);
+                return static_eval;
+            }
+        }
 
-                int score = alphabeta_recursive(situation, depth - 1, alpha, beta,
-                                                false, next_color(color));
+        // Multi-cut: если несколько первых ходов на малой глубине дают
+        // отсечение, узел считается отсекаемым без полного перебора
+        if (m_pruning && cut_bounded && cut_node && depth >= MULTI_CUT_DEPTH)
+        {
+            int cuts = 0;
+            const size_t tries = std::min<size_t>(moves.size(), MULTI_CUT_MOVES);
+            for (size_t i = 0; i < tries && cuts < MULTI_CUT_REQUIRED; ++i)
+            {
+                const auto &move = moves[i];
+                make_move(situation, move, color);
+                int score = situation.is_five(move.first, move.second)
+                                ? five
+                                : alphabeta_recursive(situation, depth - 1 - MULTI_CUT_REDUCTION, ply + 1,
+                                                      alpha, beta, !maximizing_player, next_color(color), false);
+                undo_move(situation);
+
+                if (maximizing_player ? score >= beta : score <= alpha)
+                    cuts++;
+            }
+            if (m_aborted)
+                return 0;
+            if (cuts >= MULTI_CUT_REQUIRED)
+                return maximizing_player ? beta : alpha;
+        }
 
-                situation.un_move();
+        int best_score = maximizing_player ? std::numeric_limits<int>::min()
+                                           : std::numeric_limits<int>::max();
+        std::pair<int, int> best_move{-1, -1};
 
-                best_score = std::max(best_score, score);
-                alpha = std::max(alpha, best_score);
+        for (size_t i = 0; i < moves.size(); ++i)
+        {
+            const auto &move = moves[i];
+            const bool quiet = !threats[i] && i > 0;
 
-                if (beta <= alpha)
+            // Отсечение бесперспективных ходов у листьев по оценке appraiser
+            if (frontier && quiet)
+            {
+                const int gain = FUTILITY_GAIN * std::abs(appraiser(situation, move, color)) + futility_margin(depth);
+                if (maximizing_player ? static_eval + gain <= alpha : static_eval - gain >= beta)
                 {
-                    break;
+                    continue;
                 }
             }
 
-            return best_score;
-        }
-        else
-        {
-            int best_score = std::numeric_limits<int>::max();
+            m_pv_lines[ply + 1].clear();
+            make_move(situation, move, color);
 
-            for (const auto &move : moves)
+            int score;
+            if (situation.is_five(move.first, move.second))
+            {
+                score = five;
+            }
+            else
             {
-                situation.move(move.first, move.second, color);
+                // Сокращение поздних тихих ходов с перепроверкой при улучшении границы
+                int reduction = 0;
+                if (m_pruning && quiet && depth >= LMR_DEPTH && i >= LMR_MOVES)
+                {
+                    reduction = (i >= 2 * LMR_MOVES + 2) ? 2 : 1;
+                }
+
+                score = alphabeta_recursive(situation, depth - 1 - reduction, ply + 1, alpha, beta,
+                                            !maximizing_player, next_color(color), i == 0 ? !cut_node : true);
+
+                if (reduction > 0 && !m_aborted && (maximizing_player ? score > alpha : score < beta))
+                {
+                    score = alphabeta_recursive(situation, depth - 1, ply + 1, alpha, beta,
+                                                !maximizing_player, next_color(color), !cut_node);
+                }
+            }
+
+            undo_move(situation);
+            m_follow_pv = false; // первый ход каждого узла уже пройден
 
-                int score = alphabeta_recursive(situation, depth - 1, alpha, beta,
-                                                true, next_color(color));
+            if (m_aborted)
+            {
+                return 0;
+            }
 
-                situation.un_move();
+            if (maximizing_player ? score > best_score : score < best_score)
+            {
+                best_score = score;
+                best_move = move;
+                update_pv(ply, move);
+            }
 
-                best_score = std::min(best_score, score);
+            if (maximizing_player)
+                alpha = std::max(alpha, best_score);
+            else
                 beta = std::min(beta, best_score);
 
-                if (beta <= alpha)
-                {
-                    break;
-                }
+            if (beta <= alpha)
+            {
+                reward_history(color, move, depth);
+                break;
             }
+        }
 
-            return best_score;
+        if (best_move.first < 0)
+        {
+            return static_eval; // все ходы отсечены как бесперспективные
+        }
+
+        const Bound bound = best_score <= alpha_start  ? Bound::Upper
+                            : best_score >= beta_start ? Bound::Lower
+                                                       : Bound::Exact;
+        const std::pair<int, int> stored = to_canonical(key, best_move, size);
+        const bool own = color == m_color;
+        const int stored_score = score_to_tt(best_score, ply);
+        m_table->store(key.hash, depth, own ? stored_score : -stored_score, own ? bound : flip_bound(bound),
+                       stored.first, stored.second);
+
+        return best_score;
+    }
+
+    /**
+     * @brief Проверка угрозы по карте угроз (Situation::threats).
+     *
+     * Угрозой считается ход, который образует пятерку, четверку или
+     * тройку цвета color, а также ход в клетку, где соперник образовал бы
+     * пятерку или четверку.
+     */
+    bool Ips::is_threat(Core::Situation &situation, std::pair<int, int> move, Core::Color color)
+    {
+        using namespace Core::Threats;
+        return (situation.threats(move.first, move.second, color) & FORCING) != 0 ||
+               (situation.threats(move.first, move.second, next_color(color)) & (five | four)) != 0;
+    }
+
+    /**
+     * @brief Приоритет хода по карте угроз.
+     *
+     * Порядок: своя пятерка, защита от пятерки, своя двойная угроза,
+     * защита от двойной угрозы, своя четверка, своя открытая тройка.
+     * appraiser считает камни линий по отдельности и не отличает, например,
+     * четверку-тройку от двух разрозненных троек.
+     */
+    int Ips::threat_bonus(Core::Situation &situation, std::pair<int, int> move, Core::Color color) const
+    {
+        using namespace Core::Threats;
+        const std::uint8_t own = playable_threats(situation, move.first, move.second, color);
+        const std::uint8_t theirs = playable_threats(situation, move.first, move.second, next_color(color));
+
+        if (own & five)
+            return 2 * m_weights.FiveInRow;
+        if (theirs & five)
+            return m_weights.FiveInRow;
+        int bonus = 0;
+        if (own & DOUBLE)
+            bonus += 4 * m_weights.FourInRow;
+        if (theirs & DOUBLE)
+            bonus += 2 * m_weights.FourInRow;
+        if (own & four)
+            bonus += m_weights.FourInRow;
+        if (own & open_three)
+            bonus += m_weights.ThreeInRow;
+        return bonus;
+    }
+
+    int Ips::futility_margin(int depth) const
+    {
+        return FUTILITY_MARGIN * m_weights.ThreeInRow * depth;
+    }
+
+    bool Ips::time_is_up() const
+    {
+        return m_time_ms > 0 && std::chrono::steady_clock::now() >= m_deadline;
+    }
+
+    /**
+     * @brief Основная линия: ход move и продолжение из следующего уровня.
+     */
+    void Ips::update_pv(int ply, std::pair<int, int> move)
+    {
+        std::vector<std::pair<int, int>> &line = m_pv_lines[ply];
+        line.clear();
+        line.push_back(move);
+        line.insert(line.end(), m_pv_lines[ply + 1].begin(), m_pv_lines[ply + 1].end());
+    }
+
+    void Ips::reward_history(Core::Color color, std::pair<int, int> move, int depth)
+    {
+        int &value = m_history[color][move.second * m_history_size + move.first];
+        value = std::min(value + depth * depth, HISTORY_LIMIT);
+    }
+
+    /**
+     * @brief Подготовка памяти поиска к новому ходу.
+     *
+     * Таблица транспозиций и история сохраняются между вызовами get_move:
+     * таблица лишь увеличивает поколение (старые записи вытесняются первыми),
+     * история делится пополам. Если соперник ответил ходом из прошлой
+     * основной линии, ее продолжение используется для упорядочивания
+     * ходов первой итерации.
+     */
+    void Ips::begin_search(Core::Situation &situation)
+    {
+        // Размером и поколениями общей таблицы управляет ее владелец
+        if (m_table == &m_tt)
+        {
+            if (m_tt.empty())
+            {
+                m_tt.resize(m_hash_mb);
+            }
+            m_tt.new_search();
+        }
+
+        const int size = situation.get_size();
+        if (m_history_size != size)
+        {
+            m_history_size = size;
+            m_history[0].assign(size * size, 0);
+            m_history[1].assign(size * size, 0);
         }
+        else
+        {
+            for (auto &table : m_history)
+                for (int &value : table)
+                    value /= 2;
+        }
+
+        // Линии не длиннее числа уровней: дальше они копируются без выделений
+        const std::size_t plies = static_cast<std::size_t>(m_max_depth) + 2;
+        m_pv_lines.resize(plies);
+        for (auto &line : m_pv_lines)
+            line.reserve(plies);
+        m_pv.reserve(plies);
+        m_expected.reserve(plies);
+
+        const auto &history = situation.get_history();
+        const std::size_t n = history.size();
+        m_expected.clear();
+        if (m_pv.size() > 2 && n >= 2 && history[n - 2] == m_pv[0] && history[n - 1] == m_pv[1])
+        {
+            m_expected.assign(m_pv.begin() + 2, m_pv.end());
+            m_pv_hits++;
+        }
+
+        m_aborted = false;
+        m_deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(m_time_ms);
     }
 
     /**
-     * @brief Полный альфа-бета с выбором лучшего хода.
+     * @brief Полный альфа-бета с итеративным углублением.
+     *
+     * Каждая итерация начинается с лучшего хода предыдущей и следует ее
+     * основной линии. Если корневая позиция уже исследована прошлым
+     * поиском (ожидаемый ответ соперника), итерации, глубина которых не
+     * превышает сохраненную, пропускаются. Углубление идет до m_max_depth
+     * или до исчерпания времени m_time_ms; итерация, прерванная по
+     * времени, отбрасывается.
+     *
      * @param situation Текущая игровая ситуация.
      * @return Координаты лучшего хода.
      */
     std::pair<int, int> Ips::alphabeta(Core::Situation &situation)
     {
-        std::vector<std::pair<int, int>> moves = generate_moves_smart(situation);
+        return alphabeta_lines(situation, 1);
+    }
+
+    SearchResult Ips::analyze(Core::Situation &situation, int multi_pv)
+    {
+        RENJU_TRACE_SCOPE("Ips::analyze");
+        const std::uint64_t nodes = m_nodes;
+
+        SearchResult result;
+        result.best_move = alphabeta_lines(situation, std::max(1, multi_pv));
+        result.score = m_last_score;
+        result.depth = m_last_depth;
+        result.nodes = m_nodes - nodes;
+        result.lines.assign(m_best_lines.begin(), m_best_lines.begin() + m_best_count);
+        for (PvLine &line : result.lines)
+        {
+            extend_pv(situation, line.pv, std::max(result.depth, 1));
+        }
+        return result;
+    }
+
+    void Ips::extend_pv(Core::Situation &situation, std::vector<std::pair<int, int>> &pv, int length)
+    {
+        const int size = situation.get_size();
+        Core::Color color = m_color;
+        int played = 0;
+
+        for (const auto &move : pv)
+        {
+            if (!situation.move(move.first, move.second, color))
+                break;
+            played++;
+            color = next_color(color);
+        }
+        pv.resize(played);
+
+        while (!pv.empty() && static_cast<int>(pv.size()) < length && !situation.is_five(pv.back().first, pv.back().second))
+        {
+            TTEntry entry;
+            if (!m_table->probe(position_key(situation, color).hash, entry) || entry.x < 0)
+                break;
+
+            const auto move = from_canonical(position_key(situation, color), {entry.x, entry.y}, size);
+            if (!situation.move(move.first, move.second, color))
+                break;
+            pv.push_back(move);
+            played++;
+            color = next_color(color);
+        }
+
+        while (played-- > 0)
+        {
+            situation.un_move();
+        }
+    }
+
+    /**
+     * @brief Первая линия ищется с полным окном, как обычный поиск хода;
+     * следующие - в окне ASPIRATION_WINDOW вокруг своей прошлой оценки.
+     * Линии итерации, прерванной по времени, отбрасываются целиком:
+     * готовые линии и линии итерации меняются местами, а не копируются,
+     * поэтому повторные поиски не выделяют память.
+     */
+    std::pair<int, int> Ips::alphabeta_lines(Core::Situation &situation, int multi_pv)
+    {
+        constexpr int MIN = std::numeric_limits<int>::min();
+        constexpr int MAX = std::numeric_limits<int>::max();
+
+        m_best_count = 0;
+        m_last_depth = 0;
+        m_last_score = 0;
+
+        prepare_search(situation);
+        MoveList moves = m_arena.moves(0);
+        generate_moves_smart(situation, m_color, m_arena, moves);
 
         if (moves.empty())
         {
             return {-1, -1};
         }
+        if (moves.size() == 1)
+        {
+            return answer_forced(situation, moves[0]);
+        }
 
-        generate_moves_sorted(moves, situation, m_color, true);
+        begin_search(situation);
+        remove_symmetric_moves(situation, moves, m_color);
 
+        const int size = situation.get_size();
+        const Core::Canonical key = position_key(situation, m_color);
         std::pair<int, int> best_move = moves[0];
+        int start_depth = 1;
+        multi_pv = std::min<int>(multi_pv, static_cast<int>(moves.size()));
+
+        TTEntry entry;
+        if (m_table->probe(key.hash, entry))
+        {
+            if (entry.bound == Bound::Exact && entry.x >= 0)
+            {
+                best_move = from_canonical(key, {entry.x, entry.y}, size);
+                start_depth = std::min<int>(entry.depth + 1, m_max_depth);
+            }
+        }
+
+        if (static_cast<int>(m_lines.size()) < multi_pv)
+        {
+            m_lines.resize(multi_pv);
+            m_best_lines.resize(multi_pv);
+        }
+        for (auto *lines : {&m_lines, &m_best_lines})
+        {
+            for (PvLine &line : *lines)
+                line.pv.reserve(static_cast<std::size_t>(m_max_depth) + 2);
+        }
+
+        for (int depth = start_depth; depth <= m_max_depth; ++depth)
+        {
+            RENJU_TRACE_SCOPE_VALUE("alphabeta.iteration", depth);
+            m_follow_pv = true;
+            generate_moves_sorted(moves, situation, m_color, best_move, 0);
+
+            int found = 0;
+            for (int k = 0; k < multi_pv && !m_aborted; ++k)
+            {
+                // Окно вокруг оценки этой линии на прошлой итерации
+                const bool windowed = k > 0 && k < m_best_count;
+                int delta = ASPIRATION_WINDOW;
+                int alpha = windowed ? m_best_lines[k].score - delta : MIN;
+                int beta = windowed ? m_best_lines[k].score + delta : MAX;
+
+                std::pair<int, int> move{-1, -1};
+                int score = 0;
+                while (true)
+                {
+                    score = search_root(situation, moves, k, depth, alpha, beta, move);
+                    if (m_aborted || move.first < 0)
+                    {
+                        break;
+                    }
+
+                    delta *= 4;
+                    if (alpha != MIN && score <= alpha)
+                    {
+                        alpha = (delta > ASPIRATION_LIMIT) ? MIN : score - delta;
+                    }
+                    else if (beta != MAX && score >= beta)
+                    {
+                        beta = (delta > ASPIRATION_LIMIT) ? MAX : score + delta;
+                    }
+                    else
+                    {
+                        break;
+                    }
+                }
+
+                if (m_aborted || move.first < 0)
+                {
+                    break;
+                }
+
+                m_lines[k].move = move;
+                m_lines[k].score = score;
+                m_lines[k].pv = m_pv_lines[0];
+                found++;
+            }
+
+            // Прерванная по времени итерация не используется
+            if (m_aborted || found == 0)
+            {
+                break;
+            }
+
+            // Выборочные отсечения могут нарушить порядок оценок линий;
+            // сортировка вставками обменами не выделяет памяти
+            for (int i = 1; i < found; ++i)
+            {
+                for (int j = i; j > 0 && m_lines[j].score > m_lines[j - 1].score; --j)
+                    std::swap(m_lines[j], m_lines[j - 1]);
+            }
+            std::swap(m_lines, m_best_lines);
+            m_best_count = found;
+
+            const PvLine &best = m_best_lines[0];
+            best_move = best.move;
+            m_last_depth = depth;
+            m_last_score = best.score;
+            const std::pair<int, int> stored = to_canonical(key, best_move, size);
+            m_table->store(key.hash, depth, best.score, Bound::Exact, stored.first, stored.second);
+            m_expected = best.pv;
+
+            if (best.score >= MATE_BOUND)
+            {
+                break; // найден кратчайший выигрыш: итерации идут по возрастанию глубины
+            }
+        }
+
+        m_pv = m_expected;
+        return best_move;
+    }
+
+    /**
+     * @brief Единственный ход (выигрыш, блок четверки, первый ход партии)
+     * возвращается без перебора; оценка - выигрыш или статическая
+     * оценка позиции после хода.
+     */
+    std::pair<int, int> Ips::answer_forced(Core::Situation &situation, std::pair<int, int> move)
+    {
+        make_move(situation, move, m_color);
+        const int score = situation.is_five(move.first, move.second) ? win_in(1)
+                                                                     : evaluate_position(situation, m_color);
+        undo_move(situation);
+
+        if (m_best_lines.empty())
+        {
+            m_lines.resize(1);
+            m_best_lines.resize(1);
+        }
+        PvLine &line = m_best_lines[0];
+        line.move = move;
+        line.score = score;
+        line.pv.assign(1, move);
+        m_best_count = 1;
+        m_last_depth = 1;
+        m_last_score = score;
+        m_expected = line.pv;
+        m_pv = m_expected;
+        return move;
+    }
+
+    int Ips::search_root(Core::Situation &situation, MoveList &moves, int excluded,
+                         int depth, int alpha, int beta, std::pair<int, int> &move)
+    {
         int best_score = std::numeric_limits<int>::min();
-        int alpha = std::numeric_limits<int>::min();
-        int beta = std::numeric_limits<int>::max();
+        int searched = 0;
+        move = {-1, -1};
 
-        for (const auto &move : moves)
+        for (size_t i = 0; i < moves.size(); ++i)
         {
-            situation.move(move.first, move.second, m_color);
+            const auto &candidate = moves[i];
+            if (std::any_of(m_lines.begin(), m_lines.begin() + excluded, [&](const PvLine &line)
+                            { return line.move == candidate; }))
+            {
+                continue;
+            }
 
-            int score = alphabeta_recursive(situation,
-                                            Core::Constants::MAX_SEARCH_DEPTH - 1,
-                                            alpha, beta, false, next_color(m_color));
+            m_pv_lines[1].clear();
+            make_move(situation, candidate, m_color);
 
-            situation.un_move();
+            int score = situation.is_five(candidate.first, candidate.second)
+                            ? win_in(1)
+                            : alphabeta_recursive(situation, depth - 1, 1,
+                                                  alpha, beta, false, next_color(m_color), searched > 0);
+
+            undo_move(situation);
+            m_follow_pv = false;
+            searched++;
+
+            if (m_aborted)
+            {
+                break;
+            }
 
             if (score > best_score)
             {
                 best_score = score;
-                best_move = move;
+                move = candidate;
+                update_pv(0, candidate);
                 alpha = std::max(alpha, best_score);
             }
+
+            if (alpha >= beta)
+            {
+                break; // выход за окно сверху: точная оценка не нужна
+            }
         }
 
-        return best_move;
+        return best_score;
     }
 
     /**
      * @brief Сортировка ходов для оптимизации альфа-бета отсечений.
-     * @param moves Вектор ходов для сортировки.
+     *
+     * Ходы упорядочиваются по убыванию оценки appraiser для ходящего цвета
+     * с добавкой из таблицы истории. Первыми ставятся ход из основной линии
+     * (пока поиск идет по ней), затем лучший ход из таблицы транспозиций.
+     *
+     * @param moves Список ходов для сортировки.
      * @param situation Текущая игровая ситуация.
-     * @param color Цвет игрока для оценки.
-     * @param is_maximizing Флаг типа игрока.
+     * @param color Цвет ходящего игрока.
+     * @param tt_move Лучший ход из таблицы транспозиций ({-1, -1}, если его нет).
+     * @param ply Расстояние от корня.
      */
-    void Ips::generate_moves_sorted(std::vector<std::pair<int, int>> &moves,
+    void Ips::generate_moves_sorted(MoveList &moves,
                                     Core::Situation &situation,
                                     Core::Color color,
-                                    bool is_maximizing)
+                                    std::pair<int, int> tt_move,
+                                    int ply)
     {
+        RENJU_TRACE_SCOPE("Ips::sort_moves");
         if (moves.empty())
             return;
 
-        std::vector<std::pair<int, std::pair<int, int>>> scored_moves;
-        scored_moves.reserve(moves.size());
+        int *scores = m_arena.scores();
+        const bool has_history = m_history_size == situation.get_size();
+        const int count = static_cast<int>(moves.size());
 
-        for (const auto &move : moves)
+        // Устойчивая сортировка вставками по убыванию оценки: ходов
+        // немного, и в отличие от std::stable_sort ей не нужен буфер
+        for (int i = 0; i < count; ++i)
         {
-            int score = appraiser(situation, move, color);
-            scored_moves.emplace_back(score, move);
-        }
+            const std::pair<int, int> move = moves[i];
+            int score = appraiser(situation, move, color) + threat_bonus(situation, move, color);
+            if (has_history)
+                score += m_history[color][move.second * m_history_size + move.first];
 
-        if (is_maximizing)
-        {
-            std::sort(scored_moves.begin(), scored_moves.end(),
-                      [](const auto &a, const auto &b)
-                      {
-                          return a.first > b.first;
-                      });
-        }
-        else
-        {
-            std::sort(scored_moves.begin(), scored_moves.end(),
-                      [](const auto &a, const auto &b)
-                      {
-                          return a.first < b.first;
-                      });
+            int j = i;
+            for (; j > 0 && scores[j - 1] < score; --j)
+            {
+                scores[j] = scores[j - 1];
+                moves[j] = moves[j - 1];
+            }
+            scores[j] = score;
+            moves[j] = move;
         }
 
-        for (size_t i = 0; i < scored_moves.size(); ++i)
+        auto bring_to_front = [&](std::pair<int, int> move)
         {
-            moves[i] = scored_moves[i].second;
-        }
+            auto it = std::find(moves.begin(), moves.end(), move);
+            if (it != moves.end())
+                std::rotate(moves.begin(), it, it + 1);
+        };
+
+        bring_to_front(tt_move);
+        if (m_follow_pv && ply < static_cast<int>(m_expected.size()))
+            bring_to_front(m_expected[ply]);
     }
 
     /**
@@ -467,7 +1416,14 @@ namespace AI
      *
      * @param color Цвет игрока, за которого будет играть ИИ.
      */
-    Ips::Ips(Core::Color color) : m_color(color) {}
+    Ips::Ips(Core::Color color)
+        : m_color(color), m_weights(default_weights()), m_algo(Core::Constants::SEARCH_ALGORIMT),
+          m_eval(EvalKind::Handcrafted), m_nnue_active(false), m_nodes(0), m_mcts_tree(*this),
+          m_eval_cache_entries(EvalCache::DEFAULT_ENTRIES),
+          m_table(&m_tt), m_hash_mb(Core::Constants::HASH_SIZE_MB), m_history_size(0), m_follow_pv(false), m_pv_hits(0),
+          m_pruning(true), m_max_depth(Core::Constants::ALPHABETA_MAX_DEPTH),
+          m_time_ms(Core::Constants::SEARCH_TIME_MS), m_aborted(false), m_last_depth(0), m_last_score(0),
+          m_best_count(0) {}
 
     /**
      * @brief Запрашивает у ИИ ход на основе текущей ситуации.
@@ -479,9 +1435,10 @@ namespace AI
      */
     std::pair<int, int> Ips::get_move(Core::Situation &situation)
     {
+        RENJU_TRACE_SCOPE("Ips::get_move");
         using namespace Core::Constants;
 
-        switch (Core::Constants::SEARCH_ALGORIMT)
+        switch (m_algo)
         {
         case SearchAlgo::Minimax:
             return minimax(situation);
@@ -489,11 +1446,28 @@ namespace AI
             return heur_find(situation);
         case SearchAlgo::AlphaBeta:
             return alphabeta(situation);
+        case SearchAlgo::Mcts:
+        {
+            m_mcts_tree.set_options(m_mcts);
+            std::pair<int, int> move = m_mcts_tree.search(situation, m_color);
+            m_nodes += static_cast<std::uint64_t>(m_mcts_tree.get_iterations());
+            return move;
+        }
         default:
             return minimax(situation);
         }
     }
 
+    std::optional<std::pair<int, int>> Ips::get_move(Core::UnboundedSituation &board)
+    {
+        const std::pair<int, int> move = get_move(board.window());
+        if (move.first < 0)
+        {
+            return std::nullopt;
+        }
+        return board.from_window(move);
+    }
+
     /**
      * @brief Возвращает цвет игрока, за которого играет ИИ.
      *
@@ -503,6 +1477,138 @@ namespace AI
     {
         return m_color;
     }
+
+    void Ips::set_weights(const Patterns &weights)
+    {
+        m_weights = weights;
+        m_eval_cache.clear();
+    }
+
+    const Patterns &Ips::get_weights() const
+    {
+        return m_weights;
+    }
+
+    void Ips::set_algorithm(Core::Constants::SearchAlgo algo)
+    {
+        m_algo = algo;
+    }
+
+    void Ips::set_hash_size(std::size_t megabytes)
+    {
+        m_hash_mb = megabytes;
+        m_tt.resize(0); // память выделяется при следующем поиске
+    }
+
+    void Ips::set_shared_table(TranspositionTable *table)
+    {
+        m_table = table ? table : &m_tt;
+    }
+
+    void Ips::clear_memory()
+    {
+        m_tt.clear();
+        m_eval_cache.clear();
+        m_history_size = 0;
+        m_pv.clear();
+        m_expected.clear();
+    }
+
+    std::uint64_t Ips::get_pv_hits() const
+    {
+        return m_pv_hits;
+    }
+
+    void Ips::set_search_limits(int max_depth, int time_ms)
+    {
+        m_max_depth = std::max(1, max_depth);
+        m_time_ms = time_ms;
+    }
+
+    void Ips::set_pruning(bool enabled)
+    {
+        m_pruning = enabled;
+    }
+
+    int Ips::get_last_depth() const
+    {
+        return m_last_depth;
+    }
+
+    int Ips::get_last_score() const
+    {
+        return m_last_score;
+    }
+
+    void Ips::set_mcts_options(const MctsOptions &options)
+    {
+        m_mcts = options;
+    }
+
+    void Ips::set_evaluation(EvalKind kind)
+    {
+        m_eval = kind;
+    }
+
+    void Ips::set_network(const Nnue::Network *network)
+    {
+        m_nnue.set_network(network);
+        m_eval_cache.clear();
+    }
+
+    void Ips::set_eval_cache_size(std::size_t entries)
+    {
+        m_eval_cache_entries = entries;
+        m_eval_cache.resize(0); // память выделяется при следующем поиске
+    }
+
+    const EvalCacheStats &Ips::get_eval_cache_stats() const
+    {
+        return m_eval_cache.stats();
+    }
+
+    std::uint64_t Ips::get_nodes() const
+    {
+        return m_nodes;
+    }
+
+    /**
+     * @brief Признаки позиции.
+     *
+     * Повторяет обход evaluate_position, но вместо взвешенной суммы
+     * накапливает количества паттернов: для каждой пустой клетки оценка
+     * цвета color и цвета соперника входят с противоположными знаками.
+     */
+    Patterns Ips::count_features(Core::Situation &situation, Core::Color color)
+    {
+        Patterns total{};
+        const int size = situation.get_size();
+
+        auto accumulate = [&](const Patterns &p, int sign)
+        {
+            total.TwoInRow += sign * p.TwoInRow;
+            total.ThreeInRow += sign * p.ThreeInRow;
+            total.FourInRow += sign * p.FourInRow;
+            total.FiveInRow += sign * p.FiveInRow;
+            total.OpenEnd += sign * p.OpenEnd;
+            total.DoubleThreat += sign * p.DoubleThreat;
+        };
+
+        m_arena.reserve(std::max(m_arena.plies(), 1), size * size);
+        for_each_pattern_cell(situation, m_arena, [&](int x, int y)
+                              {
+                                  for (const auto &dir : Core::Constants::DIRECTIONS)
+                                  {
+                                      Patterns mine = row_assessment(situation, {x, y}, dir[0], dir[1], color);
+                                      Patterns theirs = row_assessment(situation, {x, y}, dir[0], dir[1], next_color(color));
+                                      // appraiser(color) - appraiser(next_color(color)) == 2 * (mine - theirs)
+                                      accumulate(mine, 2);
+                                      accumulate(theirs, -2);
+                                  }
+                                  total.DoubleThreat += double_threat_balance(situation, x, y, color);
+                              });
+        return total;
+    }
     /**
      * @brief Быстрая оценка одного хода (аппрайзер).
      * @param situation Текущая игровая ситуация.
@@ -527,7 +1633,7 @@ namespace AI
 
             friends_patterns = row_assessment(situation, move, dir[0], dir[1], color);
             opponents_patterns = row_assessment(situation, move, dir[0], dir[1], next_color(color));
-            move_impact += count_impact(friends_patterns) - count_impact(opponents_patterns);
+            move_impact += count_impact(friends_patterns, m_weights) - count_impact(opponents_patterns, m_weights);
         }
 
         return move_impact;
@@ -545,7 +1651,7 @@ namespace AI
                                  std::pair<int, int> move, int dx, int dy,
                                  Core::Color color)
     {
-        Patterns result;
+        Patterns result{};
 
         int x = move.first;
         int y = move.second;
@@ -553,18 +1659,15 @@ namespace AI
 
         for (int offset = -4; offset <= 4; offset++)
         {
-            Core::Stone stone;
             int nx = x + dx * offset;
             int ny = y + dy * offset;
 
-            try
-            {
-                stone = situation.get_stone(nx, ny);
-            }
-            catch (const std::out_of_range &stone)
+            // Клетки за краем поля пропускаются (раньше - через исключение get_stone)
+            if (!situation.is_within_bounds(nx, ny))
             {
                 continue;
             }
+            Core::Stone stone = situation.get_stone(nx, ny);
 
             if (stone.get_color() == color)
             {
@@ -0,0 +1,495 @@
+#include "solver/mcts.h"
+#include "solver/ips.h"
+#include "core/threats.h"
+#include "utils/trace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <thread>
+
+namespace AI
+{
+    namespace
+    {
+        /**
+         * @brief Радиус окрестности последних ходов, из которой берутся ходы доигрывания.
+         */
+        constexpr int PLAYOUT_RADIUS = 2;
+
+        /**
+         * @brief Сколько последних ходов задают окрестность в доигрывании.
+         */
+        constexpr int PLAYOUT_RECENT = 4;
+
+        /**
+         * @brief Сколько случайных кандидатов сравнивается по эвристике в доигрывании.
+         */
+        constexpr int PLAYOUT_SAMPLE = 6;
+
+        /**
+         * @brief Оценка непосещенного ребенка (first play urgency).
+         */
+        constexpr double FIRST_PLAY_VALUE = 0.5;
+
+        Core::Color other(Core::Color color)
+        {
+            return color == Core::Color::White ? Core::Color::Black : Core::Color::White;
+        }
+
+        /**
+         * @brief Образует ли ход color в пустую клетку (x, y) пять в ряд.
+         *
+         * Берется из карты угроз, поэтому длинный ряд черных в рэндзю
+         * пятеркой не считается (такой ход запрещен).
+         */
+        bool wins_at(const Core::Situation &situation, int x, int y, Core::Color color)
+        {
+            return (situation.threats(x, y, color) & Core::Threats::five) != 0;
+        }
+
+        /**
+         * @brief Ключ сортировки хода по убыванию: оценка в старших битах,
+         * дополнение номера в списке - в младших (при равных оценках
+         * раньше идет ход, сгенерированный раньше).
+         */
+        std::uint64_t order_key(int score, std::size_t index)
+        {
+            const std::uint32_t biased = static_cast<std::uint32_t>(score) ^ 0x80000000u;
+            return (static_cast<std::uint64_t>(biased) << 32) | ~static_cast<std::uint32_t>(index);
+        }
+
+        std::size_t order_index(std::uint64_t key)
+        {
+            return ~static_cast<std::uint32_t>(key);
+        }
+    } // namespace
+
+    /**
+     * @brief Важность клетки для обеих сторон.
+     *
+     * В отличие от Ips::appraiser (свои паттерны минус чужие) паттерны
+     * соперника прибавляются: клетка рядом с чужой четверкой должна
+     * считаться срочной, а не плохой.
+     */
+    int Mcts::urgency(Core::Situation &situation, std::pair<int, int> move, Core::Color color) const
+    {
+        int score = 0;
+        for (const auto &dir : Core::Constants::DIRECTIONS)
+        {
+            score += count_impact(m_ips.row_assessment(situation, move, dir[0], dir[1], color), m_ips.m_weights);
+            score += count_impact(m_ips.row_assessment(situation, move, dir[0], dir[1], other(color)), m_ips.m_weights);
+        }
+        return score;
+    }
+
+    Mcts::Mcts(Ips &ips)
+        : m_ips(ips), m_capacity(0), m_used(0), m_iterations(0), m_stop(false) {}
+
+    void Mcts::set_options(const MctsOptions &options)
+    {
+        m_options = options;
+    }
+
+    std::int32_t Mcts::allocate(int count)
+    {
+        const std::int32_t first = m_used.fetch_add(count);
+        if (first + count > m_options.max_nodes)
+        {
+            return -1;
+        }
+
+        for (int i = first; i < first + count; ++i)
+        {
+            Node &node = m_pool[i];
+            node.first_child = -1;
+            node.child_count = 0;
+            node.visits.store(0, std::memory_order_relaxed);
+            node.value.store(0, std::memory_order_relaxed);
+            node.state.store(0, std::memory_order_relaxed);
+        }
+        return first;
+    }
+
+    /**
+     * @brief Ходы сортируются по urgency, априорная вероятность
+     * убывает с рангом хода (1 / (ранг + 1)).
+     *
+     * Ходы, их оценки и ключи сортировки лежат в арене потока, поэтому
+     * раскрытие не обращается к куче.
+     */
+    void Mcts::expand(std::int32_t index, Core::Situation &situation, Core::Color color, SearchArena &arena)
+    {
+        Node &node = m_pool[index];
+
+        MoveList moves = arena.moves(0);
+        m_ips.generate_moves_smart(situation, color, arena, moves);
+
+        std::size_t blocks = 0;
+        bool won = false;
+        for (std::size_t i = 0; i < moves.size(); ++i)
+        {
+            if (wins_at(situation, moves[i].first, moves[i].second, color))
+            {
+                moves[0] = moves[i];
+                moves.truncate(1);
+                won = true;
+                break;
+            }
+            if (wins_at(situation, moves[i].first, moves[i].second, other(color)))
+            {
+                moves[blocks++] = moves[i];
+            }
+        }
+
+        // Соперник грозит пятеркой: остальные ходы проигрывают сразу
+        if (!won && blocks > 0)
+        {
+            moves.truncate(blocks);
+        }
+
+        const int count = std::min<int>(static_cast<int>(moves.size()), m_options.max_children);
+        const bool forced = won || blocks > 0;
+        std::uint64_t *keys = arena.keys();
+        for (std::size_t i = 0; i < moves.size(); ++i)
+        {
+            keys[i] = order_key(forced ? 0 : urgency(situation, moves[i], color), i);
+        }
+        std::partial_sort(keys, keys + count, keys + moves.size(), std::greater<std::uint64_t>());
+
+        const std::int32_t first = count > 0 ? allocate(count) : 0;
+        if (first < 0)
+        {
+            return; // пул исчерпан: state остается 1, и узел навсегда остается листом
+        }
+
+        double norm = 0;
+        for (int i = 0; i < count; ++i)
+            norm += 1.0 / (i + 1);
+
+        for (int i = 0; i < count; ++i)
+        {
+            const std::pair<int, int> move = moves[order_index(keys[i])];
+            Node &child = m_pool[first + i];
+            child.x = static_cast<std::int16_t>(move.first);
+            child.y = static_cast<std::int16_t>(move.second);
+            child.prior = static_cast<float>(1.0 / (i + 1) / norm);
+        }
+
+        node.first_child = first;
+        node.child_count = count;
+        node.state.store(2, std::memory_order_release);
+    }
+
+    std::int32_t Mcts::select(std::int32_t index) const
+    {
+        const Node &node = m_pool[index];
+        const double sqrt_visits = std::sqrt(static_cast<double>(
+            std::max(1, node.visits.load(std::memory_order_relaxed))));
+
+        std::int32_t best = node.first_child;
+        double best_score = -1e300;
+
+        for (std::int32_t i = node.first_child; i < node.first_child + node.child_count; ++i)
+        {
+            const Node &child = m_pool[i];
+            const std::int32_t visits = child.visits.load(std::memory_order_relaxed);
+            const double q = visits > 0
+                                 ? child.value.load(std::memory_order_relaxed) / (2.0 * visits)
+                                 : FIRST_PLAY_VALUE;
+            const double score = q + m_options.exploration * child.prior * sqrt_visits / (1 + visits);
+
+            if (score > best_score)
+            {
+                best_score = score;
+                best = i;
+            }
+        }
+        return best;
+    }
+
+    /**
+     * @brief Политика доигрывания.
+     *
+     * Кандидаты - пустые клетки рядом с последними ходами (каждая один
+     * раз, список в арене потока). Сначала
+     * проверяются выигрыш и блок пятерки соперника (по длинам серий за O(1)),
+     * иначе из нескольких случайных кандидатов выбирается лучший по
+     * urgency. Все ходы отменяются перед возвратом.
+     */
+    Core::Color Mcts::playout(Core::Situation &situation, Core::Color color, std::mt19937 &rng,
+                              SearchArena &arena) const
+    {
+        const auto &history = situation.get_history();
+        std::pair<int, int> recent[PLAYOUT_RECENT];
+        int recent_count = 0;
+        for (auto it = history.rbegin(); it != history.rend() && recent_count < PLAYOUT_RECENT; ++it)
+        {
+            recent[recent_count++] = *it;
+        }
+
+        const int size = situation.get_size();
+        MoveList candidates = arena.moves(0);
+        Core::Color winner = Core::Color::None;
+        int made = 0;
+
+        while (true)
+        {
+            candidates.clear();
+            arena.begin_marks();
+            for (int r = 0; r < recent_count; ++r)
+            {
+                for (int dy = -PLAYOUT_RADIUS; dy <= PLAYOUT_RADIUS; ++dy)
+                {
+                    for (int dx = -PLAYOUT_RADIUS; dx <= PLAYOUT_RADIUS; ++dx)
+                    {
+                        const int x = recent[r].first + dx;
+                        const int y = recent[r].second + dy;
+                        if (situation.is_within_bounds(x, y) && situation.is_empty(x, y) &&
+                            !(color == Core::Color::Black && situation.is_forbidden(x, y)) &&
+                            arena.mark(y * size + x))
+                        {
+                            candidates.push_back({x, y});
+                        }
+                    }
+                }
+            }
+            if (candidates.empty())
+            {
+                m_ips.generate_moves_smart(situation, color, arena, candidates);
+                if (candidates.empty())
+                    break; // ходов нет - ничья
+            }
+
+            std::pair<int, int> move{-1, -1};
+            for (const auto &c : candidates)
+            {
+                if (wins_at(situation, c.first, c.second, color))
+                {
+                    move = c;
+                    break;
+                }
+                if (move.first < 0 && wins_at(situation, c.first, c.second, other(color)))
+                    move = c;
+            }
+
+            if (move.first < 0)
+            {
+                std::uniform_int_distribution<std::size_t> pick(0, candidates.size() - 1);
+                int best_score = 0;
+                for (int s = 0; s < PLAYOUT_SAMPLE; ++s)
+                {
+                    const auto &c = candidates[pick(rng)];
+                    const int score = urgency(situation, c, color);
+                    if (move.first < 0 || score > best_score)
+                    {
+                        best_score = score;
+                        move = c;
+                    }
+                }
+            }
+
+            if (!situation.move(move.first, move.second, color))
+                break;
+            made++;
+
+            const int cw = situation.check_win(move.first, move.second);
+            if (cw == 1)
+            {
+                winner = color;
+                break;
+            }
+            if (cw == 2)
+                break;
+
+            std::move_backward(recent, recent + PLAYOUT_RECENT - 1, recent + PLAYOUT_RECENT);
+            recent[0] = move;
+            recent_count = std::min(recent_count + 1, PLAYOUT_RECENT);
+            color = other(color);
+        }
+
+        for (int i = 0; i < made; ++i)
+            situation.un_move();
+        return winner;
+    }
+
+    void Mcts::iterate(Core::Situation &situation, Core::Color root_color,
+                       std::vector<std::int32_t> &path, std::mt19937 &rng, SearchArena &arena)
+    {
+        const int virtual_loss = m_options.virtual_loss;
+        Core::Color color = root_color;
+        Core::Color winner = Core::Color::None;
+        bool terminal = false;
+        std::int32_t index = 0;
+        int made = 0;
+
+        path.clear();
+        path.push_back(0);
+        m_pool[0].visits.fetch_add(virtual_loss, std::memory_order_relaxed);
+
+        while (true)
+        {
+            Node &node = m_pool[index];
+
+            if (node.state.load(std::memory_order_acquire) != 2)
+            {
+                // Лист раскрывается, когда его уже посещал другой проход
+                std::uint8_t expected = 0;
+                if (node.visits.load(std::memory_order_relaxed) > virtual_loss &&
+                    node.state.compare_exchange_strong(expected, 1, std::memory_order_acq_rel))
+                {
+                    expand(index, situation, color, arena);
+                }
+                if (node.state.load(std::memory_order_acquire) != 2)
+                    break;
+            }
+
+            if (node.child_count == 0)
+            {
+                terminal = true; // ходов нет - ничья
+                break;
+            }
+
+            index = select(index);
+            Node &child = m_pool[index];
+            child.visits.fetch_add(virtual_loss, std::memory_order_relaxed);
+            path.push_back(index);
+
+            situation.move(child.x, child.y, color);
+            made++;
+
+            const int cw = situation.check_win(child.x, child.y);
+            if (cw != 0)
+            {
+                winner = (cw == 1) ? color : Core::Color::None;
+                terminal = true;
+                break;
+            }
+            color = other(color);
+        }
+
+        if (!terminal)
+        {
+            winner = playout(situation, color, rng, arena);
+        }
+
+        for (int i = 0; i < made; ++i)
+            situation.un_move();
+
+        // Ход в узел глубины d сделан root_color при нечетном d
+        for (std::size_t depth = 0; depth < path.size(); ++depth)
+        {
+            const Core::Color mover = (depth % 2 == 1) ? root_color : other(root_color);
+            const int result = (winner == Core::Color::None) ? 1 : (winner == mover ? 2 : 0);
+
+            Node &node = m_pool[path[depth]];
+            node.value.fetch_add(result, std::memory_order_relaxed);
+            node.visits.fetch_add(1 - virtual_loss, std::memory_order_relaxed);
+        }
+
+        m_iterations.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Mcts::Worker::Worker() : situation(0) {}
+
+    void Mcts::worker(Worker &state, Core::Color root_color, unsigned seed)
+    {
+        RENJU_TRACE_SCOPE("Mcts::worker");
+        std::mt19937 rng(seed);
+
+        while (!m_stop.load(std::memory_order_relaxed))
+        {
+            iterate(state.situation, root_color, state.path, rng, state.arena);
+
+            if (std::chrono::steady_clock::now() >= m_deadline ||
+                (m_options.max_iterations > 0 && m_iterations.load() >= m_options.max_iterations))
+            {
+                m_stop.store(true);
+            }
+        }
+    }
+
+    /**
+     * @brief Корень раскрывается до запуска потоков; если ход единственный
+     * (например, выигрывающий), он возвращается без поиска.
+     *
+     * Пул узлов и рабочие объекты потоков выделяются при первом поиске
+     * и растут только вместе с max_nodes, числом потоков и размером поля,
+     * поэтому следующие поиски обходятся без выделений (кроме самих потоков).
+     */
+    std::pair<int, int> Mcts::search(Core::Situation &situation, Core::Color color)
+    {
+        if (m_capacity < m_options.max_nodes)
+        {
+            m_pool.reset(new Node[m_options.max_nodes]);
+            m_capacity = m_options.max_nodes;
+        }
+        m_used = 0;
+        m_iterations = 0;
+        m_stop = false;
+        m_deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(m_options.time_ms);
+
+        int threads = m_options.threads;
+        if (threads <= 0)
+        {
+            const unsigned hw = std::thread::hardware_concurrency();
+            threads = hw ? static_cast<int>(hw) : 1;
+        }
+        if (static_cast<int>(m_workers.size()) < threads)
+        {
+            m_workers.resize(threads);
+        }
+
+        const int cells = situation.get_size() * situation.get_size();
+        for (int t = 0; t < threads; ++t)
+        {
+            m_workers[t].arena.reserve(1, cells);
+        }
+
+        const std::int32_t root = allocate(1);
+        m_pool[root].state.store(1);
+        expand(root, situation, color, m_workers[0].arena);
+
+        const Node &node = m_pool[root];
+        if (node.state.load() != 2 || node.child_count == 0)
+        {
+            return {-1, -1};
+        }
+        if (node.child_count == 1)
+        {
+            return {m_pool[node.first_child].x, m_pool[node.first_child].y};
+        }
+
+        // Копирование в ту же ситуацию переиспользует ее память
+        for (int t = 0; t < threads; ++t)
+        {
+            m_workers[t].situation = situation;
+        }
+
+        std::vector<std::thread> pool;
+        pool.reserve(threads - 1);
+        for (int t = 1; t < threads; ++t)
+        {
+            pool.emplace_back(&Mcts::worker, this, std::ref(m_workers[t]), color, m_options.seed + t);
+        }
+        worker(m_workers[0], color, m_options.seed);
+        for (auto &thread : pool)
+        {
+            thread.join();
+        }
+
+        std::int32_t best = node.first_child;
+        for (std::int32_t i = node.first_child; i < node.first_child + node.child_count; ++i)
+        {
+            if (m_pool[i].visits.load() > m_pool[best].visits.load())
+                best = i;
+        }
+        return {m_pool[best].x, m_pool[best].y};
+    }
+
+    std::int64_t Mcts::get_iterations() const
+    {
+        return m_iterations.load();
+    }
+
+} // namespace AI
@@ -0,0 +1,71 @@
+#include "solver/movelist.h"
+
+#include <algorithm>
+
+namespace AI
+{
+    SearchArena::SearchArena()
+        : m_plies(0), m_cells(0), m_stamp(0) {}
+
+    void SearchArena::reserve(int plies, int cells)
+    {
+        if (plies <= m_plies && cells <= m_cells)
+        {
+            return;
+        }
+
+        m_plies = std::max(plies, m_plies);
+        m_cells = std::max(cells, m_cells);
+        m_moves.assign(static_cast<std::size_t>(m_plies) * m_cells, {-1, -1});
+        m_flags.assign(static_cast<std::size_t>(m_plies) * m_cells, 0);
+        m_stones.assign(m_cells, {-1, -1});
+        m_scores.assign(m_cells, 0);
+        m_keys.assign(m_cells, 0);
+        m_marks.assign(m_cells, 0);
+        m_stamp = 0;
+    }
+
+    int SearchArena::plies() const
+    {
+        return m_plies;
+    }
+
+    MoveList SearchArena::moves(int ply)
+    {
+        return MoveList(m_moves.data() + static_cast<std::size_t>(ply) * m_cells, m_cells);
+    }
+
+    std::uint8_t *SearchArena::flags(int ply)
+    {
+        return m_flags.data() + static_cast<std::size_t>(ply) * m_cells;
+    }
+
+    MoveList SearchArena::stones()
+    {
+        return MoveList(m_stones.data(), m_cells);
+    }
+
+    int *SearchArena::scores()
+    {
+        return m_scores.data();
+    }
+
+    std::uint64_t *SearchArena::keys()
+    {
+        return m_keys.data();
+    }
+
+    /**
+     * @brief Метки не стираются: достаточно сменить номер отметки.
+     * Поле обнуляется, только когда номер переполняется.
+     */
+    void SearchArena::begin_marks()
+    {
+        if (++m_stamp == 0)
+        {
+            std::fill(m_marks.begin(), m_marks.end(), 0);
+            m_stamp = 1;
+        }
+    }
+
+} // namespace AI
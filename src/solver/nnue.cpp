@@ -0,0 +1,276 @@
+#include "solver/nnue.h"
+#include "core/notation.h"
+#include "core/simd.h"
+
+#include <cstring>
+#include <random>
+
+namespace AI::Nnue
+{
+    namespace
+    {
+        constexpr char MAGIC[4] = {'R', 'N', 'U', 'E'};
+        constexpr std::uint32_t VERSION = 1;
+
+        template <typename T>
+        bool read_array(std::ifstream &file, T *data, std::size_t count)
+        {
+            file.read(reinterpret_cast<char *>(data), static_cast<std::streamsize>(count * sizeof(T)));
+            return static_cast<bool>(file);
+        }
+
+        template <typename T>
+        void write_array(std::ofstream &file, const T *data, std::size_t count)
+        {
+            file.write(reinterpret_cast<const char *>(data), static_cast<std::streamsize>(count * sizeof(T)));
+        }
+    } // namespace
+
+    Network::Network()
+        : m_size(0), m_output_bias(0), m_scale(0) {}
+
+    /**
+     * @brief Загрузка сети.
+     *
+     * Данные читаются во временный объект, поэтому при ошибке текущая
+     * сеть не меняется.
+     */
+    bool Network::load(const std::string &path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+        {
+            return false;
+        }
+
+        char magic[4];
+        std::uint32_t header[3]; // версия, размер поля, HIDDEN
+        if (!read_array(file, magic, 4) || std::memcmp(magic, MAGIC, 4) != 0 ||
+            !read_array(file, header, 3) || header[0] != VERSION || header[2] != HIDDEN ||
+            header[1] == 0 || header[1] > 32)
+        {
+            return false;
+        }
+
+        Network loaded;
+        loaded.m_size = static_cast<int>(header[1]);
+        loaded.m_bias.resize(HIDDEN);
+        loaded.m_weights.resize(static_cast<std::size_t>(2 * loaded.m_size * loaded.m_size) * HIDDEN);
+        loaded.m_output.resize(2 * HIDDEN);
+
+        if (!read_array(file, loaded.m_bias.data(), loaded.m_bias.size()) ||
+            !read_array(file, loaded.m_weights.data(), loaded.m_weights.size()) ||
+            !read_array(file, loaded.m_output.data(), loaded.m_output.size()) ||
+            !read_array(file, &loaded.m_output_bias, 1) ||
+            !read_array(file, &loaded.m_scale, 1))
+        {
+            return false;
+        }
+
+        *this = std::move(loaded);
+        return true;
+    }
+
+    bool Network::save(const std::string &path) const
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        const std::uint32_t header[3] = {VERSION, static_cast<std::uint32_t>(m_size), HIDDEN};
+
+        write_array(file, MAGIC, 4);
+        write_array(file, header, 3);
+        write_array(file, m_bias.data(), m_bias.size());
+        write_array(file, m_weights.data(), m_weights.size());
+        write_array(file, m_output.data(), m_output.size());
+        write_array(file, &m_output_bias, 1);
+        write_array(file, &m_scale, 1);
+        return static_cast<bool>(file);
+    }
+
+    void Network::randomize(int size, unsigned seed)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_int_distribution<int> hidden(-24, 24);
+        std::uniform_int_distribution<int> output(-64, 64);
+
+        m_size = size;
+        m_bias.assign(HIDDEN, 32);
+        m_weights.resize(static_cast<std::size_t>(2 * size * size) * HIDDEN);
+        for (auto &w : m_weights)
+            w = static_cast<std::int16_t>(hidden(rng));
+        m_output.resize(2 * HIDDEN);
+        for (auto &w : m_output)
+            w = static_cast<std::int8_t>(output(rng));
+        m_output_bias = 0;
+        m_scale = 64;
+    }
+
+    int Network::get_size() const
+    {
+        return m_size;
+    }
+
+    int Network::feature(int x, int y, Core::Color stone, Core::Color view) const
+    {
+        const int cells = m_size * m_size;
+        return (stone == view ? 0 : cells) + y * m_size + x;
+    }
+
+    const std::int16_t *Network::column(int feature) const
+    {
+        return m_weights.data() + static_cast<std::size_t>(feature) * HIDDEN;
+    }
+
+    const std::int16_t *Network::bias() const
+    {
+        return m_bias.data();
+    }
+
+    int Network::propagate(const std::int16_t *us, const std::int16_t *them) const
+    {
+        const std::int64_t sum = m_output_bias +
+                                 Core::Simd::dot_crelu_i16_i8(us, m_output.data(), HIDDEN) +
+                                 Core::Simd::dot_crelu_i16_i8(them, m_output.data() + HIDDEN, HIDDEN);
+        return static_cast<int>((sum * m_scale) >> OUTPUT_SHIFT);
+    }
+
+    Evaluator::Evaluator()
+        : m_network(nullptr), m_top(0) {}
+
+    void Evaluator::set_network(const Network *network)
+    {
+        m_network = network;
+    }
+
+    bool Evaluator::ready(Core::Situation &situation) const
+    {
+        return m_network && m_network->get_size() == situation.get_size();
+    }
+
+    void Evaluator::reserve(int depth)
+    {
+        if (static_cast<int>(m_stack.size()) < depth + 1)
+        {
+            m_stack.resize(depth + 1);
+        }
+    }
+
+    /**
+     * @brief Полный пересчет: смещения плюс столбцы всех камней на поле.
+     */
+    void Evaluator::refresh(Core::Situation &situation)
+    {
+        if (m_stack.empty())
+        {
+            m_stack.resize(16);
+        }
+        m_top = 0;
+
+        Accumulator &acc = m_stack[0];
+        const int size = situation.get_size();
+
+        for (int view = Core::Color::White; view <= Core::Color::Black; ++view)
+        {
+            std::memcpy(acc.values[view], m_network->bias(), sizeof(acc.values[view]));
+
+            for (int y = 0; y < size; ++y)
+            {
+                for (int x = 0; x < size; ++x)
+                {
+                    const Core::Color stone = situation.get_stone_color(x, y);
+                    if (stone == Core::Color::None)
+                        continue;
+
+                    const int f = m_network->feature(x, y, stone, static_cast<Core::Color>(view));
+                    Core::Simd::add_i16(acc.values[view], acc.values[view], m_network->column(f), HIDDEN);
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Копирование с добавлением выполняется одним проходом Core::Simd::add_i16.
+     */
+    void Evaluator::push(int x, int y, Core::Color color)
+    {
+        if (m_top + 1 >= static_cast<int>(m_stack.size()))
+        {
+            m_stack.resize(m_stack.size() * 2);
+        }
+
+        const Accumulator &from = m_stack[m_top];
+        Accumulator &to = m_stack[++m_top];
+
+        for (int view = Core::Color::White; view <= Core::Color::Black; ++view)
+        {
+            const int f = m_network->feature(x, y, color, static_cast<Core::Color>(view));
+            Core::Simd::add_i16(to.values[view], from.values[view], m_network->column(f), HIDDEN);
+        }
+    }
+
+    void Evaluator::pop()
+    {
+        m_top--;
+    }
+
+    int Evaluator::evaluate(Core::Color color) const
+    {
+        const Accumulator &acc = m_stack[m_top];
+        const Core::Color other = (color == Core::Color::White) ? Core::Color::Black : Core::Color::White;
+        return m_network->propagate(acc.values[color], acc.values[other]);
+    }
+
+    TrainingExporter::TrainingExporter(const std::string &path)
+        : m_file(path, std::ios::app), m_written(0) {}
+
+    bool TrainingExporter::is_open() const
+    {
+        return m_file.is_open();
+    }
+
+    void TrainingExporter::write(Core::Situation &situation, Core::Color to_move, Core::Status result)
+    {
+        const char *score = "0.5";
+        if (result == Core::white_wins || result == Core::black_wins)
+        {
+            const Core::Color winner = (result == Core::white_wins) ? Core::Color::White : Core::Color::Black;
+            score = (winner == to_move) ? "1" : "0";
+        }
+
+        m_file << Core::Notation::to_string(situation, to_move) << '\t' << score << '\n';
+        m_written++;
+    }
+
+    /**
+     * @brief Партия отматывается на копии позиции до конца расстановки,
+     * после чего ходы повторяются с записью позиции перед каждым ходом.
+     */
+    void TrainingExporter::write_game(Core::Situation &final, int setup_moves, Core::Status result)
+    {
+        Core::Situation work = final;
+        const auto &history = final.get_history();
+
+        std::vector<std::pair<std::pair<int, int>, Core::Color>> moves;
+        for (std::size_t i = static_cast<std::size_t>(setup_moves); i < history.size(); ++i)
+        {
+            const auto [x, y] = history[i];
+            moves.push_back({history[i], final.get_stone_color(x, y)});
+        }
+
+        for (std::size_t i = 0; i < moves.size(); ++i)
+        {
+            work.un_move();
+        }
+
+        for (const auto &[move, color] : moves)
+        {
+            write(work, color, result);
+            work.move(move.first, move.second, color);
+        }
+    }
+
+    std::size_t TrainingExporter::written() const
+    {
+        return m_written;
+    }
+
+} // namespace AI::Nnue
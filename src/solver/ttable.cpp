@@ -0,0 +1,178 @@
+#include "solver/ttable.h"
+#include "core/constans.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace AI
+{
+    TranspositionTable::TranspositionTable(std::size_t megabytes)
+        : m_count(0), m_mask(0), m_age(0)
+    {
+        resize(megabytes);
+    }
+
+    static_assert(Core::Constants::MAX_BOARD_SIZE <= INT8_MAX,
+                  "Координаты хода упаковываются в байт со знаком");
+
+    /**
+     * @brief Упаковка: оценка - биты 0-31, глубина - 32-37, тип - 38-39,
+     * поколение - 40-47, ход - 48-63.
+     */
+    std::uint64_t TranspositionTable::pack(int score, int depth, Bound bound, std::uint8_t age, int x, int y)
+    {
+        const std::uint64_t d = static_cast<std::uint64_t>(std::clamp(depth, 0, 63));
+        return static_cast<std::uint32_t>(score) |
+               (d << 32) |
+               (static_cast<std::uint64_t>(bound) << 38) |
+               (static_cast<std::uint64_t>(age) << 40) |
+               (static_cast<std::uint64_t>(static_cast<std::uint8_t>(x)) << 48) |
+               (static_cast<std::uint64_t>(static_cast<std::uint8_t>(y)) << 56);
+    }
+
+    TTEntry TranspositionTable::unpack(std::uint64_t key, std::uint64_t data)
+    {
+        TTEntry entry;
+        entry.key = key;
+        entry.score = static_cast<std::int32_t>(static_cast<std::uint32_t>(data));
+        entry.depth = static_cast<std::int8_t>((data >> 32) & 63);
+        entry.bound = static_cast<Bound>((data >> 38) & 3);
+        entry.age = static_cast<std::uint8_t>(data >> 40);
+        entry.x = static_cast<std::int8_t>(data >> 48);
+        entry.y = static_cast<std::int8_t>(data >> 56);
+        return entry;
+    }
+
+    TTEntry TranspositionTable::read(const Slot &slot)
+    {
+        const std::uint64_t data = slot.data.load(std::memory_order_relaxed);
+        const std::uint64_t check = slot.check.load(std::memory_order_relaxed);
+        return unpack(check ^ data, data);
+    }
+
+    /**
+     * @brief Число корзин округляется вниз до степени двойки.
+     */
+    void TranspositionTable::resize(std::size_t megabytes)
+    {
+        m_age = 0;
+        if (megabytes == 0)
+        {
+            m_slots.reset();
+            m_count = 0;
+            m_mask = 0;
+            return;
+        }
+
+        const std::size_t bytes = megabytes << 20;
+        std::size_t buckets = 1;
+        while (buckets * 2 * BUCKET * sizeof(Slot) <= bytes)
+            buckets *= 2;
+
+        m_slots.reset(new Slot[buckets * BUCKET]);
+        m_count = buckets * BUCKET;
+        m_mask = buckets - 1;
+    }
+
+    bool TranspositionTable::empty() const
+    {
+        return m_count == 0;
+    }
+
+    void TranspositionTable::clear()
+    {
+        for (std::size_t i = 0; i < m_count; ++i)
+        {
+            m_slots[i].check.store(0, std::memory_order_relaxed);
+            m_slots[i].data.store(0, std::memory_order_relaxed);
+        }
+        m_age = 0;
+    }
+
+    void TranspositionTable::new_search()
+    {
+        m_age.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    bool TranspositionTable::probe(std::uint64_t key, TTEntry &entry) const
+    {
+        if (m_count == 0)
+            return false;
+
+        const Slot *bucket = &m_slots[(key & m_mask) * BUCKET];
+        for (int i = 0; i < BUCKET; ++i)
+        {
+            const TTEntry candidate = read(bucket[i]);
+            if (candidate.key == key && candidate.bound != Bound::None)
+            {
+                entry = candidate;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void TranspositionTable::store(std::uint64_t key, int depth, int score, Bound bound, int x, int y)
+    {
+        if (m_count == 0)
+            return;
+
+        const std::uint8_t current_age = m_age.load(std::memory_order_relaxed);
+        Slot *bucket = &m_slots[(key & m_mask) * BUCKET];
+        Slot *victim = &bucket[0];
+        TTEntry victim_entry = read(bucket[0]);
+        int victim_value = 1 << 30;
+
+        for (int i = 0; i < BUCKET; ++i)
+        {
+            const TTEntry entry = read(bucket[i]);
+            if (entry.key == key || entry.bound == Bound::None)
+            {
+                // Более мелкий результат не затирает глубокий результат этого же поиска
+                if (entry.key == key && entry.age == current_age && entry.depth > depth && bound != Bound::Exact)
+                    return;
+                victim = &bucket[i];
+                victim_entry = entry;
+                break;
+            }
+
+            const int age = static_cast<std::uint8_t>(current_age - entry.age);
+            const int value = entry.depth - 2 * age;
+            if (value < victim_value)
+            {
+                victim_value = value;
+                victim = &bucket[i];
+                victim_entry = entry;
+            }
+        }
+
+        // Лучший ход сохраняется, если новый результат его не знает
+        if (x < 0 && victim_entry.key == key)
+        {
+            x = victim_entry.x;
+            y = victim_entry.y;
+        }
+
+        const std::uint64_t data = pack(score, depth, bound, current_age, x, y);
+        victim->data.store(data, std::memory_order_relaxed);
+        victim->check.store(key ^ data, std::memory_order_relaxed);
+    }
+
+    int TranspositionTable::hashfull() const
+    {
+        if (m_count == 0)
+            return 0;
+
+        const std::uint8_t current_age = m_age.load(std::memory_order_relaxed);
+        const std::size_t count = std::min<std::size_t>(1000, m_mask + 1) * BUCKET;
+        int used = 0;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const TTEntry entry = read(m_slots[i]);
+            if (entry.bound != Bound::None && entry.age == current_age)
+                used++;
+        }
+        return static_cast<int>(used * 1000 / count);
+    }
+
+} // namespace AI
@@ -0,0 +1,468 @@
+#include "storage/record.h"
+
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace Storage
+{
+    namespace
+    {
+        constexpr char DATA_MAGIC[8] = {'R', 'N', 'J', 'R', 'E', 'C', '0', '1'};
+        constexpr char INDEX_MAGIC[8] = {'R', 'N', 'J', 'I', 'D', 'X', '0', '1'};
+        constexpr std::size_t DATA_HEADER_SIZE = 16;
+        constexpr std::size_t INDEX_HEADER_SIZE = sizeof(INDEX_MAGIC);
+
+        std::uint64_t file_size(const std::string &path)
+        {
+            std::ifstream file(path, std::ios::binary | std::ios::ate);
+            return file ? static_cast<std::uint64_t>(file.tellg()) : 0;
+        }
+
+        void write_u64(std::ofstream &out, std::uint64_t value)
+        {
+            std::uint8_t bytes[8];
+            for (int i = 0; i < 8; ++i)
+            {
+                bytes[i] = static_cast<std::uint8_t>(value >> (8 * i));
+            }
+            out.write(reinterpret_cast<const char *>(bytes), sizeof(bytes));
+        }
+
+        bool known_player(std::uint8_t kind)
+        {
+            return kind == static_cast<std::uint8_t>(PlayerKind::Human) ||
+                   kind == static_cast<std::uint8_t>(PlayerKind::Engine) ||
+                   kind == static_cast<std::uint8_t>(PlayerKind::Unknown);
+        }
+
+        std::uint64_t read_u64(const std::uint8_t *bytes)
+        {
+            std::uint64_t value = 0;
+            for (int i = 7; i >= 0; --i)
+            {
+                value = (value << 8) | bytes[i];
+            }
+            return value;
+        }
+    } // namespace
+
+    /**
+     * @brief Сборка записи партии из истории ситуации.
+     *
+     * Начальная расстановка сортируется по цветам (белые, затем черные),
+     * ходы партии должны чередоваться по цвету.
+     */
+    bool GameRecord::assign(Core::Situation &situation, int setup_moves,
+                            PlayerKind white, PlayerKind black, Core::Status result)
+    {
+        const auto &history = situation.get_history();
+        const int size = situation.get_size();
+
+        if (size > MAX_RECORD_SIZE || setup_moves > static_cast<int>(history.size()))
+        {
+            return false;
+        }
+
+        header = RecordHeader{};
+        header.size = static_cast<std::uint8_t>(size);
+        header.rules = static_cast<std::uint8_t>(situation.get_rules());
+        header.white_player = static_cast<std::uint8_t>(white);
+        header.black_player = static_cast<std::uint8_t>(black);
+        header.result = static_cast<std::uint8_t>(result);
+
+        body.clear();
+        body.reserve(history.size());
+
+        for (Core::Color color : {Core::Color::White, Core::Color::Black})
+        {
+            for (int i = 0; i < setup_moves; ++i)
+            {
+                auto [x, y] = history[i];
+                if (situation.get_stone_color(x, y) == color)
+                {
+                    body.push_back(GameView::encode(x, y));
+                    (color == Core::Color::White ? header.setup_white : header.setup_black)++;
+                }
+            }
+        }
+
+        const int move_count = static_cast<int>(history.size()) - setup_moves;
+        header.move_count_lo = static_cast<std::uint8_t>(move_count & 0xFF);
+        header.move_count_hi = static_cast<std::uint8_t>(move_count >> 8);
+
+        Core::Color expected = Core::Color::None;
+        for (int i = setup_moves; i < static_cast<int>(history.size()); ++i)
+        {
+            auto [x, y] = history[i];
+            Core::Color color = situation.get_stone_color(x, y);
+
+            if (expected == Core::Color::None)
+            {
+                if (color == Core::Color::Black)
+                {
+                    header.flags |= RecordHeader::FLAG_BLACK_FIRST;
+                }
+            }
+            else if (color != expected)
+            {
+                return false;
+            }
+            expected = (color == Core::Color::White) ? Core::Color::Black : Core::Color::White;
+            body.push_back(GameView::encode(x, y));
+        }
+
+        return true;
+    }
+
+    bool RecordHeader::is_valid() const
+    {
+        return size > 0 && size <= MAX_RECORD_SIZE &&
+               rules <= Core::renju &&
+               result <= Core::ongoing &&
+               (flags & ~FLAG_BLACK_FIRST) == 0 &&
+               known_player(white_player) && known_player(black_player) &&
+               setup_count() + move_count() <= size * size;
+    }
+
+    Core::Color GameView::first_color() const
+    {
+        return (header->flags & RecordHeader::FLAG_BLACK_FIRST) ? Core::Color::Black : Core::Color::White;
+    }
+
+    Core::Color GameView::move_color(int index) const
+    {
+        Core::Color first = first_color();
+        if (index % 2 == 0)
+        {
+            return first;
+        }
+        return first == Core::Color::White ? Core::Color::Black : Core::Color::White;
+    }
+
+    /**
+     * @brief Переигрывание партии.
+     *
+     * Камни расстановки ставятся через Situation::move, поэтому производные
+     * структуры ситуации (битовые маски, длины серий) остаются согласованными.
+     * Расстановка не обязана соблюдать запреты рэндзю, поэтому ставится по
+     * свободным правилам; ходы партии проверяются уже по правилам записи.
+     */
+    bool GameView::replay(Core::Situation &situation, int moves) const
+    {
+        situation.reset(header->size);
+        situation.set_rules(Core::freestyle);
+
+        for (int i = 0; i < header->setup_count(); ++i)
+        {
+            auto [x, y] = decode(setup[i]);
+            Core::Color color = (i < header->setup_white) ? Core::Color::White : Core::Color::Black;
+            if (!situation.move(x, y, color))
+            {
+                return false;
+            }
+        }
+        situation.set_rules(static_cast<Core::Rules>(header->rules));
+
+        const int count = (moves < 0 || moves > move_count()) ? move_count() : moves;
+        for (int i = 0; i < count; ++i)
+        {
+            auto [x, y] = decode(this->moves[i]);
+            if (!situation.move(x, y, move_color(i)))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Открывает файл данных и индекс на дозапись.
+     *
+     * Новый файл получает заголовок с сигнатурой. Смещение следующей
+     * записи определяется по текущему размеру файла данных. Индекс без
+     * файла данных устарел и начинается заново; файл данных без индекса
+     * индексируется заново.
+     */
+    RecordWriter::RecordWriter(const std::string &path)
+    {
+        const std::string index_path = path + ".idx";
+        m_offset = file_size(path);
+        const std::uint64_t index_size = file_size(index_path);
+
+        if (m_offset > 0 && index_size == 0)
+        {
+            m_index.open(index_path, std::ios::binary | std::ios::trunc);
+            m_index.write(INDEX_MAGIC, sizeof(INDEX_MAGIC));
+            if (!rebuild_index(path))
+            {
+                m_index.close();
+                std::remove(index_path.c_str());
+                return;
+            }
+        }
+        else
+        {
+            const auto mode = m_offset == 0 ? std::ios::binary | std::ios::trunc : std::ios::binary | std::ios::app;
+            m_index.open(index_path, mode);
+            if (m_offset == 0 || index_size == 0)
+            {
+                m_index.write(INDEX_MAGIC, sizeof(INDEX_MAGIC));
+            }
+        }
+
+        m_data.open(path, std::ios::binary | std::ios::app);
+        if (m_offset == 0)
+        {
+            char header[DATA_HEADER_SIZE] = {};
+            std::memcpy(header, DATA_MAGIC, sizeof(DATA_MAGIC));
+            m_data.write(header, sizeof(header));
+            m_offset = DATA_HEADER_SIZE;
+        }
+    }
+
+    /**
+     * @brief Последовательный проход по записям файла данных.
+     *
+     * Запись должна заканчиваться ровно на конце файла: дописывать после
+     * обрезанной или поврежденной записи нельзя, последовательное чтение
+     * остановилось бы на ней.
+     */
+    bool RecordWriter::rebuild_index(const std::string &path)
+    {
+        std::ifstream data(path, std::ios::binary);
+        char magic[DATA_HEADER_SIZE];
+        if (!data.read(magic, sizeof(magic)) || std::memcmp(magic, DATA_MAGIC, sizeof(DATA_MAGIC)) != 0)
+        {
+            return false;
+        }
+
+        std::uint64_t offset = DATA_HEADER_SIZE;
+        RecordHeader header;
+        while (offset < m_offset)
+        {
+            if (!data.read(reinterpret_cast<char *>(&header), sizeof(header)) || !header.is_valid() ||
+                offset + header.record_size() > m_offset)
+            {
+                return false;
+            }
+            write_u64(m_index, offset);
+            offset += header.record_size();
+            data.seekg(static_cast<std::streamoff>(offset));
+        }
+        return static_cast<bool>(m_index);
+    }
+
+    bool RecordWriter::is_open() const
+    {
+        return m_data.is_open() && m_index.is_open();
+    }
+
+    bool RecordWriter::append(const GameRecord &record)
+    {
+        if (!is_open())
+        {
+            return false;
+        }
+
+        m_data.write(reinterpret_cast<const char *>(&record.header), sizeof(RecordHeader));
+        m_data.write(reinterpret_cast<const char *>(record.body.data()),
+                     static_cast<std::streamsize>(record.body.size()));
+        write_u64(m_index, m_offset);
+
+        m_offset += sizeof(RecordHeader) + record.body.size();
+        return static_cast<bool>(m_data) && static_cast<bool>(m_index);
+    }
+
+    void RecordWriter::flush()
+    {
+        m_data.flush();
+        m_index.flush();
+    }
+
+    /**
+     * @brief Отображает файл в память только для чтения.
+     *
+     * @return Пустое отображение, если файл не открылся или пуст.
+     */
+    RecordReader::Mapping RecordReader::map_file(const std::string &path)
+    {
+        Mapping mapping;
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            return mapping;
+        }
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+        {
+            CloseHandle(file);
+            return mapping;
+        }
+        HANDLE map = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!map)
+        {
+            CloseHandle(file);
+            return mapping;
+        }
+        mapping.data = static_cast<const std::uint8_t *>(MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0));
+        mapping.size = static_cast<std::size_t>(size.QuadPart);
+        mapping.file = file;
+        mapping.map = map;
+#else
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            return mapping;
+        }
+        struct stat info;
+        if (fstat(fd, &info) == 0 && info.st_size > 0)
+        {
+            void *data = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+            if (data != MAP_FAILED)
+            {
+                madvise(data, static_cast<std::size_t>(info.st_size), MADV_SEQUENTIAL);
+                mapping.data = static_cast<const std::uint8_t *>(data);
+                mapping.size = static_cast<std::size_t>(info.st_size);
+            }
+        }
+        close(fd);
+#endif
+        return mapping;
+    }
+
+    void RecordReader::unmap(Mapping &mapping)
+    {
+#ifdef _WIN32
+        if (mapping.data)
+            UnmapViewOfFile(mapping.data);
+        if (mapping.map)
+            CloseHandle(mapping.map);
+        if (mapping.file)
+            CloseHandle(mapping.file);
+#else
+        if (mapping.data)
+            munmap(const_cast<std::uint8_t *>(mapping.data), mapping.size);
+#endif
+        mapping = Mapping{};
+    }
+
+    RecordReader::RecordReader(const std::string &path)
+    {
+        m_data = map_file(path);
+        if (m_data.size < DATA_HEADER_SIZE || std::memcmp(m_data.data, DATA_MAGIC, sizeof(DATA_MAGIC)) != 0)
+        {
+            unmap(m_data);
+            return;
+        }
+
+        m_index = map_file(path + ".idx");
+        if (m_index.size < INDEX_HEADER_SIZE || std::memcmp(m_index.data, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0)
+        {
+            unmap(m_index);
+        }
+    }
+
+    RecordReader::~RecordReader()
+    {
+        unmap(m_data);
+        unmap(m_index);
+    }
+
+    bool RecordReader::is_open() const
+    {
+        return m_data.data != nullptr;
+    }
+
+    std::size_t RecordReader::indexed_count() const
+    {
+        if (!m_index.data)
+        {
+            return 0;
+        }
+        return (m_index.size - INDEX_HEADER_SIZE) / sizeof(std::uint64_t);
+    }
+
+    std::optional<GameView> RecordReader::at(std::size_t index) const
+    {
+        if (index >= indexed_count())
+        {
+            return std::nullopt;
+        }
+        const std::uint64_t offset = read_u64(m_index.data + INDEX_HEADER_SIZE + index * sizeof(std::uint64_t));
+        if (offset < DATA_HEADER_SIZE || offset >= m_data.size)
+        {
+            return std::nullopt;
+        }
+
+        const iterator it(m_data.data + offset, m_data.data + m_data.size);
+        if (!(it != end()))
+        {
+            return std::nullopt;
+        }
+        return *it;
+    }
+
+    RecordReader::iterator RecordReader::begin() const
+    {
+        if (!is_open())
+        {
+            return end();
+        }
+        return iterator(m_data.data + DATA_HEADER_SIZE, m_data.data + m_data.size);
+    }
+
+    RecordReader::iterator RecordReader::end() const
+    {
+        const std::uint8_t *end = m_data.data ? m_data.data + m_data.size : nullptr;
+        return iterator(end, end);
+    }
+
+    /**
+     * @brief Итератор сразу проверяет заголовок записи и то, что запись
+     * целиком помещается в файл.
+     *
+     * Обрезанная последняя запись (например, после аварийного завершения
+     * записи) или поврежденный заголовок считаются концом файла.
+     */
+    RecordReader::iterator::iterator(const std::uint8_t *pos, const std::uint8_t *end)
+        : m_pos(pos), m_end(end)
+    {
+        if (m_pos != m_end)
+        {
+            const auto *header = reinterpret_cast<const RecordHeader *>(m_pos);
+            if (static_cast<std::size_t>(m_end - m_pos) < sizeof(RecordHeader) || !header->is_valid() ||
+                static_cast<std::size_t>(m_end - m_pos) < header->record_size())
+            {
+                m_pos = m_end;
+            }
+        }
+    }
+
+    GameView RecordReader::iterator::operator*() const
+    {
+        GameView view;
+        view.header = reinterpret_cast<const RecordHeader *>(m_pos);
+        view.setup = m_pos + sizeof(RecordHeader);
+        view.moves = view.setup + view.header->setup_count();
+        return view;
+    }
+
+    RecordReader::iterator &RecordReader::iterator::operator++()
+    {
+        const auto *header = reinterpret_cast<const RecordHeader *>(m_pos);
+        *this = iterator(m_pos + header->record_size(), m_end);
+        return *this;
+    }
+
+} // namespace Storage
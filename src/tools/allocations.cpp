@@ -0,0 +1,82 @@
+#include "tools/allocations.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Замена глобальных operator new собирается только с опцией
+// RENJU_COUNT_ALLOCATIONS: атомарный счетчик на каждое выделение
+// не нужен серверу, хосту партий и разметке.
+#ifdef RENJU_COUNT_ALLOCATIONS
+
+namespace
+{
+    std::atomic<std::uint64_t> g_allocations{0};
+
+    void *allocate(std::size_t size)
+    {
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+        if (void *ptr = std::malloc(size ? size : 1))
+        {
+            return ptr;
+        }
+        throw std::bad_alloc();
+    }
+
+    void *allocate_aligned(std::size_t size, std::align_val_t align)
+    {
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+        const std::size_t alignment = static_cast<std::size_t>(align);
+        const std::size_t rounded = (size + alignment - 1) / alignment * alignment;
+        if (void *ptr = std::aligned_alloc(alignment, rounded ? rounded : alignment))
+        {
+            return ptr;
+        }
+        throw std::bad_alloc();
+    }
+} // namespace
+
+namespace Tools
+{
+    bool allocation_counting()
+    {
+        return true;
+    }
+
+    std::uint64_t allocation_count()
+    {
+        return g_allocations.load(std::memory_order_relaxed);
+    }
+} // namespace Tools
+
+// Формы nothrow стандартная библиотека реализует через эти функции.
+void *operator new(std::size_t size) { return allocate(size); }
+void *operator new[](std::size_t size) { return allocate(size); }
+void *operator new(std::size_t size, std::align_val_t align) { return allocate_aligned(size, align); }
+void *operator new[](std::size_t size, std::align_val_t align) { return allocate_aligned(size, align); }
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete[](void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+
+#else
+
+namespace Tools
+{
+    bool allocation_counting()
+    {
+        return false;
+    }
+
+    std::uint64_t allocation_count()
+    {
+        return 0;
+    }
+} // namespace Tools
+
+#endif
@@ -0,0 +1,365 @@
+#include "tools/annotate.h"
+#include "solver/ips.h"
+#include "solver/ttable.h"
+#include "storage/record.h"
+#include "utils/thread_pool.h"
+#include "utils/trace.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Tools
+{
+    namespace
+    {
+        /**
+         * @brief Оценка хода по результату поиска соперника после него:
+         * оценка выигрыша сдвигается на ход (AI::shift_mate).
+         */
+        int score_after(int opponent_score)
+        {
+            return AI::shift_mate(-opponent_score, 1);
+        }
+
+        /**
+         * @brief Зевок: упущенный выигрыш, ход в проигрыш или потеря
+         * оценки не меньше threshold.
+         */
+        bool is_blunder(int best_score, int score, int threshold)
+        {
+            const bool missed_win = best_score >= AI::MATE_BOUND && score < AI::MATE_BOUND;
+            const bool into_loss = best_score > -AI::MATE_BOUND && score <= -AI::MATE_BOUND;
+            return missed_win || into_loss || best_score - score >= threshold;
+        }
+
+        /**
+         * @brief Партий в работе на поток: ограничивает память под
+         * готовую, но еще не выведенную разметку.
+         */
+        constexpr std::size_t WINDOW_PER_THREAD = 4;
+
+        /**
+         * @brief Рабочие объекты одного потока пула.
+         */
+        struct Worker
+        {
+            Core::Situation situation;
+            AI::Ips white;
+            AI::Ips black;
+
+            Worker(const AnnotateOptions &options, AI::TranspositionTable &table)
+                : situation(Core::Constants::FIELD_SIZE), white(Core::Color::White), black(Core::Color::Black)
+            {
+                for (AI::Ips *engine : {&white, &black})
+                {
+                    engine->set_algorithm(Core::Constants::SearchAlgo::AlphaBeta);
+                    engine->set_shared_table(&table);
+                    engine->set_search_limits(options.depth, options.time_ms);
+                }
+            }
+
+            AI::Ips &engine(Core::Color color) { return color == Core::Color::White ? white : black; }
+        };
+
+        /**
+         * @brief Разметка одной партии.
+         */
+        struct GameNotes
+        {
+            std::string text;
+            std::uint64_t positions = 0;
+            std::uint64_t nodes = 0;
+            std::uint64_t blunders = 0;
+            bool corrupt = false;
+        };
+
+        struct MoveNotes
+        {
+            std::pair<int, int> best{-1, -1};
+            int best_score = 0;
+            int score = 0;   ///< Оценка сделанного хода.
+            bool scored = false;
+        };
+
+        const char *result_name(std::uint8_t result)
+        {
+            switch (result)
+            {
+            case Core::white_wins:
+                return "white_wins";
+            case Core::black_wins:
+                return "black_wins";
+            case Core::draw:
+                return "draw";
+            default:
+                return "ongoing";
+            }
+        }
+
+        /**
+         * @brief Поиск в текущей позиции движком color.
+         */
+        std::pair<int, int> search(Worker &worker, Core::Color color, int &score, GameNotes &notes)
+        {
+            AI::Ips &engine = worker.engine(color);
+            const std::uint64_t nodes = engine.get_nodes();
+            const std::pair<int, int> move = engine.get_move(worker.situation);
+            score = engine.get_last_score();
+            notes.nodes += engine.get_nodes() - nodes;
+            notes.positions++;
+            return move;
+        }
+
+        /**
+         * @brief Переигрывает партию, выполняя поиск перед каждым ходом.
+         *
+         * Оценка хода i - это оценка позиции после него с точки зрения
+         * соперника с обратным знаком, то есть результат поиска перед
+         * ходом i + 1. Поэтому на партию из m ходов приходится m поисков
+         * (и еще один, если партия не закончилась пятеркой или ничьей).
+         */
+        GameNotes annotate_game(const Storage::GameView &game, std::size_t index, const AnnotateOptions &options,
+                                Worker &worker)
+        {
+            RENJU_TRACE_SCOPE("annotate::game");
+            GameNotes notes;
+            const int count = game.move_count();
+            std::vector<MoveNotes> moves(count);
+
+            Core::Situation &situation = worker.situation;
+            worker.white.clear_memory();
+            worker.black.clear_memory();
+
+            bool valid = game.replay(situation, 0);
+            bool finished = false;
+            int played = 0;
+
+            for (int i = 0; valid && !finished && i < count; ++i)
+            {
+                const Core::Color color = game.move_color(i);
+                moves[i].best = search(worker, color, moves[i].best_score, notes);
+                if (i > 0)
+                {
+                    moves[i - 1].score = score_after(moves[i].best_score);
+                    moves[i - 1].scored = true;
+                }
+
+                const auto [x, y] = Storage::GameView::decode(game.moves[i]);
+                valid = situation.move(x, y, color);
+                if (!valid)
+                {
+                    break;
+                }
+                played++;
+
+                const int status = situation.check_win(x, y);
+                if (status != 0)
+                {
+                    moves[i].score = status == 1 ? AI::win_in(1) : 0;
+                    moves[i].scored = true;
+                    finished = true;
+                }
+            }
+
+            if (!valid || played < count)
+            {
+                notes.corrupt = true;
+                notes.text = "game " + std::to_string(index) + " corrupt\n";
+                return notes;
+            }
+
+            // Последний ход без пятерки оценивается поиском соперника
+            if (count > 0 && !moves[count - 1].scored)
+            {
+                int score = 0;
+                const Core::Color next = game.move_color(count);
+                search(worker, next, score, notes);
+                moves[count - 1].score = score_after(score);
+            }
+
+            std::ostringstream body;
+            int blunders[2] = {0, 0};
+            for (int i = 0; i < count; ++i)
+            {
+                const Core::Color color = game.move_color(i);
+                const auto [x, y] = Storage::GameView::decode(game.moves[i]);
+                const MoveNotes &move = moves[i];
+                const bool best = move.best == std::make_pair(x, y);
+                const bool blunder = !best && is_blunder(move.best_score, move.score, options.blunder);
+
+                body << "move " << (i + 1) << ' ' << (color == Core::Color::White ? 'w' : 'b') << ' '
+                     << x << ' ' << y << " score " << move.score
+                     << " best " << move.best.first << ' ' << move.best.second << ' ' << move.best_score;
+                if (blunder)
+                {
+                    body << " blunder";
+                    blunders[color == Core::Color::White ? 0 : 1]++;
+                }
+                body << '\n';
+            }
+
+            std::ostringstream head;
+            head << "game " << index << " size " << static_cast<int>(game.header->size)
+                 << " result " << result_name(game.header->result) << " moves " << count
+                 << " blunders " << blunders[0] << ' ' << blunders[1] << '\n';
+
+            notes.blunders = blunders[0] + blunders[1];
+            notes.text = head.str() + body.str();
+            return notes;
+        }
+    } // namespace
+
+    AnnotateStats annotate_records(const AnnotateOptions &options, std::ostream &out)
+    {
+        AnnotateStats stats;
+        Storage::RecordReader reader(options.input);
+        if (!reader.is_open())
+        {
+            return stats;
+        }
+
+        std::vector<Storage::GameView> games;
+        for (const Storage::GameView &game : reader)
+        {
+            if (options.games >= 0 && static_cast<long long>(games.size()) >= options.games)
+            {
+                break;
+            }
+            games.push_back(game);
+        }
+
+        AI::TranspositionTable table(options.hash_mb);
+        std::mutex mutex;
+        std::condition_variable ready_cv;
+        std::unordered_map<std::size_t, GameNotes> ready; ///< Готовые, но еще не выведенные (под mutex).
+        std::vector<std::unique_ptr<Worker>> workers;
+
+        // Пул объявлен последним: его потоки пользуются объектами выше
+        Utils::WorkStealingPool pool(options.threads);
+        for (int i = 0; i < pool.size(); ++i)
+        {
+            workers.push_back(std::make_unique<Worker>(options, table));
+        }
+
+        const std::size_t window = WINDOW_PER_THREAD * static_cast<std::size_t>(pool.size());
+        std::size_t submitted = 0;
+        const auto start = std::chrono::steady_clock::now();
+
+        // Партии выводятся по порядку; следующие ставятся в пул, пока
+        // впереди выводимой не больше window партий
+        for (std::size_t next = 0; next < games.size(); ++next)
+        {
+            for (; submitted < games.size() && submitted < next + window; ++submitted)
+            {
+                pool.submit([&, index = submitted]
+                            {
+                                table.new_search();
+                                GameNotes notes = annotate_game(games[index], index, options,
+                                                                *workers[pool.current_index()]);
+                                {
+                                    std::lock_guard<std::mutex> lock(mutex);
+                                    ready.emplace(index, std::move(notes));
+                                }
+                                ready_cv.notify_all(); });
+            }
+
+            GameNotes notes;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                ready_cv.wait(lock, [&]
+                              { return ready.count(next) > 0; });
+                notes = std::move(ready[next]);
+                ready.erase(next);
+            }
+
+            out << notes.text;
+            out.flush();
+            stats.positions += notes.positions;
+            stats.nodes += notes.nodes;
+            stats.blunders += notes.blunders;
+            if (notes.corrupt)
+                stats.corrupt++;
+            else
+                stats.games++;
+        }
+
+        stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return stats;
+    }
+
+    int annotate_main(int argc, char **argv)
+    {
+        AnnotateOptions options;
+        std::string output;
+
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string arg = argv[i];
+            const bool has_value = i + 1 < argc;
+
+            if (arg == "--in" && has_value)
+                options.input = argv[++i];
+            else if (arg == "--out" && has_value)
+                output = argv[++i];
+            else if (arg == "--threads" && has_value)
+                options.threads = std::stoi(argv[++i]);
+            else if (arg == "--hash" && has_value)
+                options.hash_mb = static_cast<std::size_t>(std::stoul(argv[++i]));
+            else if (arg == "--depth" && has_value)
+                options.depth = std::stoi(argv[++i]);
+            else if (arg == "--time" && has_value)
+                options.time_ms = std::stoi(argv[++i]);
+            else if (arg == "--blunder" && has_value)
+                options.blunder = std::stoi(argv[++i]);
+            else if (arg == "--games" && has_value)
+                options.games = std::stoll(argv[++i]);
+            else
+            {
+                std::cerr << "Неизвестный параметр: " << arg << std::endl;
+                return 1;
+            }
+        }
+
+        if (options.input.empty())
+        {
+            std::cerr << "Не задан файл записей (--in)" << std::endl;
+            return 1;
+        }
+        if (!Storage::RecordReader(options.input).is_open())
+        {
+            std::cerr << "Не удалось открыть файл записей: " << options.input << std::endl;
+            return 1;
+        }
+
+        std::ofstream file;
+        if (!output.empty())
+        {
+            file.open(output);
+            if (!file)
+            {
+                std::cerr << "Не удалось открыть файл: " << output << std::endl;
+                return 1;
+            }
+        }
+        std::ostream &out = output.empty() ? std::cout : file;
+
+        const AnnotateStats stats = annotate_records(options, out);
+        out.flush();
+
+        std::cerr << "Партий: " << stats.games << " (повреждено " << stats.corrupt << "), позиций: "
+                  << stats.positions << ", зевков: " << stats.blunders << " за " << stats.seconds
+                  << " с; позиций в секунду: " << static_cast<std::uint64_t>(stats.positions_per_second())
+                  << ", узлов: " << stats.nodes << std::endl;
+        return 0;
+    }
+
+} // namespace Tools
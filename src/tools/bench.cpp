@@ -0,0 +1,302 @@
+#include "tools/bench.h"
+#include "tools/allocations.h"
+#include "core/notation.h"
+#include "core/unbounded.h"
+#include "utils/trace.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <vector>
+
+namespace Tools
+{
+    namespace
+    {
+        struct Position
+        {
+            Core::Situation board;
+            Core::Color to_move;
+        };
+
+        /**
+         * @brief Случайные позиции середины партии без готовых пятерок.
+         *
+         * Камни ставятся поочередно в квадрате 7x7 вокруг центра, поэтому
+         * позиции похожи на реальные и поиск в них не вырождается.
+         */
+        std::vector<Position> random_positions(const BenchOptions &options)
+        {
+            std::vector<Position> positions;
+            std::mt19937_64 rng(options.seed);
+
+            const int size = options.board_size;
+            const int span = size < 7 ? size : 7;
+            const int low = (size - span) / 2;
+            std::uniform_int_distribution<int> cell(0, span - 1);
+            std::uniform_int_distribution<int> count(4, 10);
+
+            while (static_cast<int>(positions.size()) < options.positions)
+            {
+                Core::Situation board(size);
+                Core::Color color = Core::Color::White;
+                bool finished = false;
+
+                for (int n = count(rng); n > 0 && !finished; --n)
+                {
+                    int x, y;
+                    do
+                    {
+                        x = low + cell(rng);
+                        y = low + cell(rng);
+                    } while (!board.is_empty(x, y));
+
+                    board.move(x, y, color);
+                    finished = board.check_win(x, y) != 0;
+                    color = (color == Core::Color::White) ? Core::Color::Black : Core::Color::White;
+                }
+
+                if (!finished)
+                {
+                    positions.push_back({board, color});
+                }
+            }
+            return positions;
+        }
+
+        std::vector<Position> load_positions(const BenchOptions &options)
+        {
+            if (options.positions_file.empty())
+            {
+                return random_positions(options);
+            }
+
+            std::vector<Position> positions;
+            Core::Notation::load(options.positions_file, [&](Core::Situation &board, Core::Color to_move)
+                                 { positions.push_back({board, to_move}); });
+            return positions;
+        }
+
+        /**
+         * @brief Позиции random_positions на неограниченном поле.
+         *
+         * Позиции строятся на поле 15x15 и переносятся с большим сдвигом:
+         * абсолютные координаты камней не влияют на поиск.
+         */
+        std::vector<Position> unbounded_positions(const BenchOptions &options)
+        {
+            constexpr int SHIFT = 1000000;
+            BenchOptions base = options;
+            base.board_size = 15;
+
+            std::vector<Position> positions;
+            for (Position &position : random_positions(base))
+            {
+                Core::UnboundedSituation board;
+                Core::Color color = Core::Color::White;
+                for (const auto &[x, y] : position.board.get_history())
+                {
+                    board.move(x + SHIFT, y + SHIFT, color);
+                    color = (color == Core::Color::White) ? Core::Color::Black : Core::Color::White;
+                }
+                positions.push_back({board.window(), position.to_move});
+            }
+            return positions;
+        }
+
+        /**
+         * @brief Замер: каждая позиция ищется новым экземпляром Ips, время
+         * и узлы суммируются.
+         *
+         * Перед замером минимакса и альфа-бета выполняется короткий прогревочный
+         * поиск, после которого память поиска очищается: он выделяет таблицу
+         * транспозиций, арену и буферы позиции. Поэтому выделения, попавшие в
+         * замер, относятся к самому перебору.
+         */
+        BenchResult measure(std::vector<Position> &positions, const BenchOptions &options,
+                            AI::EvalKind kind, const AI::Nnue::Network *network)
+        {
+            BenchResult result;
+
+            for (Position &position : positions)
+            {
+                AI::Ips engine(position.to_move);
+                engine.set_algorithm(options.algo);
+                engine.set_evaluation(kind);
+                engine.set_network(network);
+                engine.set_pruning(options.pruning);
+                engine.set_eval_cache_size(options.eval_cache);
+
+                using Core::Constants::SearchAlgo;
+                if (options.algo == SearchAlgo::AlphaBeta || options.algo == SearchAlgo::Minimax)
+                {
+                    engine.set_search_limits(options.depth, 1);
+                    engine.get_move(position.board);
+                    engine.clear_memory();
+                }
+                engine.set_search_limits(options.depth, options.time_ms);
+
+                const std::uint64_t nodes = engine.get_nodes();
+                const AI::EvalCacheStats cache = engine.get_eval_cache_stats();
+                const std::uint64_t allocations = allocation_count();
+                const auto start = std::chrono::steady_clock::now();
+                engine.get_move(position.board);
+                const auto stop = std::chrono::steady_clock::now();
+
+                result.allocations += allocation_count() - allocations;
+                result.nodes += engine.get_nodes() - nodes;
+                result.eval_probes += engine.get_eval_cache_stats().probes - cache.probes;
+                result.eval_hits += engine.get_eval_cache_stats().hits - cache.hits;
+                result.seconds += std::chrono::duration<double>(stop - start).count();
+                result.depth_sum += engine.get_last_depth();
+                result.positions++;
+            }
+            return result;
+        }
+    } // namespace
+
+    BenchResult run_bench(const BenchOptions &options, AI::EvalKind kind, const AI::Nnue::Network *network)
+    {
+        std::vector<Position> positions = load_positions(options);
+        return measure(positions, options, kind, network);
+    }
+
+    BenchResult run_board_bench(const BenchOptions &options, int size)
+    {
+        BenchOptions board_options = options;
+        board_options.board_size = size;
+        std::vector<Position> positions = size > 0 ? random_positions(board_options)
+                                                   : unbounded_positions(board_options);
+        return measure(positions, board_options, AI::EvalKind::Handcrafted, nullptr);
+    }
+
+    int bench_main(int argc, char **argv)
+    {
+        BenchOptions options;
+        std::string eval = "both";
+        std::string trace_path;
+
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string arg = argv[i];
+            const bool has_value = i + 1 < argc;
+
+            if (arg == "--eval" && has_value)
+                eval = argv[++i];
+            else if (arg == "--net" && has_value)
+                options.network_file = argv[++i];
+            else if (arg == "--positions" && has_value)
+                options.positions_file = argv[++i];
+            else if (arg == "--count" && has_value)
+                options.positions = std::stoi(argv[++i]);
+            else if (arg == "--size" && has_value)
+                options.board_size = std::stoi(argv[++i]);
+            else if (arg == "--seed" && has_value)
+                options.seed = static_cast<unsigned>(std::stoul(argv[++i]));
+            else if (arg == "--depth" && has_value)
+                options.depth = std::stoi(argv[++i]);
+            else if (arg == "--time" && has_value)
+                options.time_ms = std::stoi(argv[++i]);
+            else if (arg == "--eval-cache" && has_value)
+                options.eval_cache = std::stoul(argv[++i]);
+            else if (arg == "--no-pruning")
+                options.pruning = false;
+            else if (arg == "--trace" && has_value)
+                trace_path = argv[++i];
+            else if (arg == "--boards" && has_value)
+            {
+                std::istringstream list(argv[++i]);
+                std::string board;
+                while (std::getline(list, board, ','))
+                {
+                    options.boards.push_back(board == "unbounded" ? 0 : std::stoi(board));
+                }
+            }
+            else if (arg == "--algo" && has_value)
+            {
+                using Core::Constants::SearchAlgo;
+                const std::string algo = argv[++i];
+                options.algo = algo == "minimax" ? SearchAlgo::Minimax
+                               : algo == "mcts"  ? SearchAlgo::Mcts
+                                                 : SearchAlgo::AlphaBeta;
+            }
+            else
+            {
+                std::cerr << "Неизвестный параметр: " << arg << std::endl;
+                return 1;
+            }
+        }
+
+        AI::Nnue::Network network;
+        if (!options.network_file.empty())
+        {
+            if (!network.load(options.network_file))
+            {
+                std::cerr << "Не удалось прочитать сеть " << options.network_file << std::endl;
+                return 1;
+            }
+            if (network.get_size() != options.board_size && options.positions_file.empty())
+            {
+                options.board_size = network.get_size();
+            }
+        }
+        else
+        {
+            network.randomize(options.board_size, options.seed);
+        }
+
+        if (!trace_path.empty())
+        {
+            if (!Utils::Trace::compiled_in())
+                std::cerr << "Метки трассировки не собраны (опция CMake RENJU_TRACE)" << std::endl;
+            Utils::Trace::set_enabled(true);
+        }
+
+        auto report = [](const std::string &name, const BenchResult &r)
+        {
+            std::cout << std::left << std::setw(6) << name
+                      << " nodes " << std::setw(10) << r.nodes
+                      << " time " << std::fixed << std::setprecision(3) << r.seconds << " s"
+                      << " nps " << std::setprecision(0) << r.nodes_per_second();
+            if (r.positions > 0 && r.depth_sum > 0)
+            {
+                std::cout << " depth " << std::setprecision(1)
+                          << static_cast<double>(r.depth_sum) / r.positions;
+            }
+            if (r.eval_probes > 0)
+            {
+                std::cout << " cache " << std::setprecision(1)
+                          << 100.0 * r.eval_hits / r.eval_probes << "%";
+            }
+            if (allocation_counting())
+            {
+                std::cout << " allocs " << r.allocations;
+            }
+            std::cout << std::endl;
+        };
+
+        if (!options.boards.empty())
+        {
+            for (int size : options.boards)
+            {
+                report(size > 0 ? std::to_string(size) : "inf", run_board_bench(options, size));
+            }
+        }
+        else
+        {
+            if (eval == "hce" || eval == "both")
+                report("hce", run_bench(options, AI::EvalKind::Handcrafted, nullptr));
+            if (eval == "nnue" || eval == "both")
+                report("nnue", run_bench(options, AI::EvalKind::Nnue, &network));
+        }
+
+        if (!trace_path.empty() && !Utils::Trace::write_chrome_json(trace_path))
+        {
+            std::cerr << "Не удалось записать трассировку в " << trace_path << std::endl;
+        }
+        return 0;
+    }
+
+} // namespace Tools
@@ -0,0 +1,500 @@
+#include "tools/host.h"
+#include "utils/trace.h"
+
+#ifdef RENJU_EVENT_LOOP
+    #include "player/engine.h"
+    #include "utils/event_loop.h"
+#endif
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+
+namespace Tools
+{
+    namespace
+    {
+        /**
+         * @brief На сколько ходов делится остаток контроля времени партии.
+         */
+        constexpr int MOVES_TO_GO = 30;
+
+        double milliseconds(std::chrono::steady_clock::duration duration)
+        {
+            return std::chrono::duration<double, std::milli>(duration).count();
+        }
+    } // namespace
+
+    GameHost::GameHost(const HostOptions &options)
+        : m_options(options), m_table(options.hash_mb), m_next_id(1), m_active(0),
+          m_finished_games(0), m_ai_moves(0), m_latency_sum_ms(0), m_latency_max_ms(0),
+          m_queued(0), m_running(0), m_pool(options.workers)
+    {
+        for (int i = 0; i < m_pool.size(); ++i)
+        {
+            auto engines = std::make_unique<Engines>();
+            for (AI::Ips *engine : {&engines->white, &engines->black})
+            {
+                engine->set_algorithm(m_options.algo);
+                engine->set_shared_table(&m_table);
+            }
+            m_engines.push_back(std::move(engines));
+        }
+    }
+
+    /**
+     * @brief Пул объявлен последним и останавливается первым: задачи в
+     * поиске завершаются, пока движки и партии еще живы.
+     */
+    GameHost::~GameHost() = default;
+
+    void GameHost::set_move_callback(MoveCallback callback)
+    {
+        m_callback = std::move(callback);
+    }
+
+    GameHost::SessionId GameHost::create(Core::Situation board, int turn, bool white_ai, bool black_ai,
+                                         int clock_ms)
+    {
+        Core::Game game(std::move(board), Core::Type::eve, turn);
+        game.set_headless(true);
+
+        std::shared_ptr<Session> session;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            session = std::make_shared<Session>(m_next_id++, std::move(game));
+            m_sessions.emplace(session->id, session);
+            m_active++;
+        }
+
+        std::lock_guard<std::mutex> lock(session->mutex);
+        session->ai[0] = white_ai;
+        session->ai[1] = black_ai;
+        session->clock_ms = clock_ms;
+        schedule(session);
+        return session->id;
+    }
+
+    void GameHost::schedule(const std::shared_ptr<Session> &session)
+    {
+        const int side = (session->game.get_to_move() == Core::Color::White) ? 0 : 1;
+        if (session->scheduled || session->closed || session->game.is_over() || !session->ai[side])
+        {
+            return;
+        }
+
+        session->scheduled = true;
+        m_queued.fetch_add(1);
+        const auto queued = std::chrono::steady_clock::now();
+        m_pool.submit([this, session, queued]
+                      { think(session, queued); });
+    }
+
+    void GameHost::think(const std::shared_ptr<Session> &session, std::chrono::steady_clock::time_point queued)
+    {
+        RENJU_TRACE_SCOPE("GameHost::ai_move");
+        const auto start = std::chrono::steady_clock::now();
+        m_queued.fetch_sub(1);
+        m_running.fetch_add(1);
+
+        Engines &engines = *m_engines[m_pool.current_index()];
+        std::pair<int, int> move{-1, -1};
+        Core::MoveResult result = Core::MoveResult::invalid();
+        bool played = false;
+        bool finished = false;
+
+        {
+            std::lock_guard<std::mutex> lock(session->mutex);
+            session->scheduled = false;
+
+            if (!session->closed && !session->game.is_over())
+            {
+                Core::Game &game = session->game;
+                AI::Ips &engine = (game.get_to_move() == Core::Color::White) ? engines.white : engines.black;
+
+                int budget = m_options.move_time_ms;
+                if (session->clock_ms >= 0)
+                {
+                    budget = std::min(budget, std::max(1, session->clock_ms / MOVES_TO_GO));
+                }
+
+                engine.clear_memory();
+                engine.set_search_limits(m_options.max_depth, budget);
+                AI::MctsOptions mcts;
+                mcts.threads = 1; // параллельность дают партии
+                mcts.time_ms = budget;
+                engine.set_mcts_options(mcts);
+
+                move = engine.get_move(game.get_situation());
+                if (session->clock_ms >= 0)
+                {
+                    const int spent = static_cast<int>(milliseconds(std::chrono::steady_clock::now() - start));
+                    session->clock_ms = std::max(0, session->clock_ms - spent);
+                }
+
+                if (move.first >= 0)
+                {
+                    result = game.play(move.first, move.second);
+                }
+                played = true;
+
+                // Без допустимого хода партия не может продолжиться
+                if (!result.valid || game.is_over())
+                {
+                    session->closed = true;
+                    finished = true;
+                }
+            }
+
+            // Счетчики обновляются до освобождения партии: ее следующий ход
+            // не должен оказаться учтенным раньше этого.
+            m_running.fetch_sub(1);
+            if (played)
+            {
+                const double latency = milliseconds(start - queued);
+                std::lock_guard<std::mutex> stats_lock(m_mutex);
+                m_ai_moves++;
+                m_latency_sum_ms += latency;
+                m_latency_max_ms = std::max(m_latency_max_ms, latency);
+            }
+        }
+
+        if (!played)
+        {
+            return;
+        }
+
+        // Следующий ход ставится после обработчика, чтобы ходы партии
+        // сообщались по порядку.
+        if (m_callback)
+        {
+            m_callback(session->id, move, result);
+        }
+
+        if (finished)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_active--;
+            m_finished_games++;
+            m_finished.notify_all();
+        }
+        else
+        {
+            std::lock_guard<std::mutex> lock(session->mutex);
+            schedule(session);
+        }
+    }
+
+    Core::MoveResult GameHost::play(SessionId id, int x, int y)
+    {
+        std::shared_ptr<Session> session;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            const auto it = m_sessions.find(id);
+            if (it == m_sessions.end())
+            {
+                return Core::MoveResult::invalid();
+            }
+            session = it->second;
+        }
+
+        bool finished = false;
+        Core::MoveResult result = Core::MoveResult::invalid();
+        {
+            std::lock_guard<std::mutex> lock(session->mutex);
+            const int side = (session->game.get_to_move() == Core::Color::White) ? 0 : 1;
+            if (session->closed || session->ai[side])
+            {
+                return result;
+            }
+
+            result = session->game.play(x, y);
+            if (result.valid && session->game.is_over())
+            {
+                session->closed = true;
+                finished = true;
+            }
+            else if (result.valid)
+            {
+                schedule(session);
+            }
+        }
+
+        if (finished)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_active--;
+            m_finished_games++;
+            m_finished.notify_all();
+        }
+        return result;
+    }
+
+    void GameHost::close(SessionId id)
+    {
+        std::shared_ptr<Session> session;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            const auto it = m_sessions.find(id);
+            if (it == m_sessions.end())
+            {
+                return;
+            }
+            session = it->second;
+            m_sessions.erase(it);
+        }
+
+        bool was_active = false;
+        {
+            std::lock_guard<std::mutex> lock(session->mutex);
+            was_active = !session->closed;
+            session->closed = true;
+        }
+
+        if (was_active)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_active--;
+            m_finished.notify_all();
+        }
+    }
+
+    Core::Status GameHost::get_result(SessionId id)
+    {
+        std::shared_ptr<Session> session;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            const auto it = m_sessions.find(id);
+            if (it == m_sessions.end())
+            {
+                return Core::ongoing;
+            }
+            session = it->second;
+        }
+
+        std::lock_guard<std::mutex> lock(session->mutex);
+        return session->game.get_result();
+    }
+
+    void GameHost::wait_all()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_finished.wait(lock, [this]
+                        { return m_active == 0; });
+    }
+
+    bool GameHost::wait_all_for(std::chrono::milliseconds timeout)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        return m_finished.wait_for(lock, timeout, [this]
+                                   { return m_active == 0; });
+    }
+
+    HostStats GameHost::get_stats()
+    {
+        HostStats stats;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        stats.active_games = m_active;
+        stats.queued_moves = m_queued.load();
+        stats.running_moves = m_running.load();
+        stats.ai_moves = m_ai_moves;
+        stats.finished_games = m_finished_games;
+        stats.latency_avg_ms = m_ai_moves ? m_latency_sum_ms / m_ai_moves : 0;
+        stats.latency_max_ms = m_latency_max_ms;
+        return stats;
+    }
+
+    namespace
+    {
+        void print_stats(const HostStats &stats, double seconds)
+        {
+            std::cout << std::fixed << std::setprecision(1)
+                      << "[" << seconds << " с] партий: " << stats.active_games
+                      << " идут, " << stats.finished_games << " завершено; ходов ИИ: "
+                      << stats.ai_moves << " (в очереди " << stats.queued_moves
+                      << ", в поиске " << stats.running_moves << "); ожидание потока: среднее "
+                      << stats.latency_avg_ms << " мс, макс. " << stats.latency_max_ms << " мс"
+                      << std::endl;
+        }
+
+#ifdef RENJU_EVENT_LOOP
+        /**
+         * @brief Партия ИИ против ИИ для цикла событий; итог считается в results.
+         */
+        Utils::Async<> play_async(Core::Game &game, Player::Player &white, Player::Player &black,
+                                  int (&results)[3], std::uint64_t &moves)
+        {
+            const int before = static_cast<int>(game.get_situation().get_history().size());
+            const Core::Status result = co_await game.run_async(white, black);
+            moves += game.get_situation().get_history().size() - before;
+            if (result == Core::white_wins || result == Core::black_wins || result == Core::draw)
+                results[result]++;
+        }
+
+        /**
+         * @brief Режим --async: все партии в одном цикле событий.
+         */
+        int run_async_games(const HostOptions &options, int games, int size, unsigned seed)
+        {
+            Utils::EventLoop loop;
+            Player::EnginePool engines(options.workers, options.hash_mb);
+            engines.configure([&](AI::Ips &engine)
+                              {
+                                  engine.set_algorithm(options.algo);
+                                  engine.set_search_limits(options.max_depth, options.move_time_ms);
+                                  AI::MctsOptions mcts;
+                                  mcts.threads = 1; // параллельность дают партии
+                                  mcts.time_ms = options.move_time_ms;
+                                  engine.set_mcts_options(mcts); });
+
+            struct Match
+            {
+                Core::Game game;
+                Player::Engine white;
+                Player::Engine black;
+            };
+
+            std::mt19937_64 rng(seed);
+            std::vector<std::unique_ptr<Match>> matches;
+            int results[3] = {0, 0, 0};
+            std::uint64_t moves = 0;
+
+            const auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < games; ++i)
+            {
+                Core::Situation board = Core::Situation::create_random(size, 2, 3, rng());
+                matches.push_back(std::make_unique<Match>(Match{Core::Game(std::move(board), Core::Type::eve, 1),
+                                                                Player::Engine(Core::Color::White, loop, engines),
+                                                                Player::Engine(Core::Color::Black, loop, engines)}));
+                Match &match = *matches.back();
+                match.game.set_headless(true);
+                loop.spawn(play_async(match.game, match.white, match.black, results, moves));
+            }
+            loop.run();
+            const double seconds = milliseconds(std::chrono::steady_clock::now() - start) / 1000;
+
+            std::cout << std::fixed << "Партий: " << games << " (белые " << results[Core::white_wins]
+                      << ", черные " << results[Core::black_wins] << ", ничьи " << results[Core::draw]
+                      << "), ходов ИИ в секунду: " << std::setprecision(1)
+                      << (seconds > 0 ? moves / seconds : 0) << std::endl;
+            return 0;
+        }
+#endif
+    } // namespace
+
+    int host_main(int argc, char **argv)
+    {
+        HostOptions options;
+        options.move_time_ms = 20;
+        options.max_depth = 4;
+        int games = 64;
+        int size = Core::Constants::FIELD_SIZE;
+        int clock_ms = -1;
+        unsigned seed = 1;
+        bool async = false;
+        std::string trace_path;
+
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string arg = argv[i];
+            const bool has_value = i + 1 < argc;
+
+            if (arg == "--games" && has_value)
+                games = std::stoi(argv[++i]);
+            else if (arg == "--workers" && has_value)
+                options.workers = std::stoi(argv[++i]);
+            else if (arg == "--size" && has_value)
+                size = std::stoi(argv[++i]);
+            else if (arg == "--time" && has_value)
+                options.move_time_ms = std::stoi(argv[++i]);
+            else if (arg == "--clock" && has_value)
+                clock_ms = std::stoi(argv[++i]);
+            else if (arg == "--depth" && has_value)
+                options.max_depth = std::stoi(argv[++i]);
+            else if (arg == "--hash" && has_value)
+                options.hash_mb = static_cast<std::size_t>(std::stoul(argv[++i]));
+            else if (arg == "--seed" && has_value)
+                seed = static_cast<unsigned>(std::stoul(argv[++i]));
+            else if (arg == "--trace" && has_value)
+                trace_path = argv[++i];
+            else if (arg == "--async")
+                async = true;
+            else if (arg == "--algo" && has_value)
+            {
+                using Core::Constants::SearchAlgo;
+                const std::string algo = argv[++i];
+                options.algo = algo == "minimax" ? SearchAlgo::Minimax
+                               : algo == "mcts"  ? SearchAlgo::Mcts
+                                                 : SearchAlgo::AlphaBeta;
+            }
+            else
+            {
+                std::cerr << "Неизвестный параметр: " << arg << std::endl;
+                return 1;
+            }
+        }
+
+        if (!trace_path.empty())
+        {
+            if (!Utils::Trace::compiled_in())
+                std::cerr << "Метки трассировки не собраны (опция CMake RENJU_TRACE)" << std::endl;
+            Utils::Trace::set_enabled(true);
+        }
+
+        if (async)
+        {
+#ifndef RENJU_EVENT_LOOP
+            std::cerr << "Режим --async не поддерживается на этой платформе" << std::endl;
+            return 1;
+#else
+            const int code = run_async_games(options, games, size, seed);
+            if (!trace_path.empty() && !Utils::Trace::write_chrome_json(trace_path))
+            {
+                std::cerr << "Не удалось записать трассировку в " << trace_path << std::endl;
+            }
+            return code;
+#endif
+        }
+
+        GameHost host(options);
+        std::mt19937_64 rng(seed);
+        std::vector<GameHost::SessionId> ids;
+
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < games; ++i)
+        {
+            Core::Situation board = Core::Situation::create_random(size, 2, 3, rng());
+            ids.push_back(host.create(std::move(board), 1, true, true, clock_ms));
+        }
+
+        while (!host.wait_all_for(std::chrono::seconds(1)))
+        {
+            print_stats(host.get_stats(), milliseconds(std::chrono::steady_clock::now() - start) / 1000);
+        }
+        const double seconds = milliseconds(std::chrono::steady_clock::now() - start) / 1000;
+        const HostStats stats = host.get_stats();
+        print_stats(stats, seconds);
+
+        int results[3] = {0, 0, 0};
+        for (GameHost::SessionId id : ids)
+        {
+            const Core::Status result = host.get_result(id);
+            if (result == Core::white_wins || result == Core::black_wins || result == Core::draw)
+                results[result]++;
+        }
+
+        std::cout << "Партий: " << games << " (белые " << results[Core::white_wins]
+                  << ", черные " << results[Core::black_wins] << ", ничьи " << results[Core::draw]
+                  << "), ходов ИИ в секунду: " << std::setprecision(1)
+                  << (seconds > 0 ? stats.ai_moves / seconds : 0) << std::endl;
+
+        if (!trace_path.empty() && !Utils::Trace::write_chrome_json(trace_path))
+        {
+            std::cerr << "Не удалось записать трассировку в " << trace_path << std::endl;
+        }
+        return 0;
+    }
+
+} // namespace Tools
@@ -0,0 +1,319 @@
+#include "tools/openings.h"
+#include "core/notation.h"
+#include "solver/ips.h"
+#include "utils/thread_pool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace Tools
+{
+    namespace
+    {
+        /**
+         * @brief Наибольший блок кандидатов: блок проверяется параллельно,
+         * затем записывается по порядку.
+         */
+        constexpr int BLOCK = 4096;
+
+        /**
+         * @brief Кандидатов в одной задаче пула.
+         */
+        constexpr int CHUNK = 64;
+
+        /**
+         * @brief Перемешивание splitmix64: соседние номера дают независимые зерна.
+         */
+        std::uint64_t mix(std::uint64_t x)
+        {
+            x += 0x9E3779B97F4A7C15ull;
+            x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+            x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+            return x ^ (x >> 31);
+        }
+
+        enum class Verdict
+        {
+            Accepted,
+            Decided,
+            Unbalanced
+        };
+
+        struct Candidate
+        {
+            Verdict verdict = Verdict::Accepted;
+            std::uint64_t key = 0; ///< Хэш позиции с точностью до симметрии.
+            std::string text;
+        };
+
+        /**
+         * @brief Рабочие объекты одного потока пула.
+         */
+        struct Worker
+        {
+            Core::Situation situation;
+            std::unique_ptr<AI::Ips> white; ///< Движки проверки (при depth > 0).
+            std::unique_ptr<AI::Ips> black;
+
+            Worker(int size, int depth) : situation(size)
+            {
+                if (depth <= 0)
+                {
+                    return;
+                }
+
+                white = std::make_unique<AI::Ips>(Core::Color::White);
+                black = std::make_unique<AI::Ips>(Core::Color::Black);
+                for (AI::Ips *engine : {white.get(), black.get()})
+                {
+                    engine->set_algorithm(Core::Constants::SearchAlgo::AlphaBeta);
+                    engine->set_hash_size(1);            // очищается перед каждым дебютом
+                    engine->set_search_limits(depth, 0); // без времени - ради воспроизводимости
+                }
+            }
+        };
+
+        /**
+         * @brief Есть ли у color пятерка в один ход.
+         *
+         * Пятерка включает четыре камня color, поэтому при меньшем их числе
+         * проверка не нужна, а иначе проверяются только пустые клетки на
+         * линиях не дальше четырех от камней color.
+         */
+        bool can_win_now(Core::Situation &situation, Core::Color color)
+        {
+            static constexpr int DIRECTIONS[4][2] = {{1, 0}, {0, 1}, {1, 1}, {1, -1}};
+
+            const auto &history = situation.get_history();
+            int own = 0;
+            for (const auto &[x, y] : history)
+            {
+                own += situation.get_stone_color(x, y) == color;
+            }
+            if (own < 4)
+            {
+                return false;
+            }
+
+            for (std::size_t i = 0; i < history.size(); ++i)
+            {
+                const auto [sx, sy] = history[i];
+                if (situation.get_stone_color(sx, sy) != color)
+                {
+                    continue;
+                }
+
+                for (const auto &direction : DIRECTIONS)
+                {
+                    for (int d = -4; d <= 4; ++d)
+                    {
+                        const int x = sx + d * direction[0];
+                        const int y = sy + d * direction[1];
+                        if (!situation.is_within_bounds(x, y) || !situation.is_empty(x, y) ||
+                            !situation.move(x, y, color))
+                        {
+                            continue;
+                        }
+                        const bool five = situation.is_five(x, y);
+                        situation.un_move();
+                        if (five)
+                        {
+                            return true;
+                        }
+                    }
+                }
+            }
+            return false;
+        }
+
+        void examine(const OpeningOptions &options, std::uint64_t index, Candidate &candidate, Worker &worker)
+        {
+            const std::uint64_t seed = mix(options.seed ^ mix(index));
+            const int spread = std::max(0, options.max_stones - options.min_stones);
+            const int stones = options.min_stones + static_cast<int>(seed % (spread + 1));
+
+            Core::Situation &situation = worker.situation;
+            situation.fill_random(options.size, stones, options.radius, seed);
+            const bool white_to_move = situation.get_history().size() % 2 == 0;
+            const Core::Color to_move = white_to_move ? Core::Color::White : Core::Color::Black;
+
+            candidate.verdict = Verdict::Accepted;
+            if (can_win_now(situation, Core::Color::White) || can_win_now(situation, Core::Color::Black))
+            {
+                candidate.verdict = Verdict::Decided;
+                return;
+            }
+
+            if (worker.white)
+            {
+                AI::Ips &engine = white_to_move ? *worker.white : *worker.black;
+                engine.clear_memory();
+                engine.get_move(situation);
+                if (std::abs(engine.get_last_score()) > options.balance)
+                {
+                    candidate.verdict = Verdict::Unbalanced;
+                    return;
+                }
+            }
+
+            candidate.key = situation.get_canonical().hash;
+            candidate.text = Core::Notation::to_string(situation, to_move);
+        }
+    } // namespace
+
+    OpeningStats generate_openings(const OpeningOptions &options, std::ostream &out)
+    {
+        OpeningStats stats;
+        Utils::WorkStealingPool pool(options.threads);
+
+        std::vector<std::unique_ptr<Worker>> workers;
+        for (int i = 0; i < pool.size(); ++i)
+        {
+            workers.push_back(std::make_unique<Worker>(options.size, options.depth));
+        }
+
+        std::unordered_set<std::uint64_t> seen;
+        std::vector<Candidate> block(BLOCK);
+        std::uint64_t first = 0;
+        int barren = 0; // кандидатов подряд без нового дебюта
+
+        while (stats.written < static_cast<std::uint64_t>(options.count))
+        {
+            // Блок с запасом на отбраковку, но не больше нужного: проверка
+            // движком дорога
+            const std::uint64_t needed = options.count - stats.written;
+            const int size = static_cast<int>(std::min<std::uint64_t>(
+                BLOCK, (needed + needed / 4 + CHUNK - 1) / CHUNK * CHUNK));
+
+            for (int begin = 0; begin < size; begin += CHUNK)
+            {
+                pool.submit([&, begin]
+                            {
+                                Worker &worker = *workers[pool.current_index()];
+                                for (int i = begin; i < begin + CHUNK; ++i)
+                                    examine(options, first + i, block[i], worker); });
+            }
+            pool.wait_idle();
+
+            for (int i = 0; i < size && stats.written < static_cast<std::uint64_t>(options.count); ++i)
+            {
+                const Candidate &candidate = block[i];
+                stats.candidates++;
+
+                if (candidate.verdict == Verdict::Decided)
+                {
+                    stats.decided++;
+                }
+                else if (candidate.verdict == Verdict::Unbalanced)
+                {
+                    stats.unbalanced++;
+                }
+                else if (options.unique && !seen.insert(candidate.key).second)
+                {
+                    stats.duplicates++;
+                }
+                else
+                {
+                    out << candidate.text << '\n';
+                    stats.written++;
+                    barren = 0;
+                    continue;
+                }
+                barren++;
+            }
+            first += size;
+
+            // Целый блок кандидатов без новых дебютов (возможно, из нескольких
+            // урезанных блоков): при таких параметрах их больше нет
+            if (barren >= BLOCK)
+            {
+                break;
+            }
+        }
+
+        return stats;
+    }
+
+    int openings_main(int argc, char **argv)
+    {
+        OpeningOptions options;
+        std::string output;
+
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string arg = argv[i];
+            const bool has_value = i + 1 < argc;
+
+            if (arg == "--count" && has_value)
+                options.count = std::stoi(argv[++i]);
+            else if (arg == "--out" && has_value)
+                output = argv[++i];
+            else if (arg == "--size" && has_value)
+                options.size = std::stoi(argv[++i]);
+            else if (arg == "--stones" && i + 2 < argc)
+            {
+                options.min_stones = std::stoi(argv[++i]);
+                options.max_stones = std::stoi(argv[++i]);
+            }
+            else if (arg == "--radius" && has_value)
+                options.radius = std::stoi(argv[++i]);
+            else if (arg == "--seed" && has_value)
+                options.seed = std::stoull(argv[++i]);
+            else if (arg == "--threads" && has_value)
+                options.threads = std::stoi(argv[++i]);
+            else if (arg == "--depth" && has_value)
+                options.depth = std::stoi(argv[++i]);
+            else if (arg == "--balance" && has_value)
+                options.balance = std::stoi(argv[++i]);
+            else if (arg == "--allow-duplicates")
+                options.unique = false;
+            else
+            {
+                std::cerr << "Неизвестный параметр: " << arg << std::endl;
+                return 1;
+            }
+        }
+
+        if (options.size < 5 || options.min_stones < 0 || options.max_stones < options.min_stones)
+        {
+            std::cerr << "Некорректные параметры дебютов" << std::endl;
+            return 1;
+        }
+
+        std::ofstream file;
+        if (!output.empty())
+        {
+            file.open(output);
+            if (!file)
+            {
+                std::cerr << "Не удалось открыть файл: " << output << std::endl;
+                return 1;
+            }
+        }
+        std::ostream &out = output.empty() ? std::cout : file;
+
+        const auto start = std::chrono::steady_clock::now();
+        const OpeningStats stats = generate_openings(options, out);
+        out.flush();
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::cerr << "Дебютов: " << stats.written << " из " << stats.candidates << " кандидатов (отброшено: "
+                  << stats.decided << " с выигрышем в один ход, " << stats.unbalanced << " по оценке, "
+                  << stats.duplicates << " повторов) за " << seconds << " с" << std::endl;
+
+        if (stats.written < static_cast<std::uint64_t>(options.count))
+        {
+            std::cerr << "Подходящих дебютов меньше, чем запрошено" << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+} // namespace Tools
@@ -0,0 +1,505 @@
+#include "tools/server.h"
+#include "core/notation.h"
+#include "utils/trace.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace Tools
+{
+    namespace
+    {
+        /**
+         * @brief Предельная длина строки запроса (позиция 32x32 занимает около 1 КБ).
+         */
+        constexpr std::size_t MAX_LINE = 16 * 1024;
+
+        double milliseconds(std::chrono::steady_clock::duration duration)
+        {
+            return std::chrono::duration<double, std::milli>(duration).count();
+        }
+    } // namespace
+
+    /**
+     * @brief Открытое соединение.
+     *
+     * Принадлежит потоку чтения и запросам в очереди: сокет закрывается,
+     * когда отправлен последний ответ, даже если клиент уже закрыл свою
+     * сторону на запись.
+     */
+    struct AnalysisServer::Connection
+    {
+        int fd;
+        std::mutex mutex; ///< Ответы разных потоков поиска не перемешиваются.
+
+        explicit Connection(int fd) : fd(fd) {}
+        ~Connection() { ::close(fd); }
+
+        void send_line(const std::string &line)
+        {
+            const std::string data = line + '\n';
+            std::lock_guard<std::mutex> lock(mutex);
+
+            std::size_t sent = 0;
+            while (sent < data.size())
+            {
+                const ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+                if (n <= 0)
+                    return; // клиент ушел - ответ не нужен
+                sent += static_cast<std::size_t>(n);
+            }
+        }
+    };
+
+    AnalysisServer::AnalysisServer(const ServerOptions &options)
+        : m_options(options), m_table(options.hash_mb), m_stopping(false), m_running(0),
+          m_completed(0), m_rejected(0), m_latency_sum_ms(0), m_latency_max_ms(0),
+          m_listen_fd(-1), m_shutdown(false), m_connection_count(0)
+    {
+        int workers = m_options.workers;
+        if (workers <= 0)
+        {
+            const unsigned hw = std::thread::hardware_concurrency();
+            workers = hw ? static_cast<int>(hw) : 1;
+        }
+
+        for (int i = 0; i < workers; ++i)
+        {
+            m_workers.emplace_back(&AnalysisServer::worker, this);
+        }
+    }
+
+    AnalysisServer::~AnalysisServer()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+            m_queue.clear();
+        }
+        m_ready.notify_all();
+
+        for (auto &thread : m_workers)
+        {
+            thread.join();
+        }
+        if (m_listen_fd >= 0)
+        {
+            ::close(m_listen_fd);
+        }
+    }
+
+    /**
+     * @brief У потока свои движки для каждого цвета; общая у них только
+     * таблица транспозиций.
+     */
+    void AnalysisServer::worker()
+    {
+        AI::Ips white(Core::Color::White), black(Core::Color::Black);
+        for (AI::Ips *engine : {&white, &black})
+        {
+            engine->set_algorithm(m_options.algo);
+            engine->set_shared_table(&m_table);
+        }
+
+        while (true)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_ready.wait(lock, [this]
+                         { return m_stopping || !m_queue.empty(); });
+            if (m_stopping)
+            {
+                return;
+            }
+
+            Request request = std::move(m_queue.front());
+            m_queue.pop_front();
+            m_running++;
+            lock.unlock();
+
+            process(request, white, black);
+        }
+    }
+
+    /**
+     * @brief Время поиска - остаток ограничения запроса после ожидания в
+     * очереди, но не меньше 1 мс: ответ приходит всегда, хотя бы по
+     * первой итерации.
+     */
+    void AnalysisServer::process(Request &request, AI::Ips &white, AI::Ips &black)
+    {
+        RENJU_TRACE_SCOPE("AnalysisServer::request");
+        const auto start = std::chrono::steady_clock::now();
+        const double wait_ms = milliseconds(start - request.received);
+        const int budget = std::max(1, request.time_ms - static_cast<int>(wait_ms));
+
+        AI::Ips &engine = (request.to_move == Core::Color::White) ? white : black;
+        engine.clear_memory();
+        engine.set_search_limits(Core::Constants::ALPHABETA_MAX_DEPTH, budget);
+
+        AI::MctsOptions mcts;
+        mcts.threads = 1; // параллельность дает пул запросов
+        mcts.time_ms = budget;
+        engine.set_mcts_options(mcts);
+
+        m_table.new_search();
+        const std::uint64_t nodes = engine.get_nodes();
+        std::pair<int, int> move;
+        std::ostringstream out;
+
+        if (request.multi_pv > 0)
+        {
+            const AI::SearchResult result = engine.analyze(request.situation, request.multi_pv);
+            move = result.best_move;
+            for (std::size_t i = 0; i < result.lines.size(); ++i)
+            {
+                const AI::PvLine &line = result.lines[i];
+                out << "line " << request.tag << ' ' << i + 1 << ' ' << line.move.first << ' '
+                    << line.move.second << " score " << line.score << " pv";
+                for (const auto &step : line.pv)
+                    out << ' ' << step.first << ',' << step.second;
+                out << '\n';
+            }
+        }
+        else
+        {
+            move = engine.get_move(request.situation);
+        }
+
+        const auto stop = std::chrono::steady_clock::now();
+        const double search_ms = milliseconds(stop - start);
+
+        out << "bestmove " << request.tag << ' ' << move.first << ' ' << move.second
+            << " depth " << engine.get_last_depth()
+            << " nodes " << (engine.get_nodes() - nodes)
+            << std::fixed << std::setprecision(1)
+            << " wait_ms " << wait_ms << " search_ms " << search_ms;
+
+        // Счетчики обновляются до ответа: получив его, клиент видит запрос в stats выполненным.
+        {
+            const double latency = milliseconds(stop - request.received);
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_running--;
+            m_completed++;
+            m_latency_sum_ms += latency;
+            m_latency_max_ms = std::max(m_latency_max_ms, latency);
+        }
+        request.reply(out.str());
+    }
+
+    bool AnalysisServer::enqueue(Request request)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_queue.size() >= m_options.max_queue)
+            {
+                m_rejected++;
+                return false;
+            }
+            m_queue.push_back(std::move(request));
+        }
+        m_ready.notify_one();
+        return true;
+    }
+
+    bool AnalysisServer::handle_line(const std::string &line, const Reply &reply)
+    {
+        std::istringstream in(line);
+        std::string command;
+        in >> command;
+
+        if (command.empty())
+        {
+            return true;
+        }
+        if (command == "quit")
+        {
+            return false;
+        }
+        if (command == "shutdown")
+        {
+            stop();
+            return false;
+        }
+        if (command == "stats")
+        {
+            const ServerStats stats = get_stats();
+            std::ostringstream out;
+            out << "stats queued " << stats.queued << " running " << stats.running
+                << " completed " << stats.completed << " rejected " << stats.rejected
+                << std::fixed << std::setprecision(1)
+                << " latency_avg_ms " << stats.latency_avg_ms
+                << " latency_max_ms " << stats.latency_max_ms
+                << " hashfull " << stats.hashfull;
+            reply(out.str());
+            return true;
+        }
+        if (command != "go" && command != "analyze")
+        {
+            reply("error неизвестная команда " + command);
+            return true;
+        }
+
+        std::string tag;
+        int time_ms = 0;
+        int multi_pv = 0;
+        if (!(in >> tag >> time_ms) || (command == "analyze" && (!(in >> multi_pv) || multi_pv <= 0)))
+        {
+            reply(command == "go" ? "error формат: go <метка> <время, мс> <позиция>"
+                                  : "error формат: analyze <метка> <время, мс> <K> <позиция>");
+            return true;
+        }
+
+        std::string position;
+        std::getline(in >> std::ws, position);
+
+        Request request{tag, Core::Situation(Core::Constants::FIELD_SIZE), Core::Color::White,
+                        0, multi_pv, std::chrono::steady_clock::now(), reply};
+        if (!Core::Notation::parse(position, request.situation, request.to_move) ||
+            request.situation.check_win())
+        {
+            reply("error " + tag + " некорректная позиция");
+            return true;
+        }
+
+        request.time_ms = (time_ms <= 0) ? m_options.default_time_ms
+                                         : std::min(time_ms, m_options.max_time_ms);
+        if (!enqueue(std::move(request)))
+        {
+            reply("error " + tag + " очередь заполнена");
+        }
+        return true;
+    }
+
+    ServerStats AnalysisServer::get_stats()
+    {
+        ServerStats stats;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            stats.queued = m_queue.size();
+            stats.running = m_running;
+            stats.completed = m_completed;
+            stats.rejected = m_rejected;
+            stats.latency_avg_ms = m_completed ? m_latency_sum_ms / m_completed : 0;
+            stats.latency_max_ms = m_latency_max_ms;
+        }
+        stats.hashfull = m_table.hashfull();
+        return stats;
+    }
+
+    bool AnalysisServer::listen()
+    {
+        if (m_options.port > 0)
+        {
+            m_listen_fd = ::socket(AF_INET, SOCK_STREAM, 0);
+            if (m_listen_fd < 0)
+                return false;
+
+            const int yes = 1;
+            ::setsockopt(m_listen_fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_port = htons(static_cast<std::uint16_t>(m_options.port));
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            if (::bind(m_listen_fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0)
+                return false;
+        }
+        else
+        {
+            sockaddr_un address{};
+            if (m_options.socket_path.size() >= sizeof(address.sun_path))
+                return false;
+
+            m_listen_fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+            if (m_listen_fd < 0)
+                return false;
+
+            address.sun_family = AF_UNIX;
+            std::strcpy(address.sun_path, m_options.socket_path.c_str());
+            ::unlink(address.sun_path); // сокет, оставшийся от прошлого запуска
+            if (::bind(m_listen_fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0)
+                return false;
+        }
+
+        return ::listen(m_listen_fd, SOMAXCONN) == 0;
+    }
+
+    void AnalysisServer::serve_connection(std::shared_ptr<Connection> connection)
+    {
+        const Reply reply = [connection](const std::string &line)
+        { connection->send_line(line); };
+
+        std::string pending;
+        char buffer[4096];
+        bool open = true;
+
+        while (open)
+        {
+            const ssize_t n = ::recv(connection->fd, buffer, sizeof(buffer), 0);
+            if (n <= 0)
+                break;
+            pending.append(buffer, static_cast<std::size_t>(n));
+
+            std::size_t end;
+            while (open && (end = pending.find('\n')) != std::string::npos)
+            {
+                std::string line = pending.substr(0, end);
+                pending.erase(0, end + 1);
+                if (!line.empty() && line.back() == '\r')
+                    line.pop_back();
+                open = handle_line(line, reply);
+            }
+
+            if (pending.size() > MAX_LINE)
+            {
+                reply("error слишком длинная строка");
+                open = false;
+            }
+        }
+
+        if (!open)
+        {
+            ::shutdown(connection->fd, SHUT_RDWR); // "quit": ответы на незавершенные запросы не нужны
+        }
+    }
+
+    /**
+     * @brief Каждое соединение читает свой поток; потоки отсоединены, а
+     * serve() перед возвратом ждет, пока их счетчик станет нулевым.
+     */
+    void AnalysisServer::serve()
+    {
+        while (!m_shutdown.load())
+        {
+            const int fd = ::accept(m_listen_fd, nullptr, nullptr);
+            if (fd < 0)
+            {
+                if (errno == EINTR || errno == ECONNABORTED)
+                    continue;
+                break; // сокет закрыт stop()
+            }
+
+            auto connection = std::make_shared<Connection>(fd);
+            {
+                std::lock_guard<std::mutex> lock(m_connections_mutex);
+                m_connections.erase(std::remove_if(m_connections.begin(), m_connections.end(),
+                                                   [](const auto &c)
+                                                   { return c.expired(); }),
+                                    m_connections.end());
+                m_connections.push_back(connection);
+                m_connection_count++;
+            }
+
+            std::thread([this, connection]
+                        {
+                            serve_connection(connection);
+                            std::lock_guard<std::mutex> lock(m_connections_mutex);
+                            m_connection_count--;
+                            m_connections_closed.notify_all(); })
+                .detach();
+        }
+
+        if (m_options.port <= 0)
+        {
+            ::unlink(m_options.socket_path.c_str());
+        }
+
+        std::unique_lock<std::mutex> lock(m_connections_mutex);
+        for (const auto &weak : m_connections)
+        {
+            if (auto connection = weak.lock())
+                ::shutdown(connection->fd, SHUT_RDWR);
+        }
+        m_connections_closed.wait(lock, [this]
+                                  { return m_connection_count == 0; });
+    }
+
+    void AnalysisServer::stop()
+    {
+        m_shutdown.store(true);
+        if (m_listen_fd >= 0)
+        {
+            ::shutdown(m_listen_fd, SHUT_RDWR); // будит accept
+        }
+    }
+
+    int server_main(int argc, char **argv)
+    {
+        ServerOptions options;
+        std::string trace_path;
+
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string arg = argv[i];
+            const bool has_value = i + 1 < argc;
+
+            if (arg == "--socket" && has_value)
+                options.socket_path = argv[++i];
+            else if (arg == "--port" && has_value)
+                options.port = std::stoi(argv[++i]);
+            else if (arg == "--workers" && has_value)
+                options.workers = std::stoi(argv[++i]);
+            else if (arg == "--hash" && has_value)
+                options.hash_mb = static_cast<std::size_t>(std::stoul(argv[++i]));
+            else if (arg == "--time" && has_value)
+                options.default_time_ms = std::stoi(argv[++i]);
+            else if (arg == "--max-time" && has_value)
+                options.max_time_ms = std::stoi(argv[++i]);
+            else if (arg == "--queue" && has_value)
+                options.max_queue = static_cast<std::size_t>(std::stoul(argv[++i]));
+            else if (arg == "--trace" && has_value)
+                trace_path = argv[++i];
+            else if (arg == "--algo" && has_value)
+            {
+                using Core::Constants::SearchAlgo;
+                const std::string algo = argv[++i];
+                options.algo = algo == "minimax" ? SearchAlgo::Minimax
+                               : algo == "mcts"  ? SearchAlgo::Mcts
+                                                 : SearchAlgo::AlphaBeta;
+            }
+            else
+            {
+                std::cerr << "Неизвестный параметр: " << arg << std::endl;
+                return 1;
+            }
+        }
+
+        if (!trace_path.empty())
+        {
+            if (!Utils::Trace::compiled_in())
+                std::cerr << "Метки трассировки не собраны (опция CMake RENJU_TRACE)" << std::endl;
+            Utils::Trace::set_enabled(true);
+        }
+
+        AnalysisServer server(options);
+        if (!server.listen())
+        {
+            std::cerr << "Не удалось открыть сокет: " << std::strerror(errno) << std::endl;
+            return 1;
+        }
+
+        if (options.port > 0)
+            std::cout << "Сервер анализа слушает 127.0.0.1:" << options.port << std::endl;
+        else
+            std::cout << "Сервер анализа слушает " << options.socket_path << std::endl;
+
+        server.serve();
+
+        if (!trace_path.empty() && !Utils::Trace::write_chrome_json(trace_path))
+        {
+            std::cerr << "Не удалось записать трассировку в " << trace_path << std::endl;
+        }
+        return 0;
+    }
+
+} // namespace Tools
@@ -0,0 +1,442 @@
+#include "tools/tuner.h"
+#include "storage/record.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <thread>
+
+namespace Tools
+{
+    namespace
+    {
+        /**
+         * @brief Настраиваемые веса. FiveInRow задает цену победы и не меняется;
+         * OpenEnd не настраивается: row_assessment этот признак не выставляет,
+         * и его вес не влияет на оценку.
+         */
+        constexpr int AI::Patterns::*TUNABLE[] = {
+            &AI::Patterns::TwoInRow,
+            &AI::Patterns::ThreeInRow,
+            &AI::Patterns::FourInRow,
+            &AI::Patterns::DoubleThreat};
+
+        constexpr int TUNABLE_COUNT = sizeof(TUNABLE) / sizeof(TUNABLE[0]);
+
+        int thread_count(const TunerOptions &options)
+        {
+            if (options.threads > 0)
+                return options.threads;
+            unsigned hw = std::thread::hardware_concurrency();
+            return hw ? static_cast<int>(hw) : 1;
+        }
+
+        /**
+         * @brief Выполняет body(i) для i из [0, count) на threads потоках.
+         */
+        template <typename Body>
+        void parallel_for(int count, int threads, Body body)
+        {
+            std::atomic<int> next{0};
+            auto worker = [&]
+            {
+                for (int i = next++; i < count; i = next++)
+                    body(i);
+            };
+
+            std::vector<std::thread> pool;
+            for (int t = 1; t < threads; ++t)
+                pool.emplace_back(worker);
+            worker();
+            for (auto &thread : pool)
+                thread.join();
+        }
+
+        /**
+         * @brief Веса в логарифмической шкале: веса отличаются на порядки,
+         * поэтому шаги оптимизации удобнее делать в относительных величинах.
+         */
+        void to_log(const AI::Patterns &weights, double *theta)
+        {
+            for (int i = 0; i < TUNABLE_COUNT; ++i)
+                theta[i] = std::log(std::max(1, weights.*TUNABLE[i]));
+        }
+
+        AI::Patterns from_log(const AI::Patterns &base, const double *theta)
+        {
+            AI::Patterns weights = base;
+            for (int i = 0; i < TUNABLE_COUNT; ++i)
+                weights.*TUNABLE[i] = static_cast<int>(std::lround(std::exp(theta[i])));
+            return weights;
+        }
+
+        void print_weights(const char *prefix, const AI::Patterns &w)
+        {
+            std::cout << prefix << " TwoInRow=" << w.TwoInRow << " ThreeInRow=" << w.ThreeInRow
+                      << " FourInRow=" << w.FourInRow
+                      << " DoubleThreat=" << w.DoubleThreat << std::endl;
+        }
+
+        Core::Color other(Core::Color color)
+        {
+            return color == Core::Color::White ? Core::Color::Black : Core::Color::White;
+        }
+
+        /**
+         * @brief Партия двух движков без отрисовки.
+         *
+         * @return Core::Status white_wins, black_wins или draw.
+         */
+        Core::Status play_match(AI::Ips &white, AI::Ips &black, Core::Situation board, Core::Color to_move)
+        {
+            while (true)
+            {
+                AI::Ips &engine = (to_move == Core::Color::White) ? white : black;
+                auto [x, y] = engine.get_move(board);
+
+                if (x < 0 || !board.move(x, y, to_move))
+                {
+                    return Core::draw; // нет допустимых ходов
+                }
+
+                int cw = board.check_win(x, y);
+                if (cw == 1)
+                    return to_move == Core::Color::White ? Core::white_wins : Core::black_wins;
+                if (cw == 2)
+                    return Core::draw;
+
+                to_move = other(to_move);
+            }
+        }
+
+        /**
+         * @brief Короткий случайный дебют в центре поля.
+         */
+        Core::Color random_opening(Core::Situation &board, std::mt19937_64 &rng)
+        {
+            const int size = board.get_size();
+            const int low = size / 2 - 2 < 0 ? 0 : size / 2 - 2;
+            const int span = size < 5 ? size : 5;
+            std::uniform_int_distribution<int> cell(0, span - 1);
+            std::uniform_int_distribution<int> count(2, 4);
+
+            Core::Color color = Core::Color::White;
+            for (int n = count(rng); n > 0; --n)
+            {
+                int x, y;
+                do
+                {
+                    x = low + cell(rng);
+                    y = low + cell(rng);
+                } while (!board.is_empty(x, y));
+                board.move(x, y, color);
+                color = other(color);
+            }
+            return color;
+        }
+
+        struct Sample
+        {
+            double features[TUNABLE_COUNT];
+            double result; // 1 - победа белых, 0 - победа черных, 0.5 - ничья
+        };
+
+        double sigmoid(double v)
+        {
+            return 1.0 / (1.0 + std::exp(-v));
+        }
+
+        double evaluate(const Sample &sample, const double *weights)
+        {
+            double eval = 0;
+            for (int i = 0; i < TUNABLE_COUNT; ++i)
+                eval += sample.features[i] * weights[i];
+            return eval;
+        }
+
+        double mean_loss(const std::vector<Sample> &samples, const double *weights, double k)
+        {
+            double loss = 0;
+            for (const auto &s : samples)
+            {
+                double err = s.result - sigmoid(k * evaluate(s, weights));
+                loss += err * err;
+            }
+            return samples.empty() ? 0 : loss / samples.size();
+        }
+    } // namespace
+
+    AI::Patterns tune_texel(const std::vector<std::string> &record_files, const TunerOptions &options)
+    {
+        const int threads = thread_count(options);
+
+        // 1. Позиции и признаки
+        std::vector<Sample> samples;
+        std::mutex samples_mutex;
+
+        for (const auto &path : record_files)
+        {
+            Storage::RecordReader reader(path);
+            if (!reader.is_open())
+            {
+                std::cerr << "Не удалось открыть " << path << std::endl;
+                continue;
+            }
+
+            std::vector<Storage::GameView> games;
+            for (auto view : reader)
+            {
+                Core::Status result = static_cast<Core::Status>(view.header->result);
+                if (result == Core::white_wins || result == Core::black_wins || result == Core::draw)
+                    games.push_back(view);
+            }
+
+            parallel_for(static_cast<int>(games.size()), threads, [&](int g)
+            {
+                const Storage::GameView &view = games[g];
+                const Core::Status result = static_cast<Core::Status>(view.header->result);
+                const double label = result == Core::white_wins ? 1.0 : result == Core::black_wins ? 0.0 : 0.5;
+
+                Core::Situation situation(view.header->size);
+                AI::Ips ips(Core::Color::White);
+                std::vector<Sample> local;
+
+                if (!view.replay(situation, 0))
+                    return;
+
+                // Последняя позиция уже содержит пятерку - ее не берем
+                for (int i = 0; i + 1 < view.move_count(); ++i)
+                {
+                    auto [x, y] = Storage::GameView::decode(view.moves[i]);
+                    if (!situation.move(x, y, view.move_color(i)))
+                        break;
+
+                    AI::Patterns f = ips.count_features(situation, Core::Color::White);
+                    Sample sample;
+                    for (int t = 0; t < TUNABLE_COUNT; ++t)
+                        sample.features[t] = f.*TUNABLE[t];
+                    sample.result = label;
+                    local.push_back(sample);
+                }
+
+                std::lock_guard<std::mutex> lock(samples_mutex);
+                samples.insert(samples.end(), local.begin(), local.end());
+            });
+        }
+
+        std::cout << "Позиций: " << samples.size() << std::endl;
+
+        AI::Patterns best = options.initial;
+        if (samples.empty())
+            return best;
+
+        double weights[TUNABLE_COUNT];
+        for (int i = 0; i < TUNABLE_COUNT; ++i)
+            weights[i] = best.*TUNABLE[i];
+
+        // 2. Масштаб K: перебор по логарифмической сетке
+        double k = 1e-3;
+        double best_loss = mean_loss(samples, weights, k);
+        for (double log_k = -7; log_k <= 0; log_k += 0.25)
+        {
+            double candidate = std::pow(10.0, log_k);
+            double loss = mean_loss(samples, weights, candidate);
+            if (loss < best_loss)
+            {
+                best_loss = loss;
+                k = candidate;
+            }
+        }
+        std::cout << "K=" << k << " loss=" << best_loss << std::endl;
+
+        // 3. Градиентный спуск (Adam) по логарифмам весов
+        double theta[TUNABLE_COUNT], m[TUNABLE_COUNT] = {}, v[TUNABLE_COUNT] = {};
+        to_log(best, theta);
+        const double lr = 0.05, beta1 = 0.9, beta2 = 0.999, eps = 1e-12;
+        const int chunks = threads * 4;
+
+        for (int iter = 1; iter <= options.iterations; ++iter)
+        {
+            for (int i = 0; i < TUNABLE_COUNT; ++i)
+                weights[i] = std::exp(theta[i]);
+
+            std::vector<std::array<double, TUNABLE_COUNT>> partial(chunks);
+            parallel_for(chunks, threads, [&](int c)
+            {
+                auto &grad = partial[c];
+                grad.fill(0);
+                for (std::size_t s = c; s < samples.size(); s += chunks)
+                {
+                    const Sample &sample = samples[s];
+                    double p = sigmoid(k * evaluate(sample, weights));
+                    double common = -2.0 * (sample.result - p) * p * (1 - p) * k;
+                    for (int i = 0; i < TUNABLE_COUNT; ++i)
+                        grad[i] += common * sample.features[i];
+                }
+            });
+
+            for (int i = 0; i < TUNABLE_COUNT; ++i)
+            {
+                double g = 0;
+                for (const auto &grad : partial)
+                    g += grad[i];
+                g = g / samples.size() * weights[i]; // d/dtheta = d/dw * w
+
+                m[i] = beta1 * m[i] + (1 - beta1) * g;
+                v[i] = beta2 * v[i] + (1 - beta2) * g * g;
+                double m_hat = m[i] / (1 - std::pow(beta1, iter));
+                double v_hat = v[i] / (1 - std::pow(beta2, iter));
+                theta[i] -= lr * m_hat / (std::sqrt(v_hat) + eps);
+            }
+
+            if (iter % 10 == 0 || iter == options.iterations)
+            {
+                std::cout << "iter " << iter << " loss=" << mean_loss(samples, weights, k) << std::endl;
+            }
+        }
+
+        best = from_log(best, theta);
+        print_weights("Итог:", best);
+        return best;
+    }
+
+    AI::Patterns tune_spsa(const TunerOptions &options)
+    {
+        const int threads = thread_count(options);
+        const int games = std::max(2, options.games_per_iteration / 2 * 2);
+        const double a = 0.5, c = 0.2, alpha = 0.602, gamma = 0.101;
+        const double big_a = options.iterations / 10.0;
+
+        double theta[TUNABLE_COUNT];
+        to_log(options.initial, theta);
+        std::mt19937_64 rng(options.seed);
+
+        for (int iter = 0; iter < options.iterations; ++iter)
+        {
+            const double ck = c / std::pow(iter + 1, gamma);
+            const double ak = a / std::pow(iter + 1 + big_a, alpha);
+
+            double delta[TUNABLE_COUNT], plus[TUNABLE_COUNT], minus[TUNABLE_COUNT];
+            for (int i = 0; i < TUNABLE_COUNT; ++i)
+            {
+                delta[i] = (rng() & 1) ? 1.0 : -1.0;
+                plus[i] = theta[i] + ck * delta[i];
+                minus[i] = theta[i] - ck * delta[i];
+            }
+            const AI::Patterns w_plus = from_log(options.initial, plus);
+            const AI::Patterns w_minus = from_log(options.initial, minus);
+            const std::uint64_t iter_seed = rng();
+
+            // Партии парами: один дебют, цвета меняются местами
+            std::atomic<int> score{0}; // победы theta+ минус победы theta-
+            parallel_for(games, threads, [&](int g)
+            {
+                std::mt19937_64 game_rng(iter_seed + static_cast<std::uint64_t>(g / 2));
+                Core::Situation board(options.board_size);
+                Core::Color to_move = random_opening(board, game_rng);
+
+                const bool plus_white = (g % 2) == 0;
+                AI::Ips white(Core::Color::White), black(Core::Color::Black);
+                white.set_algorithm(options.algo);
+                black.set_algorithm(options.algo);
+                // Фиксированная глубина без ограничения времени: результат партии воспроизводим
+                white.set_search_limits(Core::Constants::MAX_SEARCH_DEPTH, 0);
+                black.set_search_limits(Core::Constants::MAX_SEARCH_DEPTH, 0);
+                white.set_weights(plus_white ? w_plus : w_minus);
+                black.set_weights(plus_white ? w_minus : w_plus);
+
+                Core::Status result = play_match(white, black, board, to_move);
+                if (result == Core::white_wins)
+                    score += plus_white ? 1 : -1;
+                else if (result == Core::black_wins)
+                    score += plus_white ? -1 : 1;
+            });
+
+            const double r = static_cast<double>(score) / games;
+            for (int i = 0; i < TUNABLE_COUNT; ++i)
+                theta[i] += ak * r / (2 * ck * delta[i]);
+
+            std::cout << "iter " << iter + 1 << " score=" << r;
+            print_weights("", from_log(options.initial, theta));
+        }
+
+        AI::Patterns result = from_log(options.initial, theta);
+        print_weights("Итог:", result);
+        return result;
+    }
+
+    int tune_main(int argc, char **argv)
+    {
+        if (argc < 2)
+        {
+            std::cerr << "Использование: renju-game tune <texel|spsa> [параметры]" << std::endl;
+            return 1;
+        }
+
+        const std::string mode = argv[1];
+        TunerOptions options;
+        std::vector<std::string> files;
+
+        for (int i = 2; i < argc; ++i)
+        {
+            const std::string arg = argv[i];
+            const bool has_value = i + 1 < argc;
+
+            if (arg == "--iterations" && has_value)
+                options.iterations = std::stoi(argv[++i]);
+            else if (arg == "--games" && has_value)
+                options.games_per_iteration = std::stoi(argv[++i]);
+            else if (arg == "--threads" && has_value)
+                options.threads = std::stoi(argv[++i]);
+            else if (arg == "--size" && has_value)
+                options.board_size = std::stoi(argv[++i]);
+            else if (arg == "--seed" && has_value)
+                options.seed = static_cast<unsigned>(std::stoul(argv[++i]));
+            else if (arg == "--out" && has_value)
+                options.output = argv[++i];
+            else if (arg == "--weights" && has_value)
+            {
+                if (!AI::load_weights(argv[++i], options.initial))
+                {
+                    std::cerr << "Не удалось прочитать веса " << argv[i] << std::endl;
+                    return 1;
+                }
+            }
+            else if (arg == "--algo" && has_value)
+            {
+                const std::string algo = argv[++i];
+                using Core::Constants::SearchAlgo;
+                options.algo = algo == "minimax"     ? SearchAlgo::Minimax
+                               : algo == "heuristic" ? SearchAlgo::Heuristic
+                               : algo == "mcts"      ? SearchAlgo::Mcts
+                                                     : SearchAlgo::AlphaBeta;
+            }
+            else
+                files.push_back(arg);
+        }
+
+        AI::Patterns result;
+        if (mode == "texel")
+            result = tune_texel(files, options);
+        else if (mode == "spsa")
+            result = tune_spsa(options);
+        else
+        {
+            std::cerr << "Неизвестный режим: " << mode << std::endl;
+            return 1;
+        }
+
+        if (!AI::save_weights(options.output, result))
+        {
+            std::cerr << "Не удалось записать " << options.output << std::endl;
+            return 1;
+        }
+        std::cout << "Веса записаны в " << options.output << std::endl;
+        return 0;
+    }
+
+} // namespace Tools
@@ -0,0 +1,215 @@
+#include "utils/event_loop.h"
+
+#include <cerrno>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace Utils
+{
+    namespace
+    {
+        /**
+         * @brief Запись без SIGPIPE для сокетов; каналы пишутся обычным write.
+         */
+        ssize_t write_some(int fd, const char *data, std::size_t size)
+        {
+            const ssize_t count = ::send(fd, data, size, MSG_NOSIGNAL);
+            if (count < 0 && errno == ENOTSOCK)
+                return ::write(fd, data, size);
+            return count;
+        }
+    } // namespace
+
+    EventLoop::EventLoop() : m_tasks(0)
+    {
+        if (::pipe(m_wake) != 0)
+        {
+            throw std::runtime_error("EventLoop: не удалось создать канал пробуждения");
+        }
+        for (int fd : m_wake)
+        {
+            ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+        }
+    }
+
+    EventLoop::~EventLoop()
+    {
+        ::close(m_wake[0]);
+        ::close(m_wake[1]);
+    }
+
+    void EventLoop::post(std::coroutine_handle<> handle)
+    {
+        bool wake = false;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            wake = m_posted.empty();
+            m_posted.push_back(handle);
+        }
+
+        // Один байт на пачку продолжений: цикл забирает их все сразу
+        if (wake)
+        {
+            const char byte = 0;
+            [[maybe_unused]] const ssize_t written = ::write(m_wake[1], &byte, 1);
+        }
+    }
+
+    EventLoop::FdAwaiter EventLoop::readable(int fd)
+    {
+        return {*this, fd, POLLIN};
+    }
+
+    EventLoop::FdAwaiter EventLoop::writable(int fd)
+    {
+        return {*this, fd, POLLOUT};
+    }
+
+    /**
+     * @brief Ошибка и закрытие дескриптора тоже будят ожидающую корутину:
+     * она узнает о них из read или write.
+     */
+    void EventLoop::wait_events(int timeout_ms)
+    {
+        std::vector<pollfd> fds;
+        fds.reserve(m_waiters.size() + 1);
+        fds.push_back({m_wake[0], POLLIN, 0});
+        for (const Waiter &waiter : m_waiters)
+        {
+            fds.push_back({waiter.fd, waiter.events, 0});
+        }
+
+        if (::poll(fds.data(), fds.size(), timeout_ms) < 0)
+        {
+            if (errno == EINTR)
+                return;
+            throw std::runtime_error("EventLoop: ошибка poll");
+        }
+
+        if (fds[0].revents != 0)
+        {
+            char buffer[64];
+            while (::read(m_wake[0], buffer, sizeof(buffer)) > 0)
+            {
+            }
+        }
+
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < m_waiters.size(); ++i)
+        {
+            if (fds[i + 1].revents != 0)
+                m_ready.push_back(m_waiters[i].handle);
+            else
+                m_waiters[kept++] = m_waiters[i];
+        }
+        m_waiters.resize(kept);
+    }
+
+    void EventLoop::run()
+    {
+        std::vector<std::coroutine_handle<>> posted;
+
+        while (m_tasks > 0)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                posted.swap(m_posted);
+            }
+            m_ready.insert(m_ready.end(), posted.begin(), posted.end());
+            posted.clear();
+
+            if (m_ready.empty())
+            {
+                wait_events(-1);
+                continue;
+            }
+            if (!m_waiters.empty())
+            {
+                wait_events(0);
+            }
+
+            // Корутины, ставшие готовыми во время прохода, ждут следующего:
+            // так ввод и результаты пула не откладываются бесконечно
+            for (std::size_t count = m_ready.size(); count > 0; --count)
+            {
+                const std::coroutine_handle<> handle = m_ready.front();
+                m_ready.pop_front();
+                handle.resume();
+            }
+        }
+
+        if (m_error)
+        {
+            std::rethrow_exception(std::exchange(m_error, nullptr));
+        }
+    }
+
+    std::size_t EventLoop::tasks() const
+    {
+        return m_tasks;
+    }
+
+    LineReader::LineReader(EventLoop &loop, int fd)
+        : m_loop(loop), m_fd(fd), m_eof(false) {}
+
+    Async<std::optional<std::string>> LineReader::read_line()
+    {
+        while (true)
+        {
+            const std::size_t end = m_buffer.find('\n');
+            if (end != std::string::npos)
+            {
+                std::string line = m_buffer.substr(0, end);
+                m_buffer.erase(0, end + 1);
+                co_return line;
+            }
+
+            if (m_eof)
+            {
+                if (m_buffer.empty())
+                    co_return std::nullopt;
+                co_return std::exchange(m_buffer, std::string());
+            }
+
+            co_await m_loop.readable(m_fd);
+
+            char chunk[4096];
+            const ssize_t count = ::read(m_fd, chunk, sizeof(chunk));
+            if (count > 0)
+                m_buffer.append(chunk, static_cast<std::size_t>(count));
+            else if (count == 0 || (errno != EINTR && errno != EAGAIN))
+                m_eof = true;
+        }
+    }
+
+    Async<bool> write_all(EventLoop &loop, int fd, std::string text)
+    {
+        std::size_t offset = 0;
+        while (offset < text.size())
+        {
+            const ssize_t count = write_some(fd, text.data() + offset, text.size() - offset);
+            if (count > 0)
+            {
+                offset += static_cast<std::size_t>(count);
+            }
+            else if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            {
+                co_await loop.writable(fd);
+            }
+            else if (count < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            else
+            {
+                co_return false;
+            }
+        }
+        co_return true;
+    }
+
+} // namespace Utils
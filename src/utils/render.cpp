@@ -1,114 +1,218 @@
 #include "utils/render.h"
 
 #include <iostream>
+#include <vector>
+#include <charconv>
 
 #ifdef _WIN32
     #include <windows.h>
-#elif defined(__linux__) || defined(__APPLE__)
-    #include <unistd.h>
 #endif
 
 namespace Utils
 {
-    /**
-     * @brief Очищает консоль и сбрасывает буфер вывода
-     * 
-     * Функция автоматически выбирает способ очистки консоли в зависимости от ОС:
-     * - Windows: использует system("cls")
-     * - Linux/macOS: использует system("clear")
-     * - Другие системы: использует ANSI escape codes
-     * 
-     * После очистки сбрасывает буфер вывода для немедленного отображения изменений.
-     */
-    void clear_console()
+    namespace
     {
-        #ifdef _WIN32
-            system("cls");
-        #elif defined(__linux__) || defined(__APPLE__)
-            system("clear");
-        #else
-            std::cout << "\033[2J\033[1;1H"; // ANSI escape codes
-        #endif
-        
-        std::cout.flush(); // Принудительный сброс буфера вывода
-    }
+        /**
+         * @brief Последний выведенный кадр и настройки частоты кадров.
+         */
+        struct FrameState
+        {
+            int size = 0;
+            bool valid = false;
+            std::vector<char> cells; ///< Символы клеток, выведенные в прошлом кадре.
+            std::string buffer;      ///< Буфер собираемого кадра (переиспользуется).
+            std::chrono::milliseconds interval{0};
+            std::chrono::steady_clock::time_point last_frame;
+        };
 
+        FrameState &frame_state()
+        {
+            static FrameState state;
+            return state;
+        }
+
+        /**
+         * @brief Включает обработку ANSI-последовательностей в консоли Windows.
+         *
+         * На Linux/macOS терминалы поддерживают их по умолчанию.
+         */
+        void enable_ansi()
+        {
+#ifdef _WIN32
+            static const bool enabled = []
+            {
+                HANDLE handle = GetStdHandle(STD_OUTPUT_HANDLE);
+                DWORD mode = 0;
+                if (GetConsoleMode(handle, &mode))
+                {
+                    SetConsoleMode(handle, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+                }
+                return true;
+            }();
+            (void)enabled;
+#endif
+        }
+
+        char glyph(Core::Color color)
+        {
+            switch (color)
+            {
+            case Core::Color::Black:
+                return 'O';
+            case Core::Color::White:
+                return 'X';
+            default:
+                return '_';
+            }
+        }
+
+        void append_number(std::string &out, int value)
+        {
+            char digits[12];
+            auto [end, ec] = std::to_chars(digits, digits + sizeof(digits), value);
+            out.append(digits, end);
+        }
+
+        /**
+         * @brief Добавляет в буфер перемещение курсора в позицию (row, col), считая с 1.
+         */
+        void append_cursor(std::string &out, int row, int col)
+        {
+            out += "\033[";
+            append_number(out, row);
+            out += ';';
+            append_number(out, col);
+            out += 'H';
+        }
+
+        /**
+         * @brief Собирает в буфер кадр с доской.
+         *
+         * Первый кадр (или кадр после invalidate) очищает экран и выводит поле
+         * целиком. Последующие кадры содержат только изменившиеся клетки.
+         * В конце курсор ставится на строку под полем, а все ниже очищается.
+         */
+        void compose_board(FrameState &state, Core::Situation &board)
+        {
+            const int size = board.get_size();
+            std::string &out = state.buffer;
+            out.clear();
+
+            if (!state.valid || state.size != size)
+            {
+                state.size = size;
+                state.cells.assign(size * size, '_');
+                out += "\033[2J\033[H";
+
+                for (int i = 0; i < size; i++)
+                {
+                    for (int j = 0; j < size; j++)
+                    {
+                        char c = glyph(board.get_stone_color(i, j));
+                        state.cells[i * size + j] = c;
+                        out += c;
+                        out += ' ';
+                    }
+                    out += '\n';
+                }
+                state.valid = true;
+            }
+            else
+            {
+                for (int i = 0; i < size; i++)
+                {
+                    for (int j = 0; j < size; j++)
+                    {
+                        char c = glyph(board.get_stone_color(i, j));
+                        char &prev = state.cells[i * size + j];
+                        if (c != prev)
+                        {
+                            append_cursor(out, i + 1, j * 2 + 1);
+                            out += c;
+                            prev = c;
+                        }
+                    }
+                }
+            }
+
+            append_cursor(out, size + 1, 1);
+            out += "\033[J";
+        }
+
+        void flush(FrameState &state)
+        {
+            std::cout.write(state.buffer.data(), static_cast<std::streamsize>(state.buffer.size()));
+            std::cout.flush(); // Принудительный сброс буфера вывода
+        }
+    } // namespace
 
     /**
      * @brief Функция отрисовки поля в консоли
      *
-     * Функция очищает консоль, запрашивает у доски board
-     * информацию о камнях и отрисовывает их.
+     * Функция запрашивает у доски board информацию о камнях
+     * и перерисовывает клетки, изменившиеся с прошлого кадра.
      *
      * @param board состояние поля и информация о камнях
+     * @param force не пропускать кадр из-за ограничения частоты
      *
-     * @note Для очистки консоли используются различные функции в зависимости от системы
+     * @note Вместо system("clear") используются ANSI-последовательности,
+     * весь кадр выводится одной записью.
      */
-    void Render::very_simple_draw(Core::Situation &board)
+    void Render::very_simple_draw(Core::Situation &board, bool force)
     {
-        clear_console();
-        for (int i = 0; i < board.get_size(); i++)
+        FrameState &state = frame_state();
+        auto now = std::chrono::steady_clock::now();
+
+        if (!force && state.valid && state.interval.count() > 0 && now - state.last_frame < state.interval)
         {
-            for (int j = 0; j < board.get_size(); j++)
-            {
-                switch (board.get_stone_color(i, j))
-                {
-                case Core::Color::None:
-                    std::cout << "_ ";
-                    break;
-                case Core::Color::Black:
-                    std::cout << "O ";
-                    break;
-                case Core::Color::White:
-                    std::cout << "X ";
-                    break;
-                }
-            }
-            std::cout << std::endl;
+            return;
         }
-        std::cout << "Введите ход (x y): ";
-        std::cout.flush();
+        state.last_frame = now;
+
+        enable_ansi();
+        compose_board(state, board);
+        state.buffer += "Введите ход (x y): ";
+        flush(state);
     }
 
     void Render::mess(std::string mess){
         std::cout << mess;
+        std::cout.flush();
+        invalidate(); // текст мог сдвинуть поле
     }
 
     void Render::win(Core::Situation &board, Core::Status who_win)
     {
-        clear_console();
+        FrameState &state = frame_state();
+
+        enable_ansi();
+        compose_board(state, board);
 
-        for (int i = 0; i < board.get_size(); i++)
-        {
-            for (int j = 0; j < board.get_size(); j++)
-            {
-                switch (board.get_stone_color(i, j))
-                {
-                case Core::Color::None:
-                    std::cout << "_ ";
-                    break;
-                case Core::Color::Black:
-                    std::cout << "O ";
-                    break;
-                case Core::Color::White:
-                    std::cout << "X ";
-                    break;
-                }
-            }
-            std::cout << std::endl;
-        }
         switch (who_win)
         {
         case Core::white_wins:
-            std::cout << "Белые выиграли!!!" << std::endl; 
+            state.buffer += "Белые выиграли!!!\n";
             break;
         case Core::black_wins:
-            std::cout << "Черные выиграли!!!" << std::endl; 
+            state.buffer += "Черные выиграли!!!\n";
             break;
         case Core::draw:
-            std::cout << "Ничья" << std::endl; 
+            state.buffer += "Ничья\n";
+            break;
+        default:
             break;
         }
-        std::cout.flush();
+        flush(state);
+        invalidate();
+    }
+
+    void Render::set_frame_interval(std::chrono::milliseconds interval)
+    {
+        frame_state().interval = interval;
+    }
+
+    void Render::invalidate()
+    {
+        frame_state().valid = false;
     }
 } // namespace Utils
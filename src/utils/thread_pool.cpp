@@ -0,0 +1,149 @@
+#include "utils/thread_pool.h"
+
+namespace Utils
+{
+    namespace
+    {
+        thread_local const WorkStealingPool *t_pool = nullptr;
+        thread_local int t_index = -1;
+    } // namespace
+
+    WorkStealingPool::WorkStealingPool(int threads)
+        : m_next(0), m_pending(0), m_unfinished(0), m_stopping(false)
+    {
+        if (threads <= 0)
+        {
+            const unsigned hw = std::thread::hardware_concurrency();
+            threads = hw ? static_cast<int>(hw) : 1;
+        }
+
+        for (int i = 0; i < threads; ++i)
+        {
+            m_queues.push_back(std::make_unique<Queue>());
+        }
+        for (int i = 0; i < threads; ++i)
+        {
+            m_threads.emplace_back(&WorkStealingPool::worker, this, i);
+        }
+    }
+
+    WorkStealingPool::~WorkStealingPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_wake.notify_all();
+
+        for (auto &thread : m_threads)
+        {
+            thread.join();
+        }
+    }
+
+    void WorkStealingPool::submit(Task task)
+    {
+        const int own = current_index();
+        const std::size_t index = (own >= 0) ? static_cast<std::size_t>(own)
+                                             : m_next.fetch_add(1) % m_queues.size();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_unfinished++;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_queues[index]->mutex);
+            m_queues[index]->tasks.push_back(std::move(task));
+        }
+        m_pending.fetch_add(1);
+
+        // Захват m_mutex исключает потерю пробуждения потока, который
+        // только что проверил m_pending и собирается уснуть.
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+        }
+        m_wake.notify_one();
+    }
+
+    bool WorkStealingPool::take(int index, Task &task)
+    {
+        const int count = static_cast<int>(m_queues.size());
+
+        for (int i = 0; i < count; ++i)
+        {
+            Queue &queue = *m_queues[(index + i) % count];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.tasks.empty())
+            {
+                continue;
+            }
+
+            if (i == 0)
+            {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+            }
+            else
+            {
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+            }
+            m_pending.fetch_sub(1);
+            return true;
+        }
+        return false;
+    }
+
+    void WorkStealingPool::worker(int index)
+    {
+        t_pool = this;
+        t_index = index;
+
+        Task task;
+        while (true)
+        {
+            if (take(index, task))
+            {
+                task();
+                task = nullptr; // захваченные задачей объекты освобождаются до ожидания
+
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (--m_unfinished == 0)
+                {
+                    m_idle.notify_all();
+                }
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this]
+                        { return m_stopping || m_pending.load() > 0; });
+            if (m_stopping)
+            {
+                return;
+            }
+        }
+    }
+
+    void WorkStealingPool::wait_idle()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_idle.wait(lock, [this]
+                    { return m_unfinished == 0; });
+    }
+
+    int WorkStealingPool::size() const
+    {
+        return static_cast<int>(m_threads.size());
+    }
+
+    std::size_t WorkStealingPool::pending() const
+    {
+        return m_pending.load();
+    }
+
+    int WorkStealingPool::current_index() const
+    {
+        return (t_pool == this) ? t_index : -1;
+    }
+
+} // namespace Utils
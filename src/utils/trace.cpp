@@ -0,0 +1,154 @@
+#include "utils/trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Utils::Trace
+{
+    std::atomic<bool> g_enabled{false};
+
+    namespace
+    {
+        struct Event
+        {
+            const char *name;
+            std::uint64_t start_ns;
+            std::uint64_t duration_ns;
+            std::int64_t value;
+        };
+
+        /**
+         * @brief Кольцевой буфер потока.
+         *
+         * Событие с номером i лежит в ячейке i % BUFFER_EVENTS и затирается
+         * событием i + BUFFER_EVENTS. Номер следующего события публикуется
+         * после записи самого события.
+         */
+        struct Buffer
+        {
+            int thread_id;
+            std::unique_ptr<Event[]> events;
+            std::atomic<std::uint64_t> count{0}; ///< Записано событий.
+            std::atomic<std::uint64_t> floor{0}; ///< События до этого номера забыты (clear).
+
+            explicit Buffer(int id) : thread_id(id), events(new Event[BUFFER_EVENTS]) {}
+        };
+
+        const std::chrono::steady_clock::time_point g_epoch = std::chrono::steady_clock::now();
+
+        std::mutex g_registry_mutex;
+        std::vector<std::shared_ptr<Buffer>> g_buffers; ///< Буферы переживают свои потоки.
+
+        thread_local Buffer *t_buffer = nullptr;
+
+        Buffer &own_buffer()
+        {
+            if (!t_buffer)
+            {
+                std::lock_guard<std::mutex> lock(g_registry_mutex);
+                auto buffer = std::make_shared<Buffer>(static_cast<int>(g_buffers.size()) + 1);
+                g_buffers.push_back(buffer);
+                t_buffer = buffer.get();
+            }
+            return *t_buffer;
+        }
+    } // namespace
+
+    void set_enabled(bool enabled)
+    {
+        g_enabled.store(enabled, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Отсчет начинается с 1: нулевое начало у Scope означает
+     * выключенную запись.
+     */
+    std::uint64_t now_ns()
+    {
+        const auto elapsed = std::chrono::steady_clock::now() - g_epoch;
+        return static_cast<std::uint64_t>(
+                   std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) + 1;
+    }
+
+    void record(const char *name, std::uint64_t start_ns, std::uint64_t end_ns, std::int64_t value)
+    {
+        Buffer &buffer = own_buffer();
+        const std::uint64_t index = buffer.count.load(std::memory_order_relaxed);
+        buffer.events[index % BUFFER_EVENTS] = {name, start_ns, end_ns - start_ns, value};
+        buffer.count.store(index + 1, std::memory_order_release);
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(g_registry_mutex);
+        for (const auto &buffer : g_buffers)
+        {
+            buffer->floor.store(buffer->count.load(std::memory_order_acquire), std::memory_order_relaxed);
+        }
+    }
+
+    bool write_chrome_json(const std::string &path)
+    {
+        std::vector<std::shared_ptr<Buffer>> buffers;
+        {
+            std::lock_guard<std::mutex> lock(g_registry_mutex);
+            buffers = g_buffers;
+        }
+
+        std::FILE *file = std::fopen(path.c_str(), "w");
+        if (!file)
+        {
+            return false;
+        }
+
+        std::fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n", file);
+        bool first = true;
+        std::vector<Event> events;
+
+        for (const auto &buffer : buffers)
+        {
+            std::fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+                               "\"args\":{\"name\":\"thread %d\"}}",
+                         first ? "" : ",\n", buffer->thread_id, buffer->thread_id);
+            first = false;
+
+            const std::uint64_t count = buffer->count.load(std::memory_order_acquire);
+            std::uint64_t begin = std::max<std::uint64_t>(
+                buffer->floor.load(std::memory_order_relaxed),
+                count > BUFFER_EVENTS ? count - BUFFER_EVENTS : 0);
+
+            events.clear();
+            for (std::uint64_t i = begin; i < count; ++i)
+            {
+                events.push_back(buffer->events[i % BUFFER_EVENTS]);
+            }
+
+            // События, которые поток успел затереть во время копирования, отбрасываются.
+            // Событие с номером after поток может записывать прямо сейчас, и оно
+            // занимает ячейку события after - BUFFER_EVENTS, поэтому оно тоже не годится
+            const std::uint64_t after = buffer->count.load(std::memory_order_acquire);
+            const std::uint64_t valid = after + 1 > BUFFER_EVENTS ? after + 1 - BUFFER_EVENTS : 0;
+            const std::size_t skip = static_cast<std::size_t>(valid > begin ? std::min(valid - begin, count - begin) : 0);
+
+            for (std::size_t i = skip; i < events.size(); ++i)
+            {
+                const Event &event = events[i];
+                std::fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f",
+                             event.name, buffer->thread_id, event.start_ns / 1000.0, event.duration_ns / 1000.0);
+                if (event.value >= 0)
+                {
+                    std::fprintf(file, ",\"args\":{\"value\":%lld}", static_cast<long long>(event.value));
+                }
+                std::fputc('}', file);
+            }
+        }
+
+        std::fputs("\n]}\n", file);
+        return std::fclose(file) == 0;
+    }
+
+} // namespace Utils::Trace